@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Array di dimensione fissa allocato nell'arena (es. i blocchi di statement).
+// Non possiede la memoria, quindi è banalmente distruttibile come i nodi.
+template <class T>
+struct NodeList {
+	T* data_ = nullptr;
+	std::size_t size_ = 0;
+
+	T* begin() const { return data_; }
+	T* end() const { return data_ + size_; }
+	std::size_t size() const { return size_; }
+	bool empty() const { return size_ == 0; }
+	T& operator[](std::size_t i) const { return data_[i]; }
+};
+
+// Allocatore bump-pointer per i nodi dell'AST. La memoria viene presa a blocchi
+// e restituita tutta insieme quando l'arena viene distrutta: i nodi non hanno
+// distruttori, quindi liberare un intero programma costa un free per blocco.
+class Arena {
+public:
+	Arena() = default;
+	~Arena() { release(); }
+	Arena(Arena const&) = delete;
+	Arena& operator=(Arena const&) = delete;
+
+	void* allocate(std::size_t size, std::size_t align = alignof(std::max_align_t)) {
+		std::size_t offset = (used_ + align - 1) & ~(align - 1);
+		if (blocks_.empty() || offset + size > capacity_) {
+			grow(size);
+			offset = 0;
+		}
+		used_ = offset + size;
+		++allocations_;
+		bytes_ += size;
+		return blocks_.back() + offset;
+	}
+
+	template <class T, class... Args>
+	T* make(Args&&... args) {
+		static_assert(std::is_trivially_destructible_v<T>, "i nodi nell'arena non vengono distrutti");
+		return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	template <class T>
+	NodeList<T> copy(std::vector<T> const& items) {
+		static_assert(std::is_trivially_copyable_v<T>, "NodeList contiene solo puntatori/valori semplici");
+		NodeList<T> list;
+		if (items.empty()) return list;
+		list.data_ = static_cast<T*>(allocate(sizeof(T) * items.size(), alignof(T)));
+		std::memcpy(list.data_, items.data(), sizeof(T) * items.size());
+		list.size_ = items.size();
+		return list;
+	}
+
+	std::string_view copy(std::string_view text) {
+		char* p = static_cast<char*>(allocate(text.size() + 1, 1));
+		std::memcpy(p, text.data(), text.size());
+		p[text.size()] = '\0';
+		return { p, text.size() };
+	}
+
+	// Libera tutti i blocchi in un colpo solo
+	void release() {
+		for (char* block : blocks_) std::free(block);
+		blocks_.clear();
+		used_ = capacity_ = 0;
+	}
+
+	// Statistiche: numero di allocazioni, byte usati dai nodi e byte riservati
+	std::size_t allocations() const { return allocations_; }
+	std::size_t bytes() const { return bytes_; }
+	std::size_t reserved() const { return reserved_; }
+
+private:
+	static constexpr std::size_t BLOCK_SIZE = 64 * 1024;
+
+	void grow(std::size_t size) {
+		std::size_t capacity = size > BLOCK_SIZE ? size : BLOCK_SIZE;
+		char* block = static_cast<char*>(std::malloc(capacity));
+		if (block == nullptr) throw std::bad_alloc{};
+		blocks_.push_back(block);
+		capacity_ = capacity;
+		used_ = 0;
+		reserved_ += capacity;
+	}
+
+	std::vector<char*> blocks_;
+	std::size_t used_ = 0;
+	std::size_t capacity_ = 0;
+	std::size_t allocations_ = 0;
+	std::size_t bytes_ = 0;
+	std::size_t reserved_ = 0;
+};
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Bytecode per la VM a stack. Ogni istruzione ha un opcode e un argomento:
+// slot della SymbolTable, costante o indirizzo di salto (indice in code); le
+// superistruzioni usano anche operand e slot. Sostituiscono le sequenze più
+// frequenti di due o tre istruzioni semplici.
+#define STACK_OPS(X) \
+	X(CONST)          /* push arg */ \
+	X(CHECK)          /* errore se la variabile dello slot arg non è assegnata */ \
+	X(LOAD)           /* push variabile dello slot arg */ \
+	X(LOAD_LOAD)      /* push variabili degli slot arg e operand */ \
+	X(STORE)          /* pop nella variabile dello slot arg */ \
+	X(INC)            /* variabile dello slot arg += operand, per x = x + k */ \
+	X(ADD) X(SUB) X(MUL) X(DIV) \
+	X(ADD_CONST) X(SUB_CONST) X(MUL_CONST)              /* top op= arg */ \
+	X(DIV_CONST)      /* top /= arg (arg != 0), con moltiplicatore operand e shift slot se slot >= 0 */ \
+	X(ADD_LOAD) X(SUB_LOAD) X(MUL_LOAD) X(DIV_LOAD)     /* top op= variabile dello slot arg */ \
+	X(ADD_STORE) X(SUB_STORE) X(MUL_STORE)              /* pop b, pop a, variabile dello slot arg = a op b */ \
+	X(LT) X(LTE) X(GT) X(GTE) X(EQ) X(NEQ) \
+	X(NEG) X(NOT) \
+	X(BOOL)           /* top = (top != 0), per il risultato di or/and */ \
+	X(JUMP)           /* salta ad arg */ \
+	X(JUMP_IF_FALSE)  /* pop, salta ad arg se zero */ \
+	X(JUMP_IF_TRUE)   /* pop, salta ad arg se diverso da zero */ \
+	X(JUMP_IF_LT) X(JUMP_IF_LTE) X(JUMP_IF_GT) X(JUMP_IF_GTE) X(JUMP_IF_EQ) X(JUMP_IF_NEQ) /* pop b, pop a, salta ad arg se a op b */ \
+	X(JUMP_IF_LT_CONST) X(JUMP_IF_LTE_CONST) X(JUMP_IF_GT_CONST) \
+	X(JUMP_IF_GTE_CONST) X(JUMP_IF_EQ_CONST) X(JUMP_IF_NEQ_CONST) /* pop a, salta ad arg se a op operand */ \
+	X(JUMP_IF_SLOT_LT) X(JUMP_IF_SLOT_LTE) X(JUMP_IF_SLOT_GT) \
+	X(JUMP_IF_SLOT_GTE) X(JUMP_IF_SLOT_EQ) X(JUMP_IF_SLOT_NEQ) /* salta ad arg se la variabile dello slot slot op operand */ \
+	X(LIST_NEW)       /* nuova lista vuota nello slot arg */ \
+	X(LIST_APPEND)    /* pop, aggiunge alla lista dello slot arg */ \
+	X(LIST_GET)       /* pop indice, push elemento della lista dello slot arg */ \
+	X(LIST_GET_UNCHECKED) /* come LIST_GET, indice dimostrato nei limiti */ \
+	X(PRINT)          /* pop e stampa */ \
+	X(SWITCH)         /* pop, salta all'indirizzo scelto dalla tabella arg */ \
+	X(HALT)
+
+enum class Op : std::uint8_t {
+#define STACK_OP_ENUM(name) name,
+	STACK_OPS(STACK_OP_ENUM)
+#undef STACK_OP_ENUM
+};
+
+// Tabella di un SWITCH (catene if/elif di SwitchLowering): un indirizzo per
+// ogni valore di [low, low + dense.size()) se i casi sono densi, altrimenti
+// una mappa; otherwise per i valori che non sono casi
+struct JumpTable {
+	int low = 0;
+	std::vector<int> dense;
+	std::unordered_map<int, int> sparse;
+	int otherwise = 0;
+
+	int target(int value) const {
+		if (!dense.empty()) {
+			std::uint32_t k = static_cast<std::uint32_t>(value) - static_cast<std::uint32_t>(low);
+			return k < dense.size() ? dense[k] : otherwise;
+		}
+		auto itr = sparse.find(value);
+		return itr != sparse.end() ? itr->second : otherwise;
+	}
+
+	// values[k] salta a targets[k]; a parità di valore vince il primo caso
+	static JumpTable build(std::vector<int> const& values, std::vector<int> const& targets, int otherwise) {
+		JumpTable table;
+		table.otherwise = otherwise;
+		std::int64_t low = values[0], high = values[0];
+		for (int v : values) {
+			if (v < low) low = v;
+			if (v > high) high = v;
+		}
+		if (high - low + 1 <= static_cast<std::int64_t>(2 * values.size())) {
+			table.low = static_cast<int>(low);
+			table.dense.assign(static_cast<std::size_t>(high - low + 1), otherwise);
+			for (std::size_t k = values.size(); k-- > 0;) table.dense[static_cast<std::size_t>(values[k] - low)] = targets[k];
+		}
+		else {
+			for (std::size_t k = 0; k < values.size(); ++k) table.sparse.emplace(values[k], targets[k]);
+		}
+		return table;
+	}
+};
+
+struct Instruction {
+	Op op;
+	std::int32_t arg;
+	std::int32_t operand = 0;
+	std::int32_t slot = 0;
+};
+
+// Programma compilato: codice e profondità massima dello stack
+struct Chunk {
+	std::vector<Instruction> code;
+	std::vector<JumpTable> tables;
+	int maxStack = 0;
+};
+
+// Bytecode per la VM a registri. Gli operandi a, b, c sono registri: gli slot
+// delle variabili [0, slots), le costanti [slots, slots + constants) e i
+// temporanei con indici negativi (-1, -2, ...), così tutti gli indici sono
+// noti già durante la compilazione. Per i salti a è l'indirizzo di arrivo.
+#define REGISTER_OPS(X) \
+	X(MOVE)          /* a = b */ \
+	X(ADD) X(SUB) X(MUL) X(DIV) \
+	X(LT) X(LTE) X(GT) X(GTE) X(EQ) X(NEQ) \
+	X(NEG) X(NOT) X(BOOL) \
+	X(INC)           /* a += b (b immediato): superistruzione per x = x + k */ \
+	X(JUMP) \
+	X(JUMP_IF_FALSE) /* salta se b == 0 */ \
+	X(JUMP_IF_TRUE)  /* salta se b != 0 */ \
+	X(JUMP_IF_LT) X(JUMP_IF_LTE) X(JUMP_IF_GT) X(JUMP_IF_GTE) X(JUMP_IF_EQ) X(JUMP_IF_NEQ) \
+	X(CHECK)         /* errore se lo slot a non è mai stato assegnato */ \
+	X(DEFINE)        /* lo slot a ora è assegnato */ \
+	X(LIST_NEW)      /* lista vuota nello slot a */ \
+	X(APPEND)        /* lista a .append(b) */ \
+	X(LIST_GET)      /* a = lista b [c] */ \
+	X(LIST_GET_UNCHECKED) /* come LIST_GET, senza controlli */ \
+	X(PRINT)         /* stampa b */ \
+	X(SWITCH)        /* salta all'indirizzo della tabella a per il valore b */ \
+	X(HALT)
+
+enum class ROp : std::uint8_t {
+#define REGISTER_OP_ENUM(name) name,
+	REGISTER_OPS(REGISTER_OP_ENUM)
+#undef REGISTER_OP_ENUM
+};
+
+struct RInstruction {
+	ROp op;
+	std::int32_t a;
+	std::int32_t b;
+	std::int32_t c;
+};
+
+struct RegisterChunk {
+	std::vector<RInstruction> code;
+	std::vector<int> constants;
+	std::vector<JumpTable> tables;
+	int slots = 0;
+	int temps = 0;
+};
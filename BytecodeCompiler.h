@@ -0,0 +1,391 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "Visitor.h"
+#include "Syntax.h"
+#include "Token.h"
+#include "Bytecode.h"
+#include "SwitchLowering.h"
+#include "MagicDivision.h"
+
+// Compila un Program (già risolto dal Resolver) in bytecode per la VM.
+// Le espressioni lasciano il loro valore in cima allo stack, gli statement
+// lasciano lo stack vuoto. Un operando destro costante o variabile diventa
+// l'argomento dell'operazione, le condizioni di if e while diventano un salto
+// con confronto e i while controllano la condizione in fondo al corpo; le
+// coppie di istruzioni più frequenti vengono fuse mentre sono emesse.
+// Come RegisterCompiler tiene traccia degli slot sicuramente assegnati: solo
+// le letture non garantite pagano un CHECK, le altre leggono la variabile.
+class BytecodeCompiler : public Visitor {
+
+public:
+	BytecodeCompiler() = default;
+	~BytecodeCompiler() = default;
+
+	static Chunk compile(Program const& program) {
+		BytecodeCompiler compiler;
+		compiler.defined_.assign(program.symbols.size(), 0);
+		compiler.visit(program);
+		return std::move(compiler.chunk_);
+	}
+
+	// Program: break/continue fuori da un while saltano alla fine dello
+	// statement top-level corrente, come l'eccezione ignorata dal tree walker
+	void visit(Program const& p) override {
+		for (Statement* statement : p.statements) {
+			std::vector<char> entry = defined_;
+			loops_.push_back(Loop{ false, {}, {} });
+			statement->accept(*this);
+			if (!loops_.back().exits.empty()) {
+				patch(loops_.back().exits, here());
+				// lo statement può essere stato interrotto a metà
+				defined_ = std::move(entry);
+			}
+			loops_.pop_back();
+		}
+		emit(Op::HALT);
+	}
+
+	// x = x + k e x = x - k diventano INC
+	void visit(Definition const& d) override {
+		int slot = d.variable_->slot_;
+		if (auto m = dynamic_cast<mathExpression const*>(d.expression_)) {
+			auto v = dynamic_cast<Variable const*>(m->left_);
+			auto c = dynamic_cast<Constant const*>(m->right_);
+			if (v != nullptr && c != nullptr && v->slot_ == slot && (m->opCode_ == Token::ADD || m->opCode_ == Token::SUB)) {
+				std::uint32_t k = static_cast<std::uint32_t>(c->num_);
+				read(slot);
+				emit(Op::INC, slot, static_cast<std::int32_t>(m->opCode_ == Token::ADD ? k : 0u - k));
+				return;
+			}
+		}
+		d.expression_->accept(*this);
+		emit(Op::STORE, slot);
+		defined_[slot] = 1;
+	}
+
+	void visit(Expression const& o) override {
+		throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+
+	void visit(ifStatement const& i) override {
+		if (i.dispatch_ != nullptr) {
+			dispatch(*i.dispatch_);
+			return;
+		}
+		std::size_t toElse = branch(*i.condition, false);
+		std::vector<char> afterCondition = defined_;
+		for (auto* st : i.block) st->accept(*this);
+		std::vector<char> afterThen = std::move(defined_);
+		defined_ = std::move(afterCondition);
+		if (i.elifBlock == nullptr && i.elseBlock.empty()) {
+			patch(toElse, here());
+		}
+		else {
+			std::size_t toEnd = emit(Op::JUMP);
+			patch(toElse, here());
+			if (i.elifBlock) i.elifBlock->accept(*this);
+			else for (auto* st : i.elseBlock) st->accept(*this);
+			patch(toEnd, here());
+		}
+		intersect(afterThen);
+	}
+
+	// Condizione in fondo: un solo salto per iterazione. Il corpo è compilato
+	// prima della condizione, quindi parte dagli slot assegnati all'ingresso
+	void visit(whileStatement const& w) override {
+		std::size_t toCondition = emit(Op::JUMP);
+		int body = here();
+		std::vector<char> entry = defined_;
+		loops_.push_back(Loop{ true, {}, {} });
+		for (auto* st : w.block) st->accept(*this);
+		patch(toCondition, here());
+		patch(loops_.back().continues, here());
+		defined_ = entry;
+		patch(branch(*w.condition, true), body);
+		patch(loops_.back().exits, here());
+		loops_.pop_back();
+		defined_ = std::move(entry);
+	}
+
+	void visit(Break const& b) override {
+		loops_.back().exits.push_back(emit(Op::JUMP));
+	}
+
+	void visit(Continue const& c) override {
+		Loop& loop = loops_.back();
+		if (loop.loop) loop.continues.push_back(emit(Op::JUMP));
+		else loop.exits.push_back(emit(Op::JUMP));
+	}
+
+	void visit(Print const& p) override {
+		p.expr_->accept(*this);
+		emit(Op::PRINT);
+	}
+
+	// or/and con short-circuit, il risultato è sempre 0 o 1; il ramo destro
+	// può non essere valutato, quindi i suoi CHECK non valgono dopo
+	void visit(orExpr const& e) override {
+		e.left_->accept(*this);
+		std::size_t toTrue = emit(Op::JUMP_IF_TRUE);
+		std::vector<char> afterLeft = defined_;
+		e.right_->accept(*this);
+		defined_ = std::move(afterLeft);
+		emit(Op::BOOL);
+		std::size_t toEnd = emit(Op::JUMP);
+		patch(toTrue, here());
+		emit(Op::CONST, 1);
+		patch(toEnd, here());
+		// CONST 1 e il ramo destro occupano lo stesso posto nello stack
+		--depth_;
+	}
+
+	void visit(andExpr const& e) override {
+		e.left_->accept(*this);
+		std::size_t toFalse = emit(Op::JUMP_IF_FALSE);
+		std::vector<char> afterLeft = defined_;
+		e.right_->accept(*this);
+		defined_ = std::move(afterLeft);
+		emit(Op::BOOL);
+		std::size_t toEnd = emit(Op::JUMP);
+		patch(toFalse, here());
+		emit(Op::CONST, 0);
+		patch(toEnd, here());
+		--depth_;
+	}
+
+	void visit(relExpression const& e) override {
+		e.left_->accept(*this);
+		e.right_->accept(*this);
+		switch (e.opCode_) {
+		case Token::LT:  emit(Op::LT); break;
+		case Token::LTE: emit(Op::LTE); break;
+		case Token::GT:  emit(Op::GT); break;
+		case Token::GTE: emit(Op::GTE); break;
+		case Token::EQEQ: emit(Op::EQ); break;
+		case Token::NEQ:  emit(Op::NEQ); break;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+	}
+
+	// Con il destro costante (diverso da zero per la divisione) o variabile
+	// basta un'istruzione
+	void visit(mathExpression const& e) override {
+		int k;
+		switch (e.opCode_) {
+		case Token::ADD: k = 0; break;
+		case Token::SUB: k = 1; break;
+		case Token::MUL: k = 2; break;
+		case Token::INTDIV: k = 3; break;
+		default: throw std::runtime_error("ERROR: Unknown math operator.");
+		}
+		static constexpr Op plain[] = { Op::ADD, Op::SUB, Op::MUL, Op::DIV };
+		static constexpr Op constant[] = { Op::ADD_CONST, Op::SUB_CONST, Op::MUL_CONST, Op::DIV_CONST };
+		static constexpr Op load[] = { Op::ADD_LOAD, Op::SUB_LOAD, Op::MUL_LOAD, Op::DIV_LOAD };
+		e.left_->accept(*this);
+		if (auto c = dynamic_cast<Constant const*>(e.right_); c != nullptr && (c->num_ != 0 || e.opCode_ != Token::INTDIV)) {
+			std::size_t at = emit(constant[k], c->num_);
+			// la divisione per costante diventa moltiplicazione e shift
+			if (e.opCode_ == Token::INTDIV) {
+				MagicDivisor magic = MagicDivisor::applicable(c->num_) ? MagicDivisor::of(c->num_) : MagicDivisor{ 0, -1 };
+				chunk_.code[at].operand = magic.multiplier;
+				chunk_.code[at].slot = magic.shift;
+			}
+		}
+		else if (auto v = dynamic_cast<Variable const*>(e.right_)) {
+			read(v->slot_);
+			emit(load[k], v->slot_);
+		}
+		else {
+			e.right_->accept(*this);
+			emit(plain[k]);
+		}
+	}
+
+	void visit(unaryExpression const& e) override {
+		e.operand_->accept(*this);
+		if (e.opCode_ == Token::SUB) emit(Op::NEG);
+		else if (e.opCode_ == Token::NOT) emit(Op::NOT);
+		else throw std::runtime_error("ERROR: Unknown unary operator.");
+	}
+
+	void visit(Variable const& v) override {
+		read(v.slot_);
+		emit(Op::LOAD, v.slot_);
+	}
+
+	void visit(Constant const& c) override {
+		emit(Op::CONST, c.num_);
+	}
+
+	void visit(listInit const& l) override {
+		emit(Op::LIST_NEW, l.slot_);
+	}
+
+	void visit(listAppend const& l) override {
+		l.expr_->accept(*this);
+		emit(Op::LIST_APPEND, l.slot_);
+	}
+
+	void visit(listAccess const& e) override {
+		e.index_->accept(*this);
+		emit(e.inBounds_ ? Op::LIST_GET_UNCHECKED : Op::LIST_GET, e.slot_);
+	}
+
+private:
+	// While in compilazione (loop falso per lo statement top-level, dove
+	// anche continue esce) e salti da collegare all'uscita e alla condizione
+	struct Loop {
+		bool loop;
+		std::vector<std::size_t> exits;
+		std::vector<std::size_t> continues;
+	};
+
+	Chunk chunk_;
+	std::vector<Loop> loops_;
+	std::vector<char> defined_;
+	int depth_ = 0;
+
+	int target_ = -1;  // indirizzo dell'ultimo here(): un salto può arrivarci
+
+	// Indirizzo della prossima istruzione, come destinazione di un salto
+	int here() {
+		target_ = static_cast<int>(chunk_.code.size());
+		return target_;
+	}
+
+	// Catena if/elif annotata da SwitchLowering: la tabella salta al ramo.
+	// Dopo la catena sono assegnati gli slot assegnati in tutti i rami
+	void dispatch(Dispatch const& d) {
+		d.subject->accept(*this);
+		int table = static_cast<int>(chunk_.tables.size());
+		chunk_.tables.emplace_back();
+		emit(Op::SWITCH, table);
+		std::vector<char> entry = defined_;
+		std::vector<char> after(defined_.size(), 1);
+		std::vector<int> targets;
+		std::vector<std::size_t> toEnd;
+		for (ifStatement const* arm : d.arms) {
+			targets.push_back(here());
+			defined_ = entry;
+			for (auto* st : arm->block) st->accept(*this);
+			for (std::size_t k = 0; k < after.size(); ++k) after[k] = after[k] && defined_[k];
+			toEnd.push_back(emit(Op::JUMP));
+		}
+		int otherwise = here();
+		defined_ = std::move(entry);
+		if (d.rest != nullptr) d.rest->accept(*this);
+		else for (auto* st : d.otherwise) st->accept(*this);
+		patch(toEnd, here());
+		intersect(after);
+		chunk_.tables[table] = JumpTable::build(std::vector<int>(d.values.begin(), d.values.end()), targets, otherwise);
+	}
+
+	// Salto (da collegare) preso se la condizione vale when: un confronto
+	// diventa un solo JUMP_IF_<op>, negato se when è falso
+	std::size_t branch(Expression const& condition, bool when) {
+		auto rel = dynamic_cast<relExpression const*>(&condition);
+		if (rel == nullptr) {
+			condition.accept(*this);
+			return emit(when ? Op::JUMP_IF_TRUE : Op::JUMP_IF_FALSE);
+		}
+		int k;
+		switch (rel->opCode_) {
+		case Token::LT:  k = when ? 0 : 3; break;
+		case Token::LTE: k = when ? 1 : 2; break;
+		case Token::GT:  k = when ? 2 : 1; break;
+		case Token::GTE: k = when ? 3 : 0; break;
+		case Token::EQEQ: k = when ? 4 : 5; break;
+		case Token::NEQ:  k = when ? 5 : 4; break;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+		static constexpr Op plain[] = { Op::JUMP_IF_LT, Op::JUMP_IF_LTE, Op::JUMP_IF_GT,
+			Op::JUMP_IF_GTE, Op::JUMP_IF_EQ, Op::JUMP_IF_NEQ };
+		static constexpr Op constant[] = { Op::JUMP_IF_LT_CONST, Op::JUMP_IF_LTE_CONST, Op::JUMP_IF_GT_CONST,
+			Op::JUMP_IF_GTE_CONST, Op::JUMP_IF_EQ_CONST, Op::JUMP_IF_NEQ_CONST };
+		rel->left_->accept(*this);
+		if (auto c = dynamic_cast<Constant const*>(rel->right_)) {
+			return emit(constant[k], 0, c->num_);
+		}
+		rel->right_->accept(*this);
+		return emit(plain[k]);
+	}
+
+	// Aggiunge un'istruzione e aggiorna la profondità dello stack
+	std::size_t emit(Op op, int arg = 0, int operand = 0) {
+		switch (op) {
+		case Op::CONST: case Op::LOAD:
+			++depth_;
+			break;
+		case Op::STORE: case Op::JUMP_IF_FALSE: case Op::JUMP_IF_TRUE:
+		case Op::LIST_APPEND: case Op::PRINT: case Op::SWITCH:
+		case Op::ADD: case Op::SUB: case Op::MUL: case Op::DIV:
+		case Op::LT: case Op::LTE: case Op::GT: case Op::GTE: case Op::EQ: case Op::NEQ:
+		case Op::JUMP_IF_LT_CONST: case Op::JUMP_IF_LTE_CONST: case Op::JUMP_IF_GT_CONST:
+		case Op::JUMP_IF_GTE_CONST: case Op::JUMP_IF_EQ_CONST: case Op::JUMP_IF_NEQ_CONST:
+			--depth_;
+			break;
+		case Op::JUMP_IF_LT: case Op::JUMP_IF_LTE: case Op::JUMP_IF_GT:
+		case Op::JUMP_IF_GTE: case Op::JUMP_IF_EQ: case Op::JUMP_IF_NEQ:
+			depth_ -= 2;
+			break;
+		default:
+			break;
+		}
+		if (depth_ > chunk_.maxStack) chunk_.maxStack = depth_;
+		if (!fuse(op, arg, operand)) chunk_.code.push_back(Instruction{ op, arg, operand });
+		return chunk_.code.size() - 1;
+	}
+
+	// Superistruzioni: la nuova istruzione prende il posto della precedente se
+	// nessun salto arriva fra le due. Le variabili vengono lette nello stesso
+	// ordine, quindi anche gli errori restano quelli delle istruzioni separate
+	bool fuse(Op op, int arg, int operand) {
+		if (chunk_.code.empty() || target_ == static_cast<int>(chunk_.code.size())) return false;
+		Instruction& last = chunk_.code.back();
+		if (last.op == Op::LOAD && op == Op::LOAD) {
+			last = Instruction{ Op::LOAD_LOAD, last.arg, arg };
+			return true;
+		}
+		if (op == Op::STORE && (last.op == Op::ADD || last.op == Op::SUB || last.op == Op::MUL)) {
+			last = Instruction{ last.op == Op::ADD ? Op::ADD_STORE : last.op == Op::SUB ? Op::SUB_STORE : Op::MUL_STORE, arg };
+			return true;
+		}
+		static constexpr Op constant[] = { Op::JUMP_IF_LT_CONST, Op::JUMP_IF_LTE_CONST, Op::JUMP_IF_GT_CONST,
+			Op::JUMP_IF_GTE_CONST, Op::JUMP_IF_EQ_CONST, Op::JUMP_IF_NEQ_CONST };
+		static constexpr Op slot[] = { Op::JUMP_IF_SLOT_LT, Op::JUMP_IF_SLOT_LTE, Op::JUMP_IF_SLOT_GT,
+			Op::JUMP_IF_SLOT_GTE, Op::JUMP_IF_SLOT_EQ, Op::JUMP_IF_SLOT_NEQ };
+		for (int k = 0; k < 6; ++k) {
+			if (last.op == Op::LOAD && op == constant[k]) {
+				last = Instruction{ slot[k], arg, operand, last.arg };
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// Lettura di una variabile: CHECK solo se non è sicuramente assegnata
+	void read(int slot) {
+		if (!defined_[slot]) {
+			emit(Op::CHECK, slot);
+			defined_[slot] = 1;
+		}
+	}
+
+	void intersect(std::vector<char> const& other) {
+		for (std::size_t k = 0; k < defined_.size(); ++k) defined_[k] = defined_[k] && other[k];
+	}
+
+	void patch(std::size_t at, int target) {
+		chunk_.code[at].arg = target;
+	}
+
+	void patch(std::vector<std::size_t> const& jumps, int target) {
+		for (std::size_t at : jumps) patch(at, target);
+	}
+};
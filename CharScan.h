@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cstddef>
+
+#if defined(CHARSCAN_SCALAR)
+// Solo la versione scalare (confronto nei benchmark)
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define CHARSCAN_AVX2 1
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define CHARSCAN_SSE2 1
+#endif
+
+// Scansione di sequenze di caratteri per il Lexer: identificatori [a-zA-Z0-9],
+// cifre e spazi/tab di indentazione. Con SSE2 (sempre presente su x86-64) o AVX2
+// (se compilato con -mavx2) vengono esaminati 16/32 byte per volta, altrimenti
+// (o con -DCHARSCAN_SCALAR) si usa la versione scalare. Tutte le funzioni restituiscono la lunghezza della
+// sequenza che inizia in p e non leggono mai oltre end.
+namespace charscan {
+
+inline bool isAlnum(char c) {
+	unsigned char u = static_cast<unsigned char>(c);
+	return (u >= '0' && u <= '9') || ((u | 0x20) >= 'a' && (u | 0x20) <= 'z');
+}
+
+inline bool isDigit(char c) {
+	return c >= '0' && c <= '9';
+}
+
+inline bool isBlank(char c) {
+	return c == ' ' || c == '\t';
+}
+
+#if defined(CHARSCAN_AVX2)
+
+constexpr std::size_t WIDTH = 32;
+using Vec = __m256i;
+
+inline Vec load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+inline Vec splat(char c) { return _mm256_set1_epi8(c); }
+inline Vec inRange(Vec x, char lo, char hi) {
+	return _mm256_and_si256(_mm256_cmpgt_epi8(x, splat(lo - 1)), _mm256_cmpgt_epi8(splat(hi + 1), x));
+}
+inline Vec orv(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+inline Vec eq(Vec x, char c) { return _mm256_cmpeq_epi8(x, splat(c)); }
+inline unsigned int mask(Vec x) { return static_cast<unsigned int>(_mm256_movemask_epi8(x)); }
+constexpr unsigned int FULL = 0xFFFFFFFFu;
+
+#elif defined(CHARSCAN_SSE2)
+
+constexpr std::size_t WIDTH = 16;
+using Vec = __m128i;
+
+inline Vec load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+inline Vec splat(char c) { return _mm_set1_epi8(c); }
+inline Vec inRange(Vec x, char lo, char hi) {
+	return _mm_and_si128(_mm_cmpgt_epi8(x, splat(lo - 1)), _mm_cmplt_epi8(x, splat(hi + 1)));
+}
+inline Vec orv(Vec a, Vec b) { return _mm_or_si128(a, b); }
+inline Vec eq(Vec x, char c) { return _mm_cmpeq_epi8(x, splat(c)); }
+inline unsigned int mask(Vec x) { return static_cast<unsigned int>(_mm_movemask_epi8(x)); }
+constexpr unsigned int FULL = 0xFFFFu;
+
+#endif
+
+#if defined(CHARSCAN_AVX2) || defined(CHARSCAN_SSE2)
+
+// Posizione del primo byte che non appartiene alla classe (mask ha un bit per byte)
+inline unsigned int firstMiss(unsigned int m) {
+	return static_cast<unsigned int>(__builtin_ctz(~m & FULL));
+}
+
+#endif
+
+inline std::size_t scanAlnum(const char* p, const char* end) {
+	const char* start = p;
+#if defined(CHARSCAN_AVX2) || defined(CHARSCAN_SSE2)
+	while (static_cast<std::size_t>(end - p) >= WIDTH) {
+		Vec x = load(p);
+		// (c | 0x20) porta le maiuscole sulle minuscole senza creare falsi positivi
+		Vec lower = orv(x, splat(0x20));
+		unsigned int m = mask(orv(inRange(x, '0', '9'), inRange(lower, 'a', 'z')));
+		if (m != FULL) return (p - start) + firstMiss(m);
+		p += WIDTH;
+	}
+#endif
+	while (p < end && isAlnum(*p)) ++p;
+	return p - start;
+}
+
+inline std::size_t scanDigits(const char* p, const char* end) {
+	const char* start = p;
+#if defined(CHARSCAN_AVX2) || defined(CHARSCAN_SSE2)
+	while (static_cast<std::size_t>(end - p) >= WIDTH) {
+		unsigned int m = mask(inRange(load(p), '0', '9'));
+		if (m != FULL) return (p - start) + firstMiss(m);
+		p += WIDTH;
+	}
+#endif
+	while (p < end && isDigit(*p)) ++p;
+	return p - start;
+}
+
+// Come sopra per spazi e tab; in tabs restituisce quanti tab contiene la sequenza
+inline std::size_t scanBlanks(const char* p, const char* end, std::size_t& tabs) {
+	const char* start = p;
+	tabs = 0;
+#if defined(CHARSCAN_AVX2) || defined(CHARSCAN_SSE2)
+	while (static_cast<std::size_t>(end - p) >= WIDTH) {
+		Vec x = load(p);
+		unsigned int t = mask(eq(x, '\t'));
+		unsigned int m = mask(eq(x, ' ')) | t;
+		if (m != FULL) {
+			unsigned int n = firstMiss(m);
+			tabs += __builtin_popcount(t & ((1u << n) - 1));
+			return (p - start) + n;
+		}
+		tabs += __builtin_popcount(t);
+		p += WIDTH;
+	}
+#endif
+	while (p < end && isBlank(*p)) {
+		if (*p == '\t') ++tabs;
+		++p;
+	}
+	return p - start;
+}
+
+}
@@ -0,0 +1,177 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <utility>
+
+#include "CompiledProgram.h"
+#include "Parser.h"
+#include "ConstantFolder.h"
+#include "ConstantPropagation.h"
+#include "LoopInvariantMotion.h"
+#include "ScalarEvolution.h"
+#include "RangeAnalysis.h"
+#include "SwitchLowering.h"
+#include "Resolver.h"
+#include "BytecodeCompiler.h"
+#include "VM.h"
+#include "RegisterCompiler.h"
+#include "RegisterVM.h"
+#include "Jit.h"
+#include "IrBuilder.h"
+#include "IrPasses.h"
+#include "IrInterpreter.h"
+#include "SymbolTable.h"
+#include "EvaluationVisitor.h"
+
+std::shared_ptr<const CompiledProgram> CompiledProgram::compile(std::unique_ptr<Program> program,
+	Options const& options, std::ostream& log) {
+	std::shared_ptr<CompiledProgram> compiled{ new CompiledProgram };
+	compiled->options_ = options;
+
+	// Gli identificatori vengono legati agli slot della SymbolTable una volta sola
+	Resolver::resolve(*program);
+	if (options.optimize) {
+		// La propagazione delle costanti richiede gli slot; il secondo folding
+		// calcola le espressioni riscritte ed elimina i rami morti
+		std::size_t removed = ConstantFolder::fold(*program);
+		std::size_t propagated = ConstantPropagation::propagate(*program);
+		removed += ConstantFolder::fold(*program);
+		std::size_t hoisted = LoopInvariantMotion::hoist(*program);
+		ScalarEvolution::Stats evolution = ScalarEvolution::analyze(*program);
+		RangeAnalysis::Stats ranges = RangeAnalysis::analyze(*program);
+		if (options.stats) {
+			log << "Constant propagation: " << propagated << " reads replaced" << std::endl;
+			log << "Constant folding: " << removed << " nodes removed" << std::endl;
+			log << "Loop-invariant code motion: " << hoisted << " expressions hoisted" << std::endl;
+			log << "Scalar evolution: " << evolution.closed << " loops in closed form, "
+				<< evolution.reduced << " multiplications reduced, " << evolution.divisions << " constant divisions" << std::endl;
+			log << "Range analysis: " << ranges.proven << " of " << ranges.accesses << " list accesses proven in bounds" << std::endl;
+		}
+	}
+	// Le lunghe catene if/elif che confrontano una variabile con costanti saltano tramite tabella
+	std::size_t chains = SwitchLowering::lower(*program);
+	if (options.stats) {
+		log << "Jump tables: " << chains << " if/elif chains" << std::endl;
+		log << "AST: " << program->arena.allocations() << " allocations, "
+			<< program->arena.bytes() << " bytes (" << program->arena.reserved() << " reserved)" << std::endl;
+	}
+
+	switch (options.engine) {
+	case Engine::TREE:
+		break;
+	case Engine::FLAT:
+		// Costruito l'AST piatto, l'albero di puntatori non serve più
+		compiled->flat_ = FlatAst::build(*program);
+		program.reset();
+		if (options.stats) {
+			log << "Flat AST: " << compiled->flat_.size() << " nodes, " << compiled->flat_.bytes() << " bytes" << std::endl;
+		}
+		break;
+	case Engine::STACK_VM:
+		compiled->chunk_ = BytecodeCompiler::compile(*program);
+		break;
+	case Engine::REGISTER_VM:
+		compiled->registers_ = RegisterCompiler::compile(*program);
+		break;
+	case Engine::IR: {
+		// IR SSA: il pass manager misura ogni passo
+		IrFunction& ir = compiled->ir_;
+		ir = IrBuilder::build(*program);
+		if (options.stats) {
+			log << "IR: " << ir.blocks.size() << " blocks, " << ir.size() << " instructions" << std::endl;
+		}
+		if (options.optimize) {
+			IrPassManager passes = IrPassManager::standard();
+			passes.run(ir);
+			if (options.stats) {
+				for (auto const& pass : passes.timings()) {
+					log << "IR pass " << pass.name << ": " << pass.changed << " changed, "
+						<< pass.ms << " ms" << std::endl;
+				}
+				log << "IR: " << ir.size() << " instructions after passes" << std::endl;
+			}
+		}
+		break;
+	}
+	}
+
+	if (program == nullptr) compiled->names_ = compiled->flat_.names();
+	else compiled->names_.assign(program->symbols.begin(), program->symbols.end());
+	compiled->program_ = std::move(program);
+	return compiled;
+}
+
+std::shared_ptr<const CompiledProgram> CompiledProgram::lowerFlat(TokenSource& tokens,
+	Options const& options, std::ostream& log) {
+	std::shared_ptr<CompiledProgram> compiled{ new CompiledProgram };
+	compiled->options_ = options;
+	compiled->options_.engine = Engine::FLAT;
+
+	// Gli slot restano quelli che darebbe il Resolver sull'intero programma
+	Parser parser;
+	Arena names;
+	Resolver resolver;
+	std::size_t chains = 0, largest = 0;
+	parser.doParsing(tokens, names, [&](Program& statement) {
+		resolver.visit(statement);
+		chains += SwitchLowering::lower(statement);
+		largest = std::max(largest, statement.arena.bytes());
+		compiled->flat_.append(statement);
+	});
+	compiled->flat_.finish({ resolver.names().begin(), resolver.names().end() });
+	compiled->names_ = compiled->flat_.names();
+	if (options.stats) {
+		log << "Jump tables: " << chains << " if/elif chains" << std::endl;
+		log << "AST: lowered statement by statement, largest " << largest << " bytes" << std::endl;
+		log << "Flat AST: " << compiled->flat_.size() << " nodes, " << compiled->flat_.bytes() << " bytes" << std::endl;
+	}
+	return compiled;
+}
+
+int CompiledProgram::run(OutputSink& output, std::ostream& log) const {
+	// Tutto lo stato dell'esecuzione è locale: il programma viene solo letto
+	SymbolTable symbolTable{ names_ };
+	Jit nativeLoops;
+	EvaluationVisitor evaluator{ symbolTable, output, options_.jit && Jit::available() ? &nativeLoops : nullptr };
+	auto start = std::chrono::steady_clock::now();
+	try {
+		switch (options_.engine) {
+		case Engine::TREE:
+			evaluator.visit(*program_);
+			break;
+		case Engine::FLAT:
+			evaluator.run(flat_);
+			break;
+		case Engine::STACK_VM:
+			VM{ symbolTable, output }.run(chunk_);
+			break;
+		case Engine::REGISTER_VM:
+			RegisterVM{ symbolTable, output }.run(registers_);
+			break;
+		case Engine::IR:
+			IrInterpreter{ symbolTable, output }.run(ir_);
+			break;
+		}
+	}
+	catch (EvaluationError& e) {
+		output.flush();
+		log << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	catch (std::exception& e) {
+		output.flush();
+		log << "Something odd happened during parsing, got: " << std::endl;
+		log << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	output.flush();
+	if (options_.stats) {
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		log << "Execution: " << elapsed.count() << " ms" << std::endl;
+		if (options_.jit) {
+			log << "JIT: " << nativeLoops.compiled() << " loops compiled, "
+				<< nativeLoops.bailouts() << " bailouts" << std::endl;
+		}
+	}
+	return EXIT_SUCCESS;
+}
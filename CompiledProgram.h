@@ -0,0 +1,66 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Syntax.h"
+#include "TokenStream.h"
+#include "FlatAst.h"
+#include "Bytecode.h"
+#include "Ir.h"
+#include "OutputSink.h"
+
+// Programma compilato una volta sola e poi immutabile: compile() risolve gli
+// identificatori, applica i passi di ottimizzazione (che annotano l'AST) e
+// prepara il codice del motore scelto (AST piatto, bytecode, IR). Dopo non
+// viene più modificato, quindi lo stesso programma può essere eseguito da più
+// thread insieme: ogni run() ha SymbolTable, evaluator (e JIT) propri e scrive
+// sull'OutputSink che riceve.
+class CompiledProgram {
+
+public:
+	enum class Engine { TREE, FLAT, STACK_VM, REGISTER_VM, IR };
+
+	struct Options {
+		Engine engine = Engine::TREE;
+		bool optimize = false;
+		bool jit = false;
+		bool stats = false;
+	};
+
+	// Le statistiche dei passi (con options.stats) vanno su log
+	static std::shared_ptr<const CompiledProgram> compile(std::unique_ptr<Program> program,
+		Options const& options, std::ostream& log);
+
+	// Motore FLAT senza -O (i passi di -O vogliono il programma intero): ogni
+	// statement di primo livello viene abbassato nell'AST piatto appena parsato
+	// e il suo albero liberato, così l'AST di puntatori dell'intero script non
+	// esiste mai. Gli errori di sintassi arrivano come SyntaxError
+	static std::shared_ptr<const CompiledProgram> lowerFlat(TokenSource& tokens,
+		Options const& options, std::ostream& log);
+
+	CompiledProgram(CompiledProgram const&) = delete;
+	CompiledProgram& operator=(CompiledProgram const&) = delete;
+
+	// Esegue il programma; errori e statistiche vanno su log, dopo aver svuotato
+	// output. Restituisce EXIT_SUCCESS o EXIT_FAILURE
+	int run(OutputSink& output, std::ostream& log) const;
+
+	// AST annotato (nullptr col motore FLAT, che non ne ha più bisogno)
+	Program const* program() const { return program_.get(); }
+	FlatAst const& flat() const { return flat_; }
+	IrFunction const& ir() const { return ir_; }
+
+private:
+	CompiledProgram() = default;
+
+	Options options_;
+	std::unique_ptr<Program> program_;
+	std::vector<std::string> names_;
+	FlatAst flat_;
+	Chunk chunk_;
+	RegisterChunk registers_;
+	IrFunction ir_;
+};
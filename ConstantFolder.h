@@ -0,0 +1,291 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <stdexcept>
+#include <vector>
+
+#include "Syntax.h"
+#include "Token.h"
+
+// Passata di ottimizzazione eseguita prima della valutazione: calcola le
+// sotto-espressioni costanti, applica le identità sicure (x + 0, x * 1,
+// not not (a < b), ...) e trasforma if/while con condizione costante in
+// codice lineare. Non elimina mai la valutazione di un'espressione che può
+// fallire: x * 0 resta tale (x potrebbe non essere dichiarata) e una
+// divisione per zero resta nel programma, così l'errore arriva a runtime.
+// Riscrive l'AST sul posto; i nodi nuovi vengono allocati nell'arena.
+class ConstantFolder {
+
+public:
+	// Restituisce il numero di nodi eliminati
+	static std::size_t fold(Program& program) {
+		std::size_t before = size(program.statements);
+		ConstantFolder folder{ program.arena };
+		program.statements = folder.block(program.statements, true);
+		return before - size(program.statements);
+	}
+
+	// Numero di nodi (statement ed espressioni) di un blocco
+	static std::size_t size(NodeList<Statement*> const& statements) {
+		std::size_t n = 0;
+		for (Statement const* st : statements) n += size(st);
+		return n;
+	}
+
+private:
+	explicit ConstantFolder(Arena& arena) : arena_{ arena } { }
+
+	Arena& arena_;
+
+	NodeList<Statement*> block(NodeList<Statement*> const& statements, bool topLevel) {
+		std::vector<Statement*> folded;
+		for (Statement* st : statements) statement(st, topLevel, folded);
+		return arena_.copy(folded);
+	}
+
+	void statement(Statement* st, bool topLevel, std::vector<Statement*>& out) {
+		if (auto d = dynamic_cast<Definition*>(st)) {
+			d->expression_ = expression(d->expression_);
+		}
+		else if (auto p = dynamic_cast<Print*>(st)) {
+			p->expr_ = expression(p->expr_);
+		}
+		else if (auto a = dynamic_cast<listAppend*>(st)) {
+			a->expr_ = expression(a->expr_);
+		}
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			branch(i, topLevel, out);
+			return;
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			w->condition = expression(w->condition);
+			Constant const* c = dynamic_cast<Constant const*>(w->condition);
+			if (c != nullptr && c->num_ == 0) return;  // while False: sparisce
+			w->block = block(w->block, false);
+		}
+		out.push_back(st);
+	}
+
+	// if con condizione costante: resta solo il ramo scelto. Al top-level un
+	// break/continue termina lo statement corrente, quindi il ramo viene
+	// sciolto nel programma solo se non ne contiene
+	void branch(ifStatement* i, bool topLevel, std::vector<Statement*>& out) {
+		i->condition = expression(i->condition);
+		i->block = block(i->block, false);
+		if (i->elifBlock != nullptr) {
+			std::vector<Statement*> rest;
+			branch(i->elifBlock, false, rest);
+			ifStatement* elif = rest.size() == 1 ? dynamic_cast<ifStatement*>(rest[0]) : nullptr;
+			if (elif != nullptr) {
+				i->elifBlock = elif;
+			}
+			else {
+				i->elifBlock = nullptr;
+				i->elseBlock = arena_.copy(rest);
+			}
+		}
+		else {
+			i->elseBlock = block(i->elseBlock, false);
+		}
+
+		Constant const* c = dynamic_cast<Constant const*>(i->condition);
+		if (c == nullptr) {
+			out.push_back(i);
+			return;
+		}
+		std::vector<Statement*> taken;
+		if (c->num_ != 0) taken.assign(i->block.begin(), i->block.end());
+		else if (i->elifBlock != nullptr) taken.push_back(i->elifBlock);
+		else taken.assign(i->elseBlock.begin(), i->elseBlock.end());
+		if (topLevel) {
+			for (Statement const* st : taken) {
+				if (escapes(st)) {
+					out.push_back(i);
+					return;
+				}
+			}
+		}
+		out.insert(out.end(), taken.begin(), taken.end());
+	}
+
+	Expression* expression(Expression* e) {
+		if (auto m = dynamic_cast<mathExpression*>(e)) {
+			m->left_ = expression(m->left_);
+			m->right_ = expression(m->right_);
+			return math(m);
+		}
+		if (auto r = dynamic_cast<relExpression*>(e)) {
+			r->left_ = expression(r->left_);
+			r->right_ = expression(r->right_);
+			auto lc = dynamic_cast<Constant const*>(r->left_);
+			auto rc = dynamic_cast<Constant const*>(r->right_);
+			if (lc && rc) return constant(compare(r->opCode_, lc->num_, rc->num_));
+			return r;
+		}
+		if (auto u = dynamic_cast<unaryExpression*>(e)) {
+			u->operand_ = expression(u->operand_);
+			return unary(u);
+		}
+		if (auto a = dynamic_cast<andExpr*>(e)) {
+			a->left_ = expression(a->left_);
+			a->right_ = expression(a->right_);
+			return logical(a, a->left_, a->right_, false);
+		}
+		if (auto o = dynamic_cast<orExpr*>(e)) {
+			o->left_ = expression(o->left_);
+			o->right_ = expression(o->right_);
+			return logical(o, o->left_, o->right_, true);
+		}
+		if (auto l = dynamic_cast<listAccess*>(e)) {
+			l->index_ = expression(l->index_);
+		}
+		return e;
+	}
+
+	// + - * fanno il giro come nell'interprete; la divisione per zero e
+	// INT_MIN // -1 restano a runtime
+	Expression* math(mathExpression* m) {
+		auto lc = dynamic_cast<Constant const*>(m->left_);
+		auto rc = dynamic_cast<Constant const*>(m->right_);
+		if (lc && rc) {
+			unsigned l = static_cast<unsigned>(lc->num_);
+			unsigned r = static_cast<unsigned>(rc->num_);
+			switch (m->opCode_) {
+			case Token::ADD: return constant(static_cast<int>(l + r));
+			case Token::SUB: return constant(static_cast<int>(l - r));
+			case Token::MUL: return constant(static_cast<int>(l * r));
+			case Token::INTDIV:
+				if (rc->num_ == 0 || (lc->num_ == INT_MIN && rc->num_ == -1)) return m;
+				return constant(lc->num_ / rc->num_);
+			}
+			return m;
+		}
+		switch (m->opCode_) {
+		case Token::ADD:
+			if (is(rc, 0)) return m->left_;
+			if (is(lc, 0)) return m->right_;
+			break;
+		case Token::SUB:
+			if (is(rc, 0)) return m->left_;
+			break;
+		case Token::MUL:
+			if (is(rc, 1)) return m->left_;
+			if (is(lc, 1)) return m->right_;
+			break;
+		case Token::INTDIV:
+			if (is(rc, 1)) return m->left_;
+			break;
+		}
+		return m;
+	}
+
+	Expression* unary(unaryExpression* u) {
+		if (auto c = dynamic_cast<Constant const*>(u->operand_)) {
+			if (u->opCode_ == Token::SUB) return constant(static_cast<int>(0u - static_cast<unsigned>(c->num_)));
+			if (u->opCode_ == Token::NOT) return constant(c->num_ == 0);
+			return u;
+		}
+		auto inner = dynamic_cast<unaryExpression*>(u->operand_);
+		// - - x == x (anche per INT_MIN); not not b == b se b vale già 0 o 1
+		if (inner != nullptr && inner->opCode_ == u->opCode_) {
+			if (u->opCode_ == Token::SUB || boolean(inner->operand_)) return inner->operand_;
+		}
+		// not (a < b) == a >= b
+		if (u->opCode_ == Token::NOT) {
+			if (auto r = dynamic_cast<relExpression*>(u->operand_)) {
+				r->opCode_ = negate(r->opCode_);
+				return r;
+			}
+		}
+		return u;
+	}
+
+	// Con il lato sinistro costante il destro viene valutato solo se serve;
+	// con il destro costante il sinistro va comunque valutato
+	Expression* logical(Expression* e, Expression* left, Expression* right, bool isOr) {
+		auto lc = dynamic_cast<Constant const*>(left);
+		auto rc = dynamic_cast<Constant const*>(right);
+		if (lc != nullptr) {
+			bool l = lc->num_ != 0;
+			if (l == isOr) return constant(isOr);
+			if (rc != nullptr) return constant(rc->num_ != 0);
+			return boolean(right) ? right : e;
+		}
+		if (rc != nullptr && (rc->num_ != 0) != isOr && boolean(left)) return left;
+		return e;
+	}
+
+	Constant* constant(int value) {
+		return arena_.make<Constant>(value);
+	}
+
+	static bool is(Constant const* c, int value) {
+		return c != nullptr && c->num_ == value;
+	}
+
+	// Espressioni che valgono sempre 0 o 1
+	static bool boolean(Expression const* e) {
+		if (auto c = dynamic_cast<Constant const*>(e)) return c->num_ == 0 || c->num_ == 1;
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return u->opCode_ == Token::NOT;
+		return dynamic_cast<relExpression const*>(e) || dynamic_cast<andExpr const*>(e)
+			|| dynamic_cast<orExpr const*>(e);
+	}
+
+	static int compare(int opCode, int l, int r) {
+		switch (opCode) {
+		case Token::LT:  return l < r;
+		case Token::LTE: return l <= r;
+		case Token::GT:  return l > r;
+		case Token::GTE: return l >= r;
+		case Token::EQEQ: return l == r;
+		case Token::NEQ:  return l != r;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+	}
+
+	static int negate(int opCode) {
+		switch (opCode) {
+		case Token::LT:  return Token::GTE;
+		case Token::LTE: return Token::GT;
+		case Token::GT:  return Token::LTE;
+		case Token::GTE: return Token::LT;
+		case Token::EQEQ: return Token::NEQ;
+		case Token::NEQ:  return Token::EQEQ;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+	}
+
+	// break/continue che escono dallo statement (non racchiusi in un while)
+	static bool escapes(Statement const* st) {
+		if (dynamic_cast<Break const*>(st) || dynamic_cast<Continue const*>(st)) return true;
+		if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			for (Statement const* s : i->block) if (escapes(s)) return true;
+			for (Statement const* s : i->elseBlock) if (escapes(s)) return true;
+			return i->elifBlock != nullptr && escapes(i->elifBlock);
+		}
+		return false;
+	}
+
+	static std::size_t size(Statement const* st) {
+		if (auto d = dynamic_cast<Definition const*>(st)) return 2 + size(d->expression_);
+		if (auto p = dynamic_cast<Print const*>(st)) return 1 + size(p->expr_);
+		if (auto a = dynamic_cast<listAppend const*>(st)) return 1 + size(a->expr_);
+		if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			std::size_t n = 1 + size(i->condition) + size(i->block) + size(i->elseBlock);
+			return i->elifBlock != nullptr ? n + size(i->elifBlock) : n;
+		}
+		if (auto w = dynamic_cast<whileStatement const*>(st)) return 1 + size(w->condition) + size(w->block);
+		return 1;
+	}
+
+	static std::size_t size(Expression const* e) {
+		if (auto m = dynamic_cast<mathExpression const*>(e)) return 1 + size(m->left_) + size(m->right_);
+		if (auto r = dynamic_cast<relExpression const*>(e)) return 1 + size(r->left_) + size(r->right_);
+		if (auto a = dynamic_cast<andExpr const*>(e)) return 1 + size(a->left_) + size(a->right_);
+		if (auto o = dynamic_cast<orExpr const*>(e)) return 1 + size(o->left_) + size(o->right_);
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return 1 + size(u->operand_);
+		if (auto l = dynamic_cast<listAccess const*>(e)) return 1 + size(l->index_);
+		return 1;
+	}
+};
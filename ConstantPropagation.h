@@ -0,0 +1,239 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#include "Syntax.h"
+#include "Token.h"
+
+// Propagazione delle costanti condizionale (SCCP) sugli statement, eseguita
+// dopo il Resolver. Per ogni slot calcola un valore astratto: sconosciuto
+// (nessun cammino raggiunge il punto), mai assegnato, costante, o variabile.
+// Le condizioni costanti rendono irraggiungibili i rami non presi, che non
+// contribuiscono ai valori; i while vengono iterati fino al punto fisso.
+// Le letture dimostrate costanti diventano nodi Constant: una lettura viene
+// sostituita solo se la variabile è assegnata su tutti i cammini, quindi
+// l'errore di identificatore non dichiarato non può sparire. Il
+// ConstantFolder eseguito dopo calcola le espressioni e pota i rami morti.
+class ConstantPropagation {
+
+public:
+	// Restituisce il numero di letture sostituite
+	static std::size_t propagate(Program& program) {
+		ConstantPropagation pass{ program.arena, program.symbols.size() };
+		State state = pass.entry();
+		for (Statement* statement : program.statements) {
+			// break/continue fuori da un while saltano alla fine dello statement
+			pass.loops_.push_back(Loop{ unreachable(), unreachable() });
+			pass.statement(statement, state, true);
+			state = join(state, pass.loops_.back().breaks);
+			state = join(state, pass.loops_.back().continues);
+			pass.loops_.pop_back();
+		}
+		return pass.replaced_;
+	}
+
+private:
+	struct Value {
+		enum Kind { NONE, UNDEFINED, CONSTANT, VARIABLE };
+		Kind kind = NONE;
+		int num = 0;
+
+		bool operator==(Value const& other) const {
+			return kind == other.kind && (kind != CONSTANT || num == other.num);
+		}
+		bool operator!=(Value const& other) const { return !(*this == other); }
+	};
+
+	// Valori degli slot in un punto del programma; vuoto se irraggiungibile
+	using State = std::vector<Value>;
+
+	struct Loop {
+		State breaks;
+		State continues;
+	};
+
+	ConstantPropagation(Arena& arena, std::size_t slots) : arena_{ arena }, slots_{ slots } { }
+
+	Arena& arena_;
+	std::size_t slots_;
+	std::vector<Loop> loops_;
+	std::size_t replaced_ = 0;
+
+	State entry() const {
+		return State(slots_, Value{ Value::UNDEFINED, 0 });
+	}
+
+	static State unreachable() { return {}; }
+
+	static Value constant(int num) { return Value{ Value::CONSTANT, num }; }
+	static Value variable() { return Value{ Value::VARIABLE, 0 }; }
+
+	static Value join(Value const& a, Value const& b) {
+		if (a.kind == Value::NONE) return b;
+		if (b.kind == Value::NONE || a == b) return a;
+		return variable();
+	}
+
+	static State join(State const& a, State const& b) {
+		if (a.empty()) return b;
+		if (b.empty()) return a;
+		State joined(a.size());
+		for (std::size_t k = 0; k < a.size(); ++k) joined[k] = join(a[k], b[k]);
+		return joined;
+	}
+
+	// Con rewrite == false si calcolano solo i valori (iterazioni del punto
+	// fisso); le sostituzioni avvengono nell'ultima passata
+	void statement(Statement* st, State& state, bool rewrite) {
+		if (state.empty()) return;
+		if (auto d = dynamic_cast<Definition*>(st)) {
+			Value v = expression(d->expression_, state, rewrite);
+			state[d->variable_->slot_] = v.kind == Value::CONSTANT ? v : variable();
+		}
+		else if (auto p = dynamic_cast<Print*>(st)) {
+			expression(p->expr_, state, rewrite);
+		}
+		else if (auto a = dynamic_cast<listAppend*>(st)) {
+			expression(a->expr_, state, rewrite);
+		}
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			branch(i, state, rewrite);
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			loop(w, state, rewrite);
+		}
+		else if (dynamic_cast<Break*>(st)) {
+			loops_.back().breaks = join(loops_.back().breaks, state);
+			state = unreachable();
+		}
+		else if (dynamic_cast<Continue*>(st)) {
+			loops_.back().continues = join(loops_.back().continues, state);
+			state = unreachable();
+		}
+	}
+
+	void block(NodeList<Statement*> const& statements, State& state, bool rewrite) {
+		for (Statement* st : statements) statement(st, state, rewrite);
+	}
+
+	void branch(ifStatement* i, State& state, bool rewrite) {
+		if (state.empty()) return;
+		Value c = expression(i->condition, state, rewrite);
+		State taken = c.kind == Value::CONSTANT && c.num == 0 ? unreachable() : state;
+		State other = c.kind == Value::CONSTANT && c.num != 0 ? unreachable() : std::move(state);
+		block(i->block, taken, rewrite);
+		if (i->elifBlock != nullptr) branch(i->elifBlock, other, rewrite);
+		else block(i->elseBlock, other, rewrite);
+		state = join(taken, other);
+	}
+
+	// Lo stato in testa al ciclo cresce a ogni iterazione (ogni slot può solo
+	// salire nel reticolo), quindi il punto fisso arriva in pochi passi
+	void loop(whileStatement* w, State& state, bool rewrite) {
+		State head = state;
+		for (;;) {
+			Pass pass = iterate(w, head, false);
+			State next = join(head, join(pass.end, pass.continues));
+			if (next == head) break;
+			head = std::move(next);
+		}
+		Pass pass = iterate(w, head, rewrite);
+		state = join(pass.exit, pass.breaks);
+	}
+
+	// Stati prodotti da una passata del ciclo a partire dalla testa
+	struct Pass {
+		State exit;       // uscita per condizione falsa
+		State end;        // fine del corpo
+		State breaks;
+		State continues;
+	};
+
+	Pass iterate(whileStatement* w, State const& head, bool rewrite) {
+		Pass pass;
+		State body = head;
+		Value c = expression(w->condition, body, rewrite);
+		if (c.kind != Value::CONSTANT || c.num == 0) pass.exit = head;
+		if (c.kind == Value::CONSTANT && c.num == 0) body = unreachable();
+		loops_.push_back(Loop{ unreachable(), unreachable() });
+		block(w->block, body, rewrite);
+		pass.breaks = std::move(loops_.back().breaks);
+		pass.continues = std::move(loops_.back().continues);
+		loops_.pop_back();
+		pass.end = std::move(body);
+		return pass;
+	}
+
+	Value expression(Expression*& e, State const& state, bool rewrite) {
+		if (auto v = dynamic_cast<Variable*>(e)) {
+			Value value = state[v->slot_];
+			if (value.kind != Value::CONSTANT) return variable();
+			if (rewrite) {
+				e = arena_.make<Constant>(value.num);
+				++replaced_;
+			}
+			return value;
+		}
+		if (auto c = dynamic_cast<Constant*>(e)) {
+			return constant(c->num_);
+		}
+		if (auto m = dynamic_cast<mathExpression*>(e)) {
+			Value l = expression(m->left_, state, rewrite);
+			Value r = expression(m->right_, state, rewrite);
+			if (l.kind != Value::CONSTANT || r.kind != Value::CONSTANT) return variable();
+			unsigned a = static_cast<unsigned>(l.num);
+			unsigned b = static_cast<unsigned>(r.num);
+			switch (m->opCode_) {
+			case Token::ADD: return constant(static_cast<int>(a + b));
+			case Token::SUB: return constant(static_cast<int>(a - b));
+			case Token::MUL: return constant(static_cast<int>(a * b));
+			case Token::INTDIV:
+				if (r.num == 0 || (l.num == INT_MIN && r.num == -1)) return variable();
+				return constant(l.num / r.num);
+			}
+			return variable();
+		}
+		if (auto r = dynamic_cast<relExpression*>(e)) {
+			Value a = expression(r->left_, state, rewrite);
+			Value b = expression(r->right_, state, rewrite);
+			if (a.kind != Value::CONSTANT || b.kind != Value::CONSTANT) return variable();
+			switch (r->opCode_) {
+			case Token::LT:  return constant(a.num < b.num);
+			case Token::LTE: return constant(a.num <= b.num);
+			case Token::GT:  return constant(a.num > b.num);
+			case Token::GTE: return constant(a.num >= b.num);
+			case Token::EQEQ: return constant(a.num == b.num);
+			case Token::NEQ:  return constant(a.num != b.num);
+			}
+			return variable();
+		}
+		if (auto u = dynamic_cast<unaryExpression*>(e)) {
+			Value v = expression(u->operand_, state, rewrite);
+			if (v.kind != Value::CONSTANT) return variable();
+			if (u->opCode_ == Token::SUB) return constant(static_cast<int>(0u - static_cast<unsigned>(v.num)));
+			if (u->opCode_ == Token::NOT) return constant(v.num == 0);
+			return variable();
+		}
+		if (auto a = dynamic_cast<andExpr*>(e)) {
+			return logical(a->left_, a->right_, state, rewrite, false);
+		}
+		if (auto o = dynamic_cast<orExpr*>(e)) {
+			return logical(o->left_, o->right_, state, rewrite, true);
+		}
+		if (auto l = dynamic_cast<listAccess*>(e)) {
+			expression(l->index_, state, rewrite);
+		}
+		return variable();
+	}
+
+	Value logical(Expression*& left, Expression*& right, State const& state, bool rewrite, bool isOr) {
+		Value l = expression(left, state, rewrite);
+		Value r = expression(right, state, rewrite);
+		if (l.kind != Value::CONSTANT) return variable();
+		if ((l.num != 0) == isOr) return constant(isOr);
+		if (r.kind != Value::CONSTANT) return variable();
+		return constant(r.num != 0);
+	}
+};
@@ -1,184 +1,357 @@
-#pragma once
-
-#include <iostream>
-
-#include "Visitor.h"
-#include "SymbolTable.h"
-
-class EvaluationVisitor : public Visitor {
-	
-public:
-    EvaluationVisitor(SymbolTable& st, std::ostream& con)
-        : symbolTable_{ st }, console_{ con } {
-    }
-
-    ~EvaluationVisitor() = default;
-
-    // Program
-    void visit(Program const& p) override {
-        for (Statement* statement : p.statements) {
-            try {
-                statement->accept(*this);
-            }
-            // Qui siamo fuori dal loop while, quindi ignoro break/continue trovati come da istruzioni
-            catch (BreakThrowable& b) {}
-			catch (ContinueThrowable& c) {}
-        }
-    }
-
-    // Definition
-    void visit(Definition const& d) override {
-        int value = evaluateExpression(*d.expression_);
-        symbolTable_.setValue(d.variable_->id_, value);
-    }
-
-    // Expression
-    void visit(Expression const& o) override {
-        throw std::runtime_error("ERROR: Expression visit should not be called.");
-	}
-
-	// ifStatement (vale per if, elif, else)
-    void visit(ifStatement const& i) override {
-        if (evaluateExpression(*i.condition)) {
-            for (auto* st : i.block) st->accept(*this);
-        }
-        else if (i.elifBlock) {
-            i.elifBlock->accept(*this);
-        }
-        else {
-            for (auto* st : i.elseBlock) st->accept(*this);
-        }
-    }
-
-	// whileStatement (se trovo break/continue faccio BreakThrowable/ContinueThrowable)
-    void visit(whileStatement const& w) override {
-        while (evaluateExpression(*w.condition)) {
-            try {
-                for (auto* st : w.block) {
-                    st->accept(*this);
-                }
-            }
-            catch (BreakThrowable& b) {
-                break;
-            }
-            catch (ContinueThrowable& c) {
-                continue;
-			}
-        }
-    }
-
-    // Break
-    void visit(Break const& b) override {
-        throw BreakThrowable{};
-	}
-
-    // Continue
-    void visit(Continue const& c) override {
-        throw ContinueThrowable{};
-    }
-    
-    // Print
-    void visit(Print const& p) override {
-        int value = evaluateExpression(*p.expr_);
-        console_ << value << std::endl;
-    }
-
-    
-    // orExpr
-    void visit(orExpr const& e) override {
-        int l = evaluateExpression(*e.left_);
-		if (l != 0) { lastValue_ = 1; return; }  // non valuto r per short-circuit
-        int r = evaluateExpression(*e.right_);
-        lastValue_ = (l || r);
-
-    }
-
-    // andExpr
-    void visit(andExpr const& e) override {
-        int l = evaluateExpression(*e.left_);
-        if (l == 0) { lastValue_ = 0; return; }  // non valuto r per short-circuit
-        int r = evaluateExpression(*e.right_);
-        lastValue_ = (l && r);
-
-    }
-
-    // relExpression
-    void visit(relExpression const& e) override {
-        int l = evaluateExpression(*e.left_);
-        int r = evaluateExpression(*e.right_);
-        switch (e.opCode_) {
-        case Token::LT:  lastValue_ = (l < r); break;
-        case Token::LTE: lastValue_ = (l <= r); break;
-        case Token::GT:  lastValue_ = (l > r); break;
-        case Token::GTE: lastValue_ = (l >= r); break;
-        case Token::EQEQ: lastValue_ = (l == r); break;
-        case Token::NEQ:  lastValue_ = (l != r); break;
-        default: throw std::runtime_error("ERROR: Unknown relational operator.");
-        }
-    }
-
-    // mathExpression
-    void visit(mathExpression const& e) override {
-        int l = evaluateExpression(*e.left_);
-        int r = evaluateExpression(*e.right_);
-        switch (e.opCode_) {
-        case Token::ADD: lastValue_ = l + r; break;
-        case Token::SUB: lastValue_ = l - r; break;
-        case Token::MUL: lastValue_ = l * r; break;
-        case Token::INTDIV:
-            if (r == 0) throw std::runtime_error("ERROR: Division by zero.");
-            lastValue_ = l / r;
-            break;
-        default: throw std::runtime_error("ERROR: Unknown math operator.");
-        }
-    }
-
-    // unaryExpression
-    void visit(unaryExpression const& e) override {
-        int val = evaluateExpression(*e.operand_);
-        if (e.opCode_ == Token::SUB) lastValue_ = -val;
-        else if (e.opCode_ == Token::NOT) lastValue_ = (val == 0);
-        else throw std::runtime_error("ERROR: Unknown unary operator.");
-    }
-
-    // Variable
-    void visit(Variable const& v) override {
-        lastValue_ = symbolTable_.getValue(v.id_);
-    }
-
-    // Constant
-    void visit(Constant const& c) override {
-        lastValue_ = c.num_;
-    }
-
-	// Prendo l'ultimo valore calcolato
-    int getValue() const { return lastValue_; }
-
-	// ListInit
-    void visit(listInit const& l) override {
-        symbolTable_.setList(l.id_);
-	}
-
-	// listAppend
-    void visit(listAppend const& l) override {
-        int value = evaluateExpression(*l.expr_);
-        symbolTable_.appendToList(l.id_, value);
-	}
-
-    // listAccess
-    void visit(listAccess const& e) override {
-        int index = evaluateExpression(*e.index_);
-        lastValue_ = symbolTable_.getListValue(e.id_, index);
-	}
-
-private:
-    SymbolTable& symbolTable_;
-    std::ostream& console_;
-    int lastValue_ = 0;
-
-	// Faccio l'espressione e ritorno il valore calcolato
-    int evaluateExpression(Expression const& expr) {
-        expr.accept(*this);
-        return lastValue_;
-    }
+#pragma once
+
+#include "Visitor.h"
+#include "OutputSink.h"
+#include "SymbolTable.h"
+#include "FlatAst.h"
+#include "Jit.h"
+#include "MagicDivision.h"
+#include "SwitchLowering.h"
+
+class EvaluationVisitor : public Visitor {
+	
+public:
+    // Con jit != nullptr i while caldi vengono compilati in codice nativo
+    EvaluationVisitor(SymbolTable& st, OutputSink& con, Jit* jit = nullptr)
+        : symbolTable_{ st }, console_{ con }, jit_{ jit } {
+    }
+
+    ~EvaluationVisitor() = default;
+
+    // Program (uno stesso evaluator può eseguire più programmi: si riparte da zero)
+    void visit(Program const& p) override {
+        lastValue_ = 0;
+        completion_ = Completion::NORMAL;
+        for (Statement* statement : p.statements) {
+            statement->accept(*this);
+            // Qui siamo fuori dal loop while, quindi ignoro break/continue trovati come da istruzioni
+            completion_ = Completion::NORMAL;
+        }
+    }
+
+    // Definition
+    void visit(Definition const& d) override {
+        int value = evaluateExpression(*d.expression_);
+        symbolTable_.setValue(d.variable_->slot_, value);
+    }
+
+    // Expression
+    void visit(Expression const& o) override {
+        throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+
+	// ifStatement (vale per if, elif, else)
+    void visit(ifStatement const& i) override {
+        if (i.dispatch_ != nullptr) {
+            dispatch(*i.dispatch_);
+            return;
+        }
+        if (evaluateExpression(*i.condition)) {
+            executeBlock(i.block);
+        }
+        else if (i.elifBlock) {
+            i.elifBlock->accept(*this);
+        }
+        else {
+            executeBlock(i.elseBlock);
+        }
+    }
+
+	// whileStatement (break/continue arrivano come completion_ dal blocco)
+    void visit(whileStatement const& w) override {
+        Jit::Loop* loop = jit_ != nullptr ? &jit_->loop(w) : nullptr;
+        while (evaluateExpression(*w.condition)) {
+            executeBlock(w.block);
+            if (completion_ == Completion::BREAK) {
+                completion_ = Completion::NORMAL;
+                break;
+            }
+            completion_ = Completion::NORMAL;
+            // Ciclo caldo: le iterazioni rimanenti girano in codice nativo. Se il
+            // codice nativo si ferma (es. divisione per zero) l'interprete riparte
+            // dall'ultima iterazione, con lo stato già aggiornato
+            if (loop != nullptr && jit_->hot(*loop, w, symbolTable_)) {
+                if (jit_->run(*loop, symbolTable_)) break;
+                loop = nullptr;
+            }
+        }
+    }
+
+    // Break
+    void visit(Break const& b) override {
+        completion_ = Completion::BREAK;
+	}
+
+    // Continue
+    void visit(Continue const& c) override {
+        completion_ = Completion::CONTINUE;
+    }
+    
+    // Print
+    void visit(Print const& p) override {
+        int value = evaluateExpression(*p.expr_);
+        console_.print(value);
+    }
+
+    
+    // orExpr
+    void visit(orExpr const& e) override {
+        int l = evaluateExpression(*e.left_);
+		if (l != 0) { lastValue_ = 1; return; }  // non valuto r per short-circuit
+        int r = evaluateExpression(*e.right_);
+        lastValue_ = (l || r);
+
+    }
+
+    // andExpr
+    void visit(andExpr const& e) override {
+        int l = evaluateExpression(*e.left_);
+        if (l == 0) { lastValue_ = 0; return; }  // non valuto r per short-circuit
+        int r = evaluateExpression(*e.right_);
+        lastValue_ = (l && r);
+
+    }
+
+    // relExpression
+    void visit(relExpression const& e) override {
+        int l = evaluateExpression(*e.left_);
+        int r = evaluateExpression(*e.right_);
+        switch (e.opCode_) {
+        case Token::LT:  lastValue_ = (l < r); break;
+        case Token::LTE: lastValue_ = (l <= r); break;
+        case Token::GT:  lastValue_ = (l > r); break;
+        case Token::GTE: lastValue_ = (l >= r); break;
+        case Token::EQEQ: lastValue_ = (l == r); break;
+        case Token::NEQ:  lastValue_ = (l != r); break;
+        default: throw std::runtime_error("ERROR: Unknown relational operator.");
+        }
+    }
+
+    // mathExpression
+    void visit(mathExpression const& e) override {
+        int l = evaluateExpression(*e.left_);
+        int r = evaluateExpression(*e.right_);
+        switch (e.opCode_) {
+        case Token::ADD: lastValue_ = l + r; break;
+        case Token::SUB: lastValue_ = l - r; break;
+        case Token::MUL: lastValue_ = l * r; break;
+        case Token::INTDIV:
+            if (e.shift_ >= 0) {
+                lastValue_ = MagicDivisor::divide(l, r, e.magic_, e.shift_);
+                break;
+            }
+            if (r == 0) throw std::runtime_error("ERROR: Division by zero.");
+            lastValue_ = l / r;
+            break;
+        default: throw std::runtime_error("ERROR: Unknown math operator.");
+        }
+    }
+
+    // unaryExpression
+    void visit(unaryExpression const& e) override {
+        int val = evaluateExpression(*e.operand_);
+        if (e.opCode_ == Token::SUB) lastValue_ = -val;
+        else if (e.opCode_ == Token::NOT) lastValue_ = (val == 0);
+        else throw std::runtime_error("ERROR: Unknown unary operator.");
+    }
+
+    // Variable
+    void visit(Variable const& v) override {
+        lastValue_ = symbolTable_.getValue(v.slot_);
+    }
+
+    // Constant
+    void visit(Constant const& c) override {
+        lastValue_ = c.num_;
+    }
+
+	// Prendo l'ultimo valore calcolato
+    int getValue() const { return lastValue_; }
+
+    // Esecuzione dell'AST piatto: stessa semantica dei visit, ma i nodi sono
+    // indici negli array di FlatAst e non serve il double dispatch
+    void run(FlatAst const& ast) {
+        for (std::uint32_t statement : ast.statements()) {
+            // break/continue fuori dal while vengono ignorati
+            execute(ast, statement);
+        }
+    }
+
+	// ListInit
+    void visit(listInit const& l) override {
+        symbolTable_.setList(l.slot_);
+	}
+
+	// listAppend
+    void visit(listAppend const& l) override {
+        int value = evaluateExpression(*l.expr_);
+        symbolTable_.appendToList(l.slot_, value);
+	}
+
+    // listAccess
+    void visit(listAccess const& e) override {
+        int index = evaluateExpression(*e.index_);
+        lastValue_ = e.inBounds_ ? symbolTable_.getListValueUnchecked(e.slot_, index)
+                                 : symbolTable_.getListValue(e.slot_, index);
+	}
+
+private:
+    // Esito dell'ultimo statement: break/continue risalgono fino al while
+    // che li contiene (o fino a Program, che li ignora)
+    enum class Completion { NORMAL, BREAK, CONTINUE };
+
+    SymbolTable& symbolTable_;
+    OutputSink& console_;
+    Jit* jit_;
+    int lastValue_ = 0;
+    Completion completion_ = Completion::NORMAL;
+
+    // Esegue un blocco fermandosi al primo break/continue
+    void executeBlock(NodeList<Statement*> const& block) {
+        for (auto* st : block) {
+            st->accept(*this);
+            if (completion_ != Completion::NORMAL) return;
+        }
+    }
+
+    // Catena if/elif annotata da SwitchLowering: una lettura e un salto
+    void dispatch(Dispatch const& d) {
+        int arm = d.table.find(evaluateExpression(*d.subject));
+        if (arm >= 0) executeBlock(d.arms[arm]->block);
+        else if (d.rest != nullptr) d.rest->accept(*this);
+        else executeBlock(d.otherwise);
+    }
+
+    Completion executeBlock(FlatAst const& ast, FlatAst::Block block) {
+        for (std::uint32_t st : block) {
+            Completion c = execute(ast, st);
+            if (c != Completion::NORMAL) return c;
+        }
+        return Completion::NORMAL;
+    }
+
+	// Faccio l'espressione e ritorno il valore calcolato
+    int evaluateExpression(Expression const& expr) {
+        expr.accept(*this);
+        return lastValue_;
+    }
+
+    Completion execute(FlatAst const& ast, std::uint32_t i) {
+        switch (ast.kind(i)) {
+        case FlatAst::DEFINITION:
+            symbolTable_.setValue(ast.payload(i), operand(ast, FlatAst::first(i)));
+            break;
+        case FlatAst::IF:
+            // la catena di elif viene percorsa senza ricorsione, fino a un
+            // elif abbassato da SwitchLowering
+            do {
+                if (operand(ast, FlatAst::first(i))) {
+                    return executeBlock(ast, ast.ifThen(i));
+                }
+                if (ast.ifElif(i) == FlatAst::NONE) {
+                    return executeBlock(ast, ast.ifElse(i));
+                }
+                i = ast.ifElif(i);
+            } while (ast.kind(i) == FlatAst::IF);
+            return execute(ast, i);
+        case FlatAst::SWITCH: {
+            FlatAst::Switch const& s = ast.switchAt(i);
+            int arm = s.table.find(symbolTable_.getValue(s.subject));
+            if (arm >= 0) return executeBlock(ast, ast.ifThen(s.arms[arm]));
+            if (s.rest != FlatAst::NONE) return execute(ast, s.rest);
+            return executeBlock(ast, ast.ifElse(s.arms.back()));
+        }
+        case FlatAst::WHILE:
+            while (operand(ast, FlatAst::first(i))) {
+                if (executeBlock(ast, ast.whileBody(i)) == Completion::BREAK) break;
+            }
+            break;
+        case FlatAst::BREAK:
+            return Completion::BREAK;
+        case FlatAst::CONTINUE:
+            return Completion::CONTINUE;
+        case FlatAst::PRINT:
+            console_.print(operand(ast, FlatAst::first(i)));
+            break;
+        case FlatAst::LIST_INIT:
+            symbolTable_.setList(ast.payload(i));
+            break;
+        case FlatAst::LIST_APPEND:
+            symbolTable_.appendToList(ast.payload(i), operand(ast, FlatAst::first(i)));
+            break;
+        default:
+            throw std::runtime_error("ERROR: Expression visit should not be called.");
+        }
+        return Completion::NORMAL;
+    }
+
+    // Le foglie (costanti e variabili) vengono lette senza chiamata ricorsiva
+    int operand(FlatAst const& ast, std::uint32_t i) {
+        switch (ast.kind(i)) {
+        case FlatAst::CONSTANT:
+            return ast.payload(i);
+        case FlatAst::VARIABLE:
+            return symbolTable_.getValue(ast.payload(i));
+        default:
+            return evaluate(ast, i);
+        }
+    }
+
+    int evaluate(FlatAst const& ast, std::uint32_t i) {
+        switch (ast.kind(i)) {
+        case FlatAst::CONSTANT:
+            return ast.payload(i);
+        case FlatAst::VARIABLE:
+            return symbolTable_.getValue(ast.payload(i));
+        case FlatAst::OR:
+            if (operand(ast, FlatAst::first(i)) != 0) return 1;
+            return operand(ast, ast.second(i)) != 0;
+        case FlatAst::AND:
+            if (operand(ast, FlatAst::first(i)) == 0) return 0;
+            return operand(ast, ast.second(i)) != 0;
+        case FlatAst::REL: {
+            int l = operand(ast, FlatAst::first(i));
+            int r = operand(ast, ast.second(i));
+            switch (ast.op(i)) {
+            case Token::LT:  return l < r;
+            case Token::LTE: return l <= r;
+            case Token::GT:  return l > r;
+            case Token::GTE: return l >= r;
+            case Token::EQEQ: return l == r;
+            case Token::NEQ:  return l != r;
+            default: throw std::runtime_error("ERROR: Unknown relational operator.");
+            }
+        }
+        case FlatAst::MATH: {
+            int l = operand(ast, FlatAst::first(i));
+            int r = operand(ast, ast.second(i));
+            switch (ast.op(i)) {
+            case Token::ADD: return l + r;
+            case Token::SUB: return l - r;
+            case Token::MUL: return l * r;
+            case Token::INTDIV:
+                if (r == 0) throw std::runtime_error("ERROR: Division by zero.");
+                return l / r;
+            default: throw std::runtime_error("ERROR: Unknown math operator.");
+            }
+        }
+        case FlatAst::DIVIDE: {
+            FlatAst::Division const& d = ast.division(i);
+            return MagicDivisor::divide(operand(ast, FlatAst::first(i)), d.divisor, d.multiplier, d.shift);
+        }
+        case FlatAst::UNARY: {
+            int val = operand(ast, FlatAst::first(i));
+            if (ast.op(i) == Token::SUB) return -val;
+            if (ast.op(i) == Token::NOT) return val == 0;
+            throw std::runtime_error("ERROR: Unknown unary operator.");
+        }
+        case FlatAst::LIST_ACCESS: {
+            int index = operand(ast, FlatAst::first(i));
+            return ast.inBounds(i) ? symbolTable_.getListValueUnchecked(ast.payload(i), index)
+                                   : symbolTable_.getListValue(ast.payload(i), index);
+        }
+        default:
+            throw std::runtime_error("ERROR: Statement used as an expression.");
+        }
+    }
 };
\ No newline at end of file
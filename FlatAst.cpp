@@ -0,0 +1,193 @@
+#include <stdexcept>
+#include <utility>
+
+#include "FlatAst.h"
+#include "Visitor.h"
+
+// Visita l'albero e scrive i nodi in preordine negli array di FlatAst
+class FlatAstBuilder : public Visitor {
+public:
+	explicit FlatAstBuilder(FlatAst& ast) : ast_{ ast } {}
+
+	// Gli statement di primo livello formano il blocco radice solo in finish
+	void visit(Program const& p) override {
+		for (Statement const* statement : p.statements) {
+			ast_.top_.push_back(static_cast<std::uint32_t>(ast_.kind_.size()));
+			statement->accept(*this);
+		}
+	}
+
+	void visit(Definition const& d) override {
+		add(FlatAst::DEFINITION, 0, d.variable_->slot_);
+		d.expression_->accept(*this);
+	}
+
+	void visit(Expression const& o) override {
+		throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+
+	void visit(Variable const& v) override {
+		add(FlatAst::VARIABLE, 0, v.slot_);
+	}
+
+	void visit(Constant const& c) override {
+		add(FlatAst::CONSTANT, 0, c.num_);
+	}
+
+	// Catena abbassata da SwitchLowering: SWITCH e poi la catena stessa, che
+	// serve per la stampa e per i blocchi dei rami
+	void visit(ifStatement const& i) override {
+		if (i.dispatch_ == nullptr) {
+			chain(i);
+			return;
+		}
+		Dispatch const& d = *i.dispatch_;
+		std::uint32_t node = add(FlatAst::SWITCH, 0, static_cast<std::int32_t>(ast_.switches_.size()));
+		if (ast_.tables_ == nullptr) ast_.tables_ = std::make_unique<Arena>();
+		FlatAst::Switch s{ d.subject->slot_, SwitchTable::build(*ast_.tables_, std::vector<int>(d.values.begin(), d.values.end())), {}, FlatAst::NONE };
+		std::size_t k = ast_.switches_.size();
+		ast_.switches_.push_back(std::move(s));
+		chain(i);
+		// i rami sono i primi IF della catena; il resto è l'elif dell'ultimo
+		std::uint32_t arm = FlatAst::first(node);
+		for (std::size_t n = 0; n < d.arms.size(); ++n) {
+			ast_.switches_[k].arms.push_back(arm);
+			arm = ast_.ifElif(arm);
+		}
+		ast_.switches_[k].rest = arm;
+	}
+
+	void visit(whileStatement const& w) override {
+		std::uint32_t node = add(FlatAst::WHILE, 0, 0);
+		w.condition->accept(*this);
+		ast_.payload_[node] = static_cast<std::int32_t>(block(w.block));
+	}
+
+	void visit(Break const& b) override { add(FlatAst::BREAK, 0, 0); }
+	void visit(Continue const& c) override { add(FlatAst::CONTINUE, 0, 0); }
+
+	void visit(Print const& p) override {
+		add(FlatAst::PRINT, 0, 0);
+		p.expr_->accept(*this);
+	}
+
+	void visit(listInit const& l) override {
+		add(FlatAst::LIST_INIT, 0, l.slot_);
+	}
+
+	void visit(listAppend const& l) override {
+		add(FlatAst::LIST_APPEND, 0, l.slot_);
+		l.expr_->accept(*this);
+	}
+
+	void visit(orExpr const& e) override { binary(FlatAst::OR, 0, *e.left_, *e.right_); }
+	void visit(andExpr const& e) override { binary(FlatAst::AND, 0, *e.left_, *e.right_); }
+	void visit(relExpression const& e) override { binary(FlatAst::REL, e.opCode_, *e.left_, *e.right_); }
+	// Con shift_ >= 0 il destro è una Constant (vedi ScalarEvolution)
+	void visit(mathExpression const& e) override {
+		if (e.opCode_ != Token::INTDIV || e.shift_ < 0) {
+			binary(FlatAst::MATH, e.opCode_, *e.left_, *e.right_);
+			return;
+		}
+		add(FlatAst::DIVIDE, 0, static_cast<std::int32_t>(ast_.divisions_.size()));
+		ast_.divisions_.push_back({ static_cast<Constant const*>(e.right_)->num_, e.magic_, e.shift_ });
+		e.left_->accept(*this);
+	}
+
+	void visit(unaryExpression const& e) override {
+		add(FlatAst::UNARY, e.opCode_, 0);
+		e.operand_->accept(*this);
+	}
+
+	void visit(listAccess const& e) override {
+		add(FlatAst::LIST_ACCESS, e.inBounds_ ? 1 : 0, e.slot_);
+		e.index_->accept(*this);
+	}
+
+private:
+	std::uint32_t add(FlatAst::Kind kind, int op, std::int32_t payload) {
+		std::uint32_t node = static_cast<std::uint32_t>(ast_.kind_.size());
+		ast_.kind_.push_back(kind);
+		ast_.op_.push_back(static_cast<std::uint8_t>(op));
+		ast_.payload_.push_back(payload);
+		return node;
+	}
+
+	// extra_ = [elif, then..., else...]; l'elif è un IF (o uno SWITCH) che
+	// segue i due blocchi
+	void chain(ifStatement const& i) {
+		std::uint32_t node = add(FlatAst::IF, 0, 0);
+		i.condition->accept(*this);
+		std::uint32_t at = static_cast<std::uint32_t>(ast_.extra_.size());
+		ast_.payload_[node] = static_cast<std::int32_t>(at);
+		ast_.extra_.push_back(FlatAst::NONE);
+		// entrambi i blocchi vengono riservati prima di visitare i nodi annidati,
+		// così l'else si trova subito dopo il then
+		std::uint32_t thenAt = reserve(i.block);
+		std::uint32_t elseAt = reserve(i.elseBlock);
+		fill(thenAt, i.block);
+		fill(elseAt, i.elseBlock);
+		if (i.elifBlock != nullptr) {
+			ast_.extra_[at] = static_cast<std::uint32_t>(ast_.kind_.size());
+			i.elifBlock->accept(*this);
+		}
+	}
+
+	// Il figlio sinistro è il nodo successivo, il destro va indicizzato
+	void binary(FlatAst::Kind kind, int op, Expression const& l, Expression const& r) {
+		std::uint32_t node = add(kind, op, 0);
+		l.accept(*this);
+		ast_.payload_[node] = static_cast<std::int32_t>(ast_.kind_.size());
+		r.accept(*this);
+	}
+
+	// Riserva [n, s1, ..., sn] in extra_
+	std::uint32_t reserve(NodeList<Statement*> const& statements) {
+		std::uint32_t at = static_cast<std::uint32_t>(ast_.extra_.size());
+		ast_.extra_.push_back(static_cast<std::uint32_t>(statements.size()));
+		ast_.extra_.resize(ast_.extra_.size() + statements.size());
+		return at;
+	}
+
+	// Visita gli statement riempiendo gli indici riservati
+	void fill(std::uint32_t at, NodeList<Statement*> const& statements) {
+		for (std::size_t k = 0; k < statements.size(); ++k) {
+			ast_.extra_[at + 1 + k] = static_cast<std::uint32_t>(ast_.kind_.size());
+			statements[k]->accept(*this);
+		}
+	}
+
+	std::uint32_t block(NodeList<Statement*> const& statements) {
+		std::uint32_t at = reserve(statements);
+		fill(at, statements);
+		return at;
+	}
+
+	FlatAst& ast_;
+};
+
+FlatAst FlatAst::build(Program const& program) {
+	FlatAst ast;
+	ast.append(program);
+	ast.finish({ program.symbols.begin(), program.symbols.end() });
+	return ast;
+}
+
+void FlatAst::append(Program const& program) {
+	FlatAstBuilder builder{ *this };
+	program.accept(builder);
+}
+
+void FlatAst::finish(std::vector<std::string> names) {
+	root_ = static_cast<std::uint32_t>(extra_.size());
+	extra_.push_back(static_cast<std::uint32_t>(top_.size()));
+	extra_.insert(extra_.end(), top_.begin(), top_.end());
+	top_ = {};
+	names_ = std::move(names);
+	kind_.shrink_to_fit();
+	op_.shrink_to_fit();
+	payload_.shrink_to_fit();
+	extra_.shrink_to_fit();
+	divisions_.shrink_to_fit();
+	switches_.shrink_to_fit();
+}
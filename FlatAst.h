@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Syntax.h"
+#include "SwitchLowering.h"
+
+// AST piatto, alternativo all'albero di puntatori di Syntax.h.
+// I nodi sono salvati contigui in preordine in array paralleli:
+//   kind_    tipo del nodo
+//   op_      opcode (Token::*) per relazionali, aritmetiche e unarie; per
+//            LIST_ACCESS 1 se RangeAnalysis ha dimostrato l'indice nei limiti
+//   payload_ dato specifico del tipo: costante, slot del simbolo, indice del
+//            secondo figlio, offset in extra_ per i blocchi oppure indice in
+//            divisions_ / switches_
+// Il primo figlio di un nodo è sempre il nodo successivo (i + 1), quindi solo il
+// secondo figlio di un'espressione binaria richiede un indice esplicito.
+// I blocchi di statement stanno in extra_ come [n, s1, ..., sn].
+// Le annotazioni dei passi diventano nodi propri: DIVIDE è una divisione per
+// costante con moltiplicatore e shift di ScalarEvolution (il divisore non ha
+// un nodo, il dividendo è il primo figlio), SWITCH precede la catena if/elif
+// abbassata da SwitchLowering.
+class FlatAst {
+public:
+	enum Kind : std::uint8_t {
+		DEFINITION, IF, WHILE, BREAK, CONTINUE, PRINT, LIST_INIT, LIST_APPEND,
+		VARIABLE, CONSTANT, OR, AND, REL, MATH, UNARY, LIST_ACCESS,
+		DIVIDE, SWITCH
+	};
+
+	static constexpr std::uint32_t NONE = std::numeric_limits<std::uint32_t>::max();
+
+	// Divisione per costante: n / divisor == MagicDivisor::divide(n, divisor, multiplier, shift)
+	struct Division {
+		std::int32_t divisor;
+		std::int32_t multiplier;
+		std::int32_t shift;
+	};
+
+	// Catena if/elif di SwitchLowering: arms sono i nodi IF dei rami della
+	// tabella, rest il nodo (IF o SWITCH) da cui prosegue la catena se nessun
+	// caso corrisponde, NONE se allora si esegue l'else dell'ultimo ramo
+	struct Switch {
+		std::int32_t subject;
+		SwitchTable table;
+		std::vector<std::uint32_t> arms;
+		std::uint32_t rest;
+	};
+
+	// Costruisce la versione piatta di un programma già parsato
+	static FlatAst build(Program const& program);
+
+	// Costruzione incrementale: append per ogni gruppo di statement di primo
+	// livello (il loro AST può essere liberato subito dopo), poi finish con i
+	// nomi per slot
+	void append(Program const& program);
+	void finish(std::vector<std::string> names);
+
+	// Vista su un blocco di statement in extra_
+	struct Block {
+		const std::uint32_t* begin_;
+		const std::uint32_t* end_;
+		const std::uint32_t* begin() const { return begin_; }
+		const std::uint32_t* end() const { return end_; }
+		bool empty() const { return begin_ == end_; }
+	};
+
+	std::size_t size() const { return kind_.size(); }
+	Kind kind(std::uint32_t i) const { return static_cast<Kind>(kind_[i]); }
+	int op(std::uint32_t i) const { return op_[i]; }
+	std::int32_t payload(std::uint32_t i) const { return payload_[i]; }
+
+	// Primo figlio (espressione, condizione o operando)
+	static std::uint32_t first(std::uint32_t i) { return i + 1; }
+	// Secondo figlio delle espressioni binarie
+	std::uint32_t second(std::uint32_t i) const { return static_cast<std::uint32_t>(payload_[i]); }
+
+	bool inBounds(std::uint32_t i) const { return op_[i] != 0; }
+	Division const& division(std::uint32_t i) const { return divisions_[payload_[i]]; }
+	Switch const& switchAt(std::uint32_t i) const { return switches_[payload_[i]]; }
+
+	Block statements() const { return block(root_); }
+	Block whileBody(std::uint32_t i) const { return block(static_cast<std::uint32_t>(payload_[i])); }
+	// if: extra_ = [elif, then..., else...]
+	std::uint32_t ifElif(std::uint32_t i) const { return extra_[payload_[i]]; }
+	Block ifThen(std::uint32_t i) const { return block(static_cast<std::uint32_t>(payload_[i]) + 1); }
+	Block ifElse(std::uint32_t i) const {
+		std::uint32_t thenAt = static_cast<std::uint32_t>(payload_[i]) + 1;
+		return block(thenAt + 1 + extra_[thenAt]);
+	}
+
+	// Nomi per slot (gli slot assegnati dal Resolver)
+	std::string_view name(std::int32_t slot) const { return names_[slot]; }
+	std::vector<std::string> const& names() const { return names_; }
+
+	// Memoria occupata (escluse le stringhe dei nomi e le tabelle degli switch)
+	std::size_t bytes() const {
+		return kind_.capacity() + op_.capacity()
+			+ payload_.capacity() * sizeof(std::int32_t) + extra_.capacity() * sizeof(std::uint32_t)
+			+ divisions_.capacity() * sizeof(Division) + switches_.capacity() * sizeof(Switch);
+	}
+
+private:
+	friend class FlatAstBuilder;
+
+	Block block(std::uint32_t offset) const {
+		const std::uint32_t* p = extra_.data() + offset;
+		return { p + 1, p + 1 + *p };
+	}
+
+	std::vector<std::uint8_t> kind_;
+	std::vector<std::uint8_t> op_;
+	std::vector<std::int32_t> payload_;
+	std::vector<std::uint32_t> extra_;
+	std::vector<Division> divisions_;
+	std::vector<Switch> switches_;
+	std::unique_ptr<Arena> tables_;         // tabelle degli switch
+	std::vector<std::uint32_t> top_;        // statement di primo livello, fino a finish
+	std::uint32_t root_ = 0;
+	std::vector<std::string> names_;
+};
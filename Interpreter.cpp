@@ -1,92 +1,539 @@
-#include <iostream>
-#include <fstream>
-
-#include "Token.h"
-#include "Lexer.h"
-#include "Parser.h"
-#include "SymbolTable.h"
-#include "EvaluationVisitor.h"
-#include "PrintVisitor.h"
-
-// Main cpp preso da esercizio 6
-
-int main(int argc, char* argv[])
-{
-	// Check if there is at least one input argument
-	// The first input argument (argv[0]) is always the name of the program
-	if (argc < 2) {
-		std::cerr << "No input file!" << std::endl;
-		std::cerr << "Usage: " << std::endl;
-		std::cerr << argv[0] << " <filename> " << std::endl;
-		return EXIT_FAILURE;
-	}
-
-	// Try to open the file to be interpreted
-	std::ifstream inputFile;
-	try {
-		inputFile.open(argv[1]);
-	}
-	catch (std::exception& e) {
-		// Whatever exception is raised, end up here
-		std::cerr << "Cannot open " << argv[1] << " got: " << std::endl;
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-
-	// Lexical analysis
-	Lexer tokenize;
-	std::vector<Token> inputTokens;
-	// Extract a token stream from the input stream
-	try {
-		// Avoid copying the stream of tokens
-		inputTokens = std::move(tokenize(inputFile));
-	}
-	catch (LexicalError& e) {
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-	catch (std::exception& e) {
-		std::cerr << "Cannot read from " << argv[1] << " got: " << std::endl;
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-
-	// Syntactical analysis
-	Parser pa;
-	Program* program;
-	try {
-		program = pa.doParsing(inputTokens);
-	}
-	catch (SyntaxError& e) {
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-	catch (std::exception& e) {
-		std::cerr << "Something odd happened during parsing, got: " << std::endl;
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-
-	// Semantical analysis (evaluation)
-	SymbolTable symbolTable;
-	EvaluationVisitor evaluator{ symbolTable, std::cout };
-	// PrintVisitor evaluator{std::cout};
-	try {
-		if (program != nullptr) {
-			evaluator.visit(*program);
-		}
-	}
-	catch (EvaluationError& e) {
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-	catch (std::exception& e) {
-		std::cerr << "Something odd happened during parsing, got: " << std::endl;
-		std::cerr << e.what() << std::endl;
-		return EXIT_FAILURE;
-	}
-
-
-	return EXIT_SUCCESS;
-}
-
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <condition_variable>
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "SourceBuffer.h"
+#include "Token.h"
+#include "Lexer.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "SymbolTable.h"
+#include "Jit.h"
+#include "EvaluationVisitor.h"
+#include "CompiledProgram.h"
+#include "OutputSink.h"
+#include "WorkStealingPool.h"
+#include "PrintVisitor.h"
+#include "TranspileVisitor.h"
+
+// Main cpp preso da esercizio 6
+
+// Execution engines, selected on the command line (the last option wins)
+using Engine = CompiledProgram::Engine;
+
+// What to do with a parsed program
+struct RunOptions : CompiledProgram::Options {
+	bool print = false;
+	const char* aot = nullptr;
+};
+
+// Compiles one parsed program (statistics go to `log`). Returns nullptr on error.
+static std::shared_ptr<const CompiledProgram> compileProgram(std::unique_ptr<Program> program, RunOptions const& options, std::ostream& log)
+{
+	// The C translation starts from the annotated AST, whatever the engine
+	CompiledProgram::Options compile = options;
+	if (options.aot != nullptr) compile.engine = Engine::TREE;
+	try {
+		return CompiledProgram::compile(std::move(program), compile, log);
+	}
+	catch (std::exception& e) {
+		log << "Something odd happened during parsing, got: " << std::endl;
+		log << e.what() << std::endl;
+		return nullptr;
+	}
+}
+
+// Lexing of the whole (memory-mapped) file, then parsing and compiling. Errors go
+// to `log` (and the tokens read before a lexical error to `out`), as does the lexing
+// time with --stats; returns nullptr on error.
+static std::shared_ptr<const CompiledProgram> loadFile(const char* fileName, unsigned int jobs, RunOptions const& options,
+	std::ostream& out, std::ostream& log)
+{
+	// Try to open the file to be interpreted (memory-mapped: tokens point into it)
+	std::unique_ptr<SourceBuffer> inputFile;
+	try {
+		inputFile = std::make_unique<SourceBuffer>(fileName);
+	}
+	catch (std::exception& e) {
+		// Whatever exception is raised, end up here
+		log << "Cannot open " << fileName << " got: " << std::endl;
+		log << e.what() << std::endl;
+		return nullptr;
+	}
+
+	// Lexical analysis
+	Lexer tokenize{ jobs, out };
+	TokenStream inputTokens;
+	// Extract a token stream from the input stream
+	try {
+		auto start = std::chrono::steady_clock::now();
+		// Avoid copying the stream of tokens
+		inputTokens = std::move(tokenize(inputFile->view()));
+		if (options.stats) {
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			double megabytes = static_cast<double>(inputFile->view().size()) / (1 << 20);
+			log << "Lexing: " << inputTokens.size() << " tokens, " << elapsed.count() << " ms ("
+				<< (megabytes > 0 ? elapsed.count() / megabytes : 0.0) << " ms/MB)" << std::endl;
+		}
+	}
+	catch (LexicalError& e) {
+		log << e.what() << std::endl;
+		return nullptr;
+	}
+	catch (std::exception& e) {
+		log << "Cannot read from " << fileName << " got: " << std::endl;
+		log << e.what() << std::endl;
+		return nullptr;
+	}
+
+	// Syntactical analysis. The flat engine without -O lowers every statement as
+	// soon as it is parsed, so the pointer AST of the whole script never exists
+	std::unique_ptr<Program> program;
+	try {
+		if (options.engine == Engine::FLAT && !options.optimize && options.aot == nullptr) {
+			TokenStreamSource source{ inputTokens };
+			return CompiledProgram::lowerFlat(source, options, log);
+		}
+		Parser pa;
+		program.reset(pa.doParsing(inputTokens));
+	}
+	catch (SyntaxError& e) {
+		log << e.what() << std::endl;
+		return nullptr;
+	}
+	catch (std::exception& e) {
+		log << "Something odd happened during parsing, got: " << std::endl;
+		log << e.what() << std::endl;
+		return nullptr;
+	}
+	return compileProgram(std::move(program), options, log);
+}
+
+// The parser pulls tokens from the streaming lexer through a bounded buffer, so
+// the tokens do not grow with the length of the script (the AST does: see runStream).
+// Returns nullptr on error.
+static Program* parseStream(std::istream& input)
+{
+	StreamLexer tokenize{ input };
+	StreamingSource inputTokens{ tokenize };
+	Parser pa;
+	try {
+		return pa.doParsing(inputTokens);
+	}
+	// Lexical errors show up while parsing, in source order
+	catch (LexicalError& e) {
+		tokenize.dump(std::cout);
+		std::cerr << e.what() << std::endl;
+		return nullptr;
+	}
+	catch (SyntaxError& e) {
+		std::cerr << e.what() << std::endl;
+		return nullptr;
+	}
+	catch (std::exception& e) {
+		std::cerr << "Something odd happened during parsing, got: " << std::endl;
+		std::cerr << e.what() << std::endl;
+		return nullptr;
+	}
+}
+
+// --stream: every top-level statement runs on the tree walker as soon as it has
+// been parsed, then its AST is freed. Tokens pass through the bounded buffer, so
+// memory stays constant however long the script is (only the names of the
+// identifiers are kept). The lexer reads at most a buffer ahead, so when an
+// error is found the statements before that buffer have already printed their output.
+static int runStream(std::istream& input, bool jit, OutputSink& output)
+{
+	StreamLexer tokenize{ input };
+	StreamingSource inputTokens{ tokenize };
+	Parser pa;
+	Arena names;
+	Resolver resolver;
+	SymbolTable symbolTable{ {} };
+	try {
+		pa.doParsing(inputTokens, names, [&](Program& program) {
+			// Slots already bound keep their values; new identifiers get new ones
+			resolver.visit(program);
+			for (std::size_t slot = symbolTable.size(); slot < resolver.names().size(); ++slot) {
+				symbolTable.add(resolver.names()[slot]);
+			}
+			// The JIT keys its loops by node address: the nodes die with the statement
+			Jit nativeLoops;
+			EvaluationVisitor{ symbolTable, output, jit && Jit::available() ? &nativeLoops : nullptr }.visit(program);
+		});
+	}
+	catch (LexicalError& e) {
+		output.flush();
+		tokenize.dump(std::cout);
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	catch (SyntaxError& e) {
+		output.flush();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	catch (EvaluationError& e) {
+		output.flush();
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	catch (std::exception& e) {
+		output.flush();
+		std::cerr << "Something odd happened during parsing, got: " << std::endl;
+		std::cerr << e.what() << std::endl;
+		return EXIT_FAILURE;
+	}
+	output.flush();
+	return EXIT_SUCCESS;
+}
+
+// Ahead-of-time compilation: writes output.c and builds it with the system C
+// compiler ($CC, or cc). With output "-" the C source goes to stdout.
+static int compileNative(Program const& program, std::string const& output)
+{
+	if (output == "-") {
+		TranspileVisitor{ std::cout }.visit(program);
+		return EXIT_SUCCESS;
+	}
+	std::string source = output + ".c";
+	{
+		std::ofstream file{ source };
+		if (!file) {
+			std::cerr << "Cannot open " << source << std::endl;
+			return EXIT_FAILURE;
+		}
+		TranspileVisitor{ file }.visit(program);
+	}
+	const char* cc = std::getenv("CC");
+	std::string command = std::string{ cc != nullptr && *cc != '\0' ? cc : "cc" }
+		+ " -O2 -o \"" + output + "\" \"" + source + "\"";
+	if (std::system(command.c_str()) != 0) {
+		std::cerr << "C compilation failed: " << command << std::endl;
+		return EXIT_FAILURE;
+	}
+	return EXIT_SUCCESS;
+}
+
+// Runs (or prints, or translates to C) one compiled program. Its output goes
+// to `output`, errors and --stats lines to `log` (after the output has been flushed).
+static int runProgram(CompiledProgram const& compiled, RunOptions const& options, OutputSink& output, std::ostream& log)
+{
+	if (options.aot != nullptr) {
+		return compileNative(*compiled.program(), options.aot);
+	}
+
+	if (options.print) {
+		PrintVisitor printer{ std::cout };
+		if (options.engine == Engine::FLAT) printer.print(compiled.flat());
+		else if (options.engine == Engine::IR) compiled.ir().print(std::cout);
+		else printer.visit(*compiled.program());
+		return EXIT_SUCCESS;
+	}
+
+	return compiled.run(output, log);
+}
+
+// Batch mode: the manifest lists one script per line. The scripts run on a
+// work-stealing pool, each with its own SymbolTable, evaluator and output
+// buffer. A script listed more than once is parsed and compiled only once, by
+// the first job that needs it: the others wait for it and then run the same
+// immutable CompiledProgram concurrently. A job's output, then its errors, are
+// written as soon as every job before it in the manifest is done, so the result
+// is the same as running the scripts one after the other. Fails if any script fails.
+static int runBatch(const char* manifest, RunOptions const& options, OutputSink::Encoding encoding,
+	unsigned int threads, std::ostream& out)
+{
+	std::ifstream list{ manifest };
+	if (!list) {
+		std::cerr << "Cannot open " << manifest << std::endl;
+		return EXIT_FAILURE;
+	}
+	std::vector<std::string> paths;
+	std::vector<std::size_t> scriptOf;
+	std::unordered_map<std::string, std::size_t> known;
+	for (std::string line; std::getline(list, line);) {
+		if (!line.empty() && line.back() == '\r') line.pop_back();
+		if (line.empty()) continue;
+		auto [it, added] = known.emplace(line, paths.size());
+		if (added) paths.push_back(std::move(line));
+		scriptOf.push_back(it->second);
+	}
+
+	struct Script {
+		std::once_flag compiled;
+		std::shared_ptr<const CompiledProgram> program;
+		// What parsing and compiling wrote: every job listing the script repeats it
+		std::string output;
+		std::string log;
+	};
+	std::vector<Script> scripts(paths.size());
+
+	struct Job {
+		std::ostringstream output;
+		std::ostringstream log;
+		int status = EXIT_SUCCESS;
+		bool done = false;
+	};
+	std::vector<Job> jobs(scriptOf.size());
+	std::mutex mutex;
+	std::condition_variable finished;
+	auto start = std::chrono::steady_clock::now();
+	WorkStealingPool pool{ jobs.size(), threads, [&](std::size_t k) {
+		Job& job = jobs[k];
+		Script& script = scripts[scriptOf[k]];
+		std::call_once(script.compiled, [&] {
+			std::ostringstream output, log;
+			script.program = loadFile(paths[scriptOf[k]].c_str(), 1, options, output, log);
+			script.output = output.str();
+			script.log = log.str();
+		});
+		job.output << script.output;
+		job.log << script.log;
+		if (script.program == nullptr) {
+			job.status = EXIT_FAILURE;
+		}
+		else {
+			// The whole output stays in memory until it is this job's turn
+			OutputSink output{ job.output, OutputSink::Policy{ OutputSink::Flush::EXIT, 1 }, encoding };
+			job.status = script.program->run(output, job.log);
+		}
+		std::lock_guard<std::mutex> lock{ mutex };
+		job.done = true;
+		finished.notify_one();
+	} };
+
+	int status = EXIT_SUCCESS;
+	for (Job& job : jobs) {
+		{
+			std::unique_lock<std::mutex> lock{ mutex };
+			finished.wait(lock, [&] { return job.done; });
+		}
+		std::string text = job.output.str();
+		out.write(text.data(), static_cast<std::streamsize>(text.size()));
+		out.flush();
+		std::cerr << job.log.str();
+		if (job.status != EXIT_SUCCESS) status = EXIT_FAILURE;
+		job.output = std::ostringstream{};
+	}
+	if (options.stats) {
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		std::cerr << "Batch: " << jobs.size() << " scripts (" << scripts.size() << " distinct) on " << threads << " threads, "
+			<< elapsed.count() << " ms" << std::endl;
+	}
+	return status;
+}
+
+// Peak resident memory of the process in KB (0 where it cannot be read)
+static long peakMemory()
+{
+#if defined(__unix__) || defined(__APPLE__)
+	rusage usage{};
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+#if defined(__APPLE__)
+	return static_cast<long>(usage.ru_maxrss / 1024);
+#else
+	return static_cast<long>(usage.ru_maxrss);
+#endif
+#else
+	return 0;
+#endif
+}
+
+static void usage(const char* program)
+{
+	std::cerr << "Usage: " << std::endl;
+	std::cerr << program << " [--stream] [--jobs N] [--stats] [--flat] [--vm] [--reg] [--ir] [--jit] [-O] [--print] [--flush exit|full|line|N] [--async] [--binary 32|64] [--frame N] [--output FILE] [--decode 32|64] [--aot FILE] [--batch] <filename|manifest|-> " << std::endl;
+}
+
+// Numeric option value: a whole decimal number greater than zero
+template <typename Unsigned>
+static bool parseCount(std::string_view text, Unsigned& value)
+{
+	auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+	return error == std::errc{} && end == text.data() + text.size() && value != 0;
+}
+
+int main(int argc, char* argv[])
+{
+	// Options: --stream runs each top-level statement as soon as it is parsed (tree walker, constant memory),
+	// "-" reads the script from stdin,
+	// --jobs N lexes large files on N threads (N > 0),
+	// --stats prints lexing time, memory statistics, execution time and peak memory to stderr,
+	// --flat runs on the flat (index-based) AST, --vm compiles to bytecode for the stack VM,
+	// --reg compiles for the register VM, --jit compiles hot while loops to native code (tree walker),
+	// --ir lowers to the SSA IR (optimized with -O) and runs it on the reference IR interpreter,
+	// -O propagates and folds constants, hoists loop invariants, rewrites counting loops and drops the bounds checks
+	// it can prove redundant before running,
+	// --print prints the AST instead of running it,
+	// --flush exit|full|line|N writes the program output at exit, when the buffer is full,
+	// on every line or every N lines (default: line on a terminal, full otherwise),
+	// --async hands the full output buffers to a writer thread,
+	// --binary 32|64 prints raw little-endian integers, in blocks of N values after a count with --frame N,
+	// --output FILE writes the program output to FILE instead of stdout,
+	// --decode 32|64 converts a binary output file (same --frame) back to text,
+	// --batch runs every script listed in the given manifest, --jobs at a time (default: all cores;
+	// a script listed more than once is compiled once and shared by its runs),
+	// --aot FILE compiles the script to a native executable through C instead of running it
+	const char* fileName = nullptr;
+	RunOptions options;
+	bool streaming = false;
+	bool batch = false;
+	unsigned int jobs = 0;
+	OutputSink::Policy flush = OutputSink::standard();
+	bool async = false;
+	OutputSink::Encoding encoding;
+	OutputSink::Format decode = OutputSink::Format::TEXT;
+	const char* outputName = nullptr;
+	for (int i = 1; i < argc; ++i) {
+		std::string arg{ argv[i] };
+		if (arg == "--stream") streaming = true;
+		else if (arg == "--stats") options.stats = true;
+		else if (arg == "--flat") options.engine = Engine::FLAT;
+		else if (arg == "--print") options.print = true;
+		else if (arg == "--vm") options.engine = Engine::STACK_VM;
+		else if (arg == "--reg") options.engine = Engine::REGISTER_VM;
+		else if (arg == "--ir") options.engine = Engine::IR;
+		else if (arg == "--jit") options.jit = true;
+		else if (arg == "-O") options.optimize = true;
+		else if (arg == "--aot" && i + 1 < argc) options.aot = argv[++i];
+		else if (arg == "--batch") batch = true;
+		else if (arg == "--async") async = true;
+		else if (arg == "--output" && i + 1 < argc) outputName = argv[++i];
+		else if (arg == "--frame" && i + 1 < argc) {
+			// The count in front of each block is a uint32
+			if (!parseCount(argv[++i], encoding.frame) || encoding.frame > std::numeric_limits<std::uint32_t>::max()) {
+				std::cerr << "Invalid frame size: " << argv[i] << std::endl;
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else if ((arg == "--binary" || arg == "--decode") && i + 1 < argc) {
+			if (!OutputSink::parse(argv[++i], arg == "--binary" ? encoding.format : decode)) {
+				std::cerr << "Unknown integer width: " << argv[i] << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (arg == "--flush" && i + 1 < argc) {
+			if (!OutputSink::parse(argv[++i], flush)) {
+				std::cerr << "Unknown flush policy: " << argv[i] << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		else if (arg == "--jobs" && i + 1 < argc) {
+			if (!parseCount(argv[++i], jobs)) {
+				std::cerr << "Invalid number of jobs: " << argv[i] << std::endl;
+				usage(argv[0]);
+				return EXIT_FAILURE;
+			}
+		}
+		else fileName = argv[i];
+	}
+
+	// Check if there is at least one input argument
+	// The first input argument (argv[0]) is always the name of the program
+	if (fileName == nullptr) {
+		std::cerr << "No input file!" << std::endl;
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (decode != OutputSink::Format::TEXT) {
+		std::ifstream binaryFile;
+		if (std::string{ fileName } != "-") {
+			binaryFile.open(fileName, std::ios::binary);
+			if (!binaryFile) {
+				std::cerr << "Cannot open " << fileName << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		encoding.format = decode;
+		if (!OutputSink::decode(binaryFile.is_open() ? binaryFile : std::cin, std::cout, encoding)) {
+			std::cout.flush();
+			std::cerr << "Truncated binary output" << std::endl;
+			return EXIT_FAILURE;
+		}
+		return EXIT_SUCCESS;
+	}
+
+	// Program output is buffered: it is flushed (and the writer thread drained)
+	// before anything reaches stderr. The sink already writes in large blocks,
+	// so an output file needs no buffer of its own
+	std::ofstream outputFile;
+	if (outputName != nullptr) {
+		outputFile.rdbuf()->pubsetbuf(nullptr, 0);
+		outputFile.open(outputName, std::ios::binary);
+		if (!outputFile) {
+			std::cerr << "Cannot open " << outputName << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+	else if (encoding.format != OutputSink::Format::TEXT) {
+		OutputSink::binaryStdout();
+	}
+	std::ostream& out = outputName != nullptr ? outputFile : std::cout;
+
+	if (batch) {
+		if (options.print || options.aot != nullptr) {
+			std::cerr << "--print and --aot cannot be used with --batch" << std::endl;
+			return EXIT_FAILURE;
+		}
+		if (jobs == 0) jobs = std::max(1u, std::thread::hardware_concurrency());
+		return runBatch(fileName, options, encoding, jobs, out);
+	}
+
+	if (streaming) {
+		if (options.optimize || options.print || options.aot != nullptr || options.engine != Engine::TREE) {
+			std::cerr << "--stream runs on the tree walker and cannot be used with -O, --print, --aot or another engine" << std::endl;
+			return EXIT_FAILURE;
+		}
+		std::ifstream inputFile;
+		if (std::string{ fileName } != "-") {
+			inputFile.open(fileName);
+			if (!inputFile) {
+				std::cerr << "Cannot open " << fileName << std::endl;
+				return EXIT_FAILURE;
+			}
+		}
+		OutputSink output{ out, flush, encoding, async };
+		int status = runStream(inputFile.is_open() ? inputFile : std::cin, options.jit, output);
+		if (options.stats) std::cerr << "Peak memory: " << peakMemory() << " KB" << std::endl;
+		return status;
+	}
+
+	// The whole AST lives in the program's arena and is released with it
+	std::shared_ptr<const CompiledProgram> compiled;
+	if (std::string{ fileName } == "-") {
+		std::unique_ptr<Program> program{ parseStream(std::cin) };
+		if (program != nullptr) compiled = compileProgram(std::move(program), options, std::cerr);
+	}
+	else {
+		compiled = loadFile(fileName, jobs == 0 ? 1 : jobs, options, std::cout, std::cerr);
+	}
+	if (compiled == nullptr) {
+		return EXIT_FAILURE;
+	}
+	OutputSink output{ out, flush, encoding, async };
+	int status = runProgram(*compiled, options, output, std::cerr);
+	if (options.stats) std::cerr << "Peak memory: " << peakMemory() << " KB" << std::endl;
+	return status;
+}
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cctype>
+
+#include "Ir.h"
+
+const char* IrFunction::name(IrOp op) {
+	switch (op) {
+#define IR_OP_NAME(name) case IrOp::name: return #name;
+		IR_OPS(IR_OP_NAME)
+#undef IR_OP_NAME
+	}
+	return "?";
+}
+
+bool IrFunction::pure(IrOp op) {
+	switch (op) {
+	case IrOp::CONST:
+	case IrOp::ADD: case IrOp::SUB: case IrOp::MUL:
+	case IrOp::LT: case IrOp::LTE: case IrOp::GT: case IrOp::GTE: case IrOp::EQ: case IrOp::NEQ:
+	case IrOp::NEG: case IrOp::NOT: case IrOp::BOOL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+std::size_t IrFunction::size() const {
+	std::size_t n = 0;
+	for (IrBlock const& b : blocks) n += b.instructions.size();
+	return n;
+}
+
+// Algoritmo iterativo di Cooper, Harvey e Kennedy sull'ordine post-visita
+std::vector<int> IrFunction::dominators() const {
+	std::vector<int> order;
+	std::vector<int> number(blocks.size(), -1);
+	std::vector<char> visited(blocks.size(), 0);
+	std::vector<std::pair<int, std::size_t>> stack{ { 0, 0 } };
+	visited[0] = 1;
+	while (!stack.empty()) {
+		auto& [b, next] = stack.back();
+		if (next < blocks[b].successors.size()) {
+			int s = blocks[b].successors[next++];
+			if (!visited[s]) {
+				visited[s] = 1;
+				stack.push_back({ s, 0 });
+			}
+		}
+		else {
+			number[b] = static_cast<int>(order.size());
+			order.push_back(b);
+			stack.pop_back();
+		}
+	}
+
+	std::vector<int> idom(blocks.size(), -1);
+	idom[0] = 0;
+	bool changed = true;
+	while (changed) {
+		changed = false;
+		for (auto itr = order.rbegin(); itr != order.rend(); ++itr) {
+			int b = *itr;
+			if (b == 0) continue;
+			int candidate = -1;
+			for (int p : blocks[b].predecessors) {
+				if (idom[p] < 0) continue;
+				if (candidate < 0) { candidate = p; continue; }
+				int x = p, y = candidate;
+				while (x != y) {
+					while (number[x] < number[y]) x = idom[x];
+					while (number[y] < number[x]) y = idom[y];
+				}
+				candidate = x;
+			}
+			if (candidate != idom[b]) {
+				idom[b] = candidate;
+				changed = true;
+			}
+		}
+	}
+	idom[0] = -1;
+	return idom;
+}
+
+void IrFunction::print(std::ostream& out) const {
+	auto lower = [](IrOp op) {
+		std::string text = name(op);
+		std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return text;
+	};
+	for (std::size_t b = 0; b < blocks.size(); ++b) {
+		out << "b" << b << ":";
+		if (!blocks[b].predecessors.empty()) {
+			out << "  ; preds";
+			for (int p : blocks[b].predecessors) out << " b" << p;
+		}
+		out << std::endl;
+		for (int v : blocks[b].instructions) {
+			IrInstruction const& in = values[v];
+			out << "    ";
+			if (in.op != IrOp::APPEND && in.op != IrOp::LIST_NEW && in.op != IrOp::PRINT
+				&& in.op != IrOp::JUMP && in.op != IrOp::BRANCH && in.op != IrOp::RETURN) {
+				out << "v" << v << " = ";
+			}
+			out << lower(in.op);
+			switch (in.op) {
+			case IrOp::CONST:
+				out << " " << in.imm;
+				break;
+			case IrOp::UNDEF:
+			case IrOp::LIST_NEW:
+				out << " " << names[in.imm];
+				break;
+			case IrOp::PHI:
+				for (std::size_t k = 0; k < in.operands.size(); ++k) {
+					out << (k ? ", [v" : " [v") << in.operands[k] << ", b" << blocks[b].predecessors[k] << "]";
+				}
+				break;
+			case IrOp::CHECK:
+				out << " v" << in.operands[0] << "  ; " << names[in.imm];
+				break;
+			case IrOp::APPEND:
+			case IrOp::LIST_GET:
+				out << " " << names[in.imm] << ", v" << in.operands[0];
+				break;
+			case IrOp::JUMP:
+				out << " b" << blocks[b].successors[0];
+				break;
+			case IrOp::BRANCH:
+				out << " v" << in.operands[0] << ", b" << blocks[b].successors[0] << ", b" << blocks[b].successors[1];
+				break;
+			default:
+				for (std::size_t k = 0; k < in.operands.size(); ++k) out << (k ? ", v" : " v") << in.operands[k];
+				break;
+			}
+			out << std::endl;
+		}
+	}
+}
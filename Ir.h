@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// IR in forma SSA: un grafo di flusso di blocchi base, prodotto da IrBuilder.
+// Ogni istruzione definisce (al più) un valore, identificato dal suo indice in
+// IrFunction::values; gli operandi sono indici di valori. Le variabili non
+// esistono più: ogni lettura usa direttamente il valore assegnato, e dove si
+// incontrano più cammini compare un PHI (un operando per predecessore,
+// nell'ordine di IrBlock::predecessors). Il valore di una variabile mai
+// assegnata è UNDEF: le letture che possono vederlo passano da CHECK, che
+// produce l'errore di identificatore non dichiarato. Le liste restano slot
+// della SymbolTable (imm) con le loro istruzioni.
+#define IR_OPS(X) \
+	X(CONST)      /* imm */ \
+	X(UNDEF)      /* valore iniziale della variabile dello slot imm */ \
+	X(PHI)        /* un operando per predecessore */ \
+	X(CHECK)      /* operando, errore per lo slot imm se è UNDEF */ \
+	X(ADD) X(SUB) X(MUL) X(DIV) \
+	X(LT) X(LTE) X(GT) X(GTE) X(EQ) X(NEQ) \
+	X(NEG) X(NOT) X(BOOL) \
+	X(LIST_NEW)   /* lista vuota nello slot imm */ \
+	X(APPEND)     /* lista imm .append(operando) */ \
+	X(LIST_GET)   /* lista imm [operando] */ \
+	X(PRINT) \
+	X(JUMP)       /* al successore */ \
+	X(BRANCH)     /* operando != 0 ? primo successore : secondo */ \
+	X(RETURN)
+
+enum class IrOp : std::uint8_t {
+#define IR_OP_ENUM(name) name,
+	IR_OPS(IR_OP_ENUM)
+#undef IR_OP_ENUM
+};
+
+struct IrInstruction {
+	IrOp op;
+	int block;                  // blocco che contiene l'istruzione
+	int imm = 0;
+	std::vector<int> operands;
+};
+
+struct IrBlock {
+	std::vector<int> instructions;  // PHI in testa, terminatore in fondo
+	std::vector<int> predecessors;
+	std::vector<int> successors;
+};
+
+// Ciclo prodotto da un while: il preheader esegue un solo salto all'header
+struct IrLoop {
+	int preheader;
+	int header;
+	std::vector<int> blocks;
+};
+
+struct IrFunction {
+	std::vector<IrInstruction> values;
+	std::vector<IrBlock> blocks;
+	std::vector<IrLoop> loops;          // i cicli interni prima di quelli esterni
+	std::vector<std::string> names;     // nomi degli slot
+
+	static const char* name(IrOp op);
+
+	// Istruzioni senza effetti e che non possono fallire
+	static bool pure(IrOp op);
+
+	// Numero di istruzioni presenti nei blocchi
+	std::size_t size() const;
+
+	// Dominatore immediato di ogni blocco (-1 per l'entry e i blocchi irraggiungibili)
+	std::vector<int> dominators() const;
+
+	void print(std::ostream& out) const;
+};
@@ -0,0 +1,362 @@
+#pragma once
+
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Visitor.h"
+#include "Syntax.h"
+#include "Token.h"
+#include "Ir.h"
+
+// Traduce un Program (già risolto dal Resolver) nell'IR SSA.
+// La forma SSA viene costruita durante la visita con l'algoritmo di Braun et
+// al. ("Simple and Efficient Construction of SSA Form"): ogni blocco ricorda
+// l'ultimo valore di ogni slot, e una lettura risale i predecessori creando i
+// PHI dove i cammini si incontrano. L'header di un while resta "aperto"
+// finché non si conoscono tutti i salti all'indietro (continue e fine corpo).
+// break/continue diventano archi; dopo un salto il codice è irraggiungibile e
+// non viene tradotto.
+class IrBuilder : public Visitor {
+
+public:
+	IrBuilder() = default;
+	~IrBuilder() = default;
+
+	static IrFunction build(Program const& program) {
+		IrBuilder builder;
+		builder.f_.names.assign(program.symbols.begin(), program.symbols.end());
+		builder.undef_.assign(program.symbols.size(), -1);
+		builder.visit(program);
+		return std::move(builder.f_);
+	}
+
+	// break/continue fuori da un while saltano alla fine dello statement top-level
+	void visit(Program const& p) override {
+		current_ = newBlock();
+		seal(current_);
+		for (Statement* statement : p.statements) {
+			loops_.push_back(Loop{ -1, -1, {} });
+			statement->accept(*this);
+			std::vector<int> pending = std::move(loops_.back().pending);
+			loops_.pop_back();
+			if (!pending.empty()) {
+				int end = newBlock();
+				if (current_ >= 0) jump(current_, end);
+				for (int from : pending) edge(from, end);
+				seal(end);
+				current_ = end;
+			}
+		}
+		if (current_ >= 0) emit(IrOp::RETURN);
+	}
+
+	void visit(Definition const& d) override {
+		if (current_ < 0) return;
+		int value = expression(*d.expression_);
+		write(d.variable_->slot_, current_, value);
+	}
+
+	void visit(Expression const& o) override {
+		throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+
+	void visit(ifStatement const& i) override {
+		if (current_ < 0) return;
+		int condition = expression(*i.condition);
+		int thenBlock = newBlock();
+		int elseBlock = newBlock();
+		branch(condition, thenBlock, elseBlock);
+		seal(thenBlock);
+		seal(elseBlock);
+		current_ = thenBlock;
+		for (auto* st : i.block) st->accept(*this);
+		int thenEnd = current_;
+		current_ = elseBlock;
+		if (i.elifBlock != nullptr) i.elifBlock->accept(*this);
+		else for (auto* st : i.elseBlock) st->accept(*this);
+		int elseEnd = current_;
+		merge(thenEnd, elseEnd);
+	}
+
+	// preheader -> header (condizione) -> body ... -> header; header -> exit
+	void visit(whileStatement const& w) override {
+		if (current_ < 0) return;
+		int preheader = current_;
+		int header = newBlock();
+		jump(preheader, header);
+		current_ = header;
+		int condition = expression(*w.condition);
+		int body = newBlock();
+		int exit = newBlock();
+		branch(condition, body, exit);
+		seal(body);
+		loops_.push_back(Loop{ header, exit, {} });
+		current_ = body;
+		for (auto* st : w.block) st->accept(*this);
+		if (current_ >= 0) jump(current_, header);
+		loops_.pop_back();
+		seal(header);
+		seal(exit);
+
+		IrLoop loop{ preheader, header, {} };
+		for (int b = header; b < static_cast<int>(f_.blocks.size()); ++b) {
+			if (b != exit) loop.blocks.push_back(b);
+		}
+		f_.loops.push_back(std::move(loop));
+		current_ = exit;
+	}
+
+	void visit(Break const& b) override {
+		if (current_ < 0) return;
+		exitTo(loops_.back().exit);
+	}
+
+	void visit(Continue const& c) override {
+		if (current_ < 0) return;
+		exitTo(loops_.back().header);
+	}
+
+	void visit(Print const& p) override {
+		if (current_ < 0) return;
+		emit(IrOp::PRINT, 0, { expression(*p.expr_) });
+	}
+
+	void visit(listInit const& l) override {
+		if (current_ < 0) return;
+		emit(IrOp::LIST_NEW, l.slot_);
+	}
+
+	void visit(listAppend const& l) override {
+		if (current_ < 0) return;
+		emit(IrOp::APPEND, l.slot_, { expression(*l.expr_) });
+	}
+
+	void visit(orExpr const& e) override {
+		logical(*e.left_, *e.right_, true);
+	}
+
+	void visit(andExpr const& e) override {
+		logical(*e.left_, *e.right_, false);
+	}
+
+	void visit(relExpression const& e) override {
+		switch (e.opCode_) {
+		case Token::LT:  binary(IrOp::LT, *e.left_, *e.right_); break;
+		case Token::LTE: binary(IrOp::LTE, *e.left_, *e.right_); break;
+		case Token::GT:  binary(IrOp::GT, *e.left_, *e.right_); break;
+		case Token::GTE: binary(IrOp::GTE, *e.left_, *e.right_); break;
+		case Token::EQEQ: binary(IrOp::EQ, *e.left_, *e.right_); break;
+		case Token::NEQ:  binary(IrOp::NEQ, *e.left_, *e.right_); break;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+	}
+
+	void visit(mathExpression const& e) override {
+		switch (e.opCode_) {
+		case Token::ADD: binary(IrOp::ADD, *e.left_, *e.right_); break;
+		case Token::SUB: binary(IrOp::SUB, *e.left_, *e.right_); break;
+		case Token::MUL: binary(IrOp::MUL, *e.left_, *e.right_); break;
+		case Token::INTDIV: binary(IrOp::DIV, *e.left_, *e.right_); break;
+		default: throw std::runtime_error("ERROR: Unknown math operator.");
+		}
+	}
+
+	void visit(unaryExpression const& e) override {
+		IrOp op;
+		if (e.opCode_ == Token::SUB) op = IrOp::NEG;
+		else if (e.opCode_ == Token::NOT) op = IrOp::NOT;
+		else throw std::runtime_error("ERROR: Unknown unary operator.");
+		int operand = expression(*e.operand_);
+		result_ = emit(op, 0, { operand });
+	}
+
+	// Una lettura che può vedere UNDEF (direttamente o tramite un PHI) passa
+	// da CHECK; il valore controllato diventa quello corrente della variabile
+	void visit(Variable const& v) override {
+		int value = read(v.slot_, current_);
+		IrOp op = f_.values[value].op;
+		if (op == IrOp::UNDEF || op == IrOp::PHI) {
+			value = emit(IrOp::CHECK, v.slot_, { value });
+			write(v.slot_, current_, value);
+		}
+		result_ = value;
+	}
+
+	void visit(Constant const& c) override {
+		result_ = emit(IrOp::CONST, c.num_);
+	}
+
+	void visit(listAccess const& e) override {
+		int index = expression(*e.index_);
+		result_ = emit(IrOp::LIST_GET, e.slot_, { index });
+	}
+
+private:
+	struct Loop {
+		int header;       // -1 al top-level
+		int exit;
+		std::vector<int> pending;   // salti alla fine dello statement top-level
+	};
+
+	IrFunction f_;
+	int current_ = -1;                      // -1: codice irraggiungibile
+	std::vector<std::vector<int>> defs_;    // per blocco: valore corrente di ogni slot
+	std::vector<char> sealed_;
+	std::vector<std::vector<std::pair<int, int>>> incomplete_;  // PHI (slot, valore) dei blocchi aperti
+	std::vector<int> undef_;
+	std::vector<Loop> loops_;
+	int result_ = -1;
+
+	int newBlock() {
+		f_.blocks.emplace_back();
+		defs_.emplace_back(f_.names.size(), -1);
+		sealed_.push_back(0);
+		incomplete_.emplace_back();
+		return static_cast<int>(f_.blocks.size()) - 1;
+	}
+
+	int add(int block, IrOp op, int imm, std::vector<int> operands) {
+		f_.values.push_back(IrInstruction{ op, block, imm, std::move(operands) });
+		return static_cast<int>(f_.values.size()) - 1;
+	}
+
+	int emit(IrOp op, int imm = 0, std::vector<int> operands = {}) {
+		int v = add(current_, op, imm, std::move(operands));
+		f_.blocks[current_].instructions.push_back(v);
+		return v;
+	}
+
+	void edge(int from, int to) {
+		f_.blocks[from].successors.push_back(to);
+		f_.blocks[to].predecessors.push_back(from);
+	}
+
+	void jump(int from, int to) {
+		int saved = current_;
+		current_ = from;
+		emit(IrOp::JUMP);
+		current_ = saved;
+		edge(from, to);
+	}
+
+	void branch(int condition, int ifTrue, int ifFalse) {
+		emit(IrOp::BRANCH, 0, { condition });
+		edge(current_, ifTrue);
+		edge(current_, ifFalse);
+	}
+
+	void exitTo(int target) {
+		if (target >= 0) {
+			jump(current_, target);
+		}
+		else {
+			emit(IrOp::JUMP);
+			loops_.back().pending.push_back(current_);
+		}
+		current_ = -1;
+	}
+
+	// Blocco di confluenza dei rami di un if (o di and/or)
+	void merge(int left, int right) {
+		if (left < 0 && right < 0) {
+			current_ = -1;
+			return;
+		}
+		int join = newBlock();
+		if (left >= 0) jump(left, join);
+		if (right >= 0) jump(right, join);
+		seal(join);
+		current_ = join;
+	}
+
+	int expression(Expression const& e) {
+		e.accept(*this);
+		return result_;
+	}
+
+	void binary(IrOp op, Expression const& left, Expression const& right) {
+		int l = expression(left);
+		int r = expression(right);
+		result_ = emit(op, 0, { l, r });
+	}
+
+	// or/and: il destro viene valutato in un blocco a parte, il risultato è
+	// un PHI tra la costante del cortocircuito e BOOL(destro)
+	void logical(Expression const& left, Expression const& right, bool isOr) {
+		int l = expression(left);
+		int shortCircuit = emit(IrOp::CONST, isOr ? 1 : 0);
+		int rightBlock = newBlock();
+		int join = newBlock();
+		if (isOr) branch(l, join, rightBlock);
+		else branch(l, rightBlock, join);
+		seal(rightBlock);
+		current_ = rightBlock;
+		int r = emit(IrOp::BOOL, 0, { expression(right) });
+		jump(current_, join);
+		seal(join);
+		current_ = join;
+		result_ = phi(join);
+		f_.values[result_].operands = { shortCircuit, r };
+	}
+
+	int phi(int block) {
+		int v = add(block, IrOp::PHI, 0, {});
+		auto& list = f_.blocks[block].instructions;
+		auto itr = list.begin();
+		while (itr != list.end() && f_.values[*itr].op == IrOp::PHI) ++itr;
+		list.insert(itr, v);
+		return v;
+	}
+
+	void write(int slot, int block, int value) {
+		defs_[block][slot] = value;
+	}
+
+	int read(int slot, int block) {
+		int value = defs_[block][slot];
+		if (value >= 0) return value;
+		auto const& predecessors = f_.blocks[block].predecessors;
+		if (!sealed_[block]) {
+			value = phi(block);
+			incomplete_[block].push_back({ slot, value });
+		}
+		else if (predecessors.empty()) {
+			value = undef(slot);
+		}
+		else if (predecessors.size() == 1) {
+			value = read(slot, predecessors[0]);
+		}
+		else {
+			value = phi(block);
+			write(slot, block, value);
+			operands(slot, value);
+		}
+		write(slot, block, value);
+		return value;
+	}
+
+	void operands(int slot, int phi) {
+		int block = f_.values[phi].block;
+		std::vector<int> values;
+		for (int p : f_.blocks[block].predecessors) values.push_back(read(slot, p));
+		f_.values[phi].operands = std::move(values);
+	}
+
+	void seal(int block) {
+		sealed_[block] = 1;
+		for (auto [slot, phi] : incomplete_[block]) operands(slot, phi);
+		incomplete_[block].clear();
+	}
+
+	// UNDEF vive nel blocco di ingresso, uno per slot
+	int undef(int slot) {
+		if (undef_[slot] < 0) {
+			undef_[slot] = add(0, IrOp::UNDEF, slot, {});
+			auto& list = f_.blocks[0].instructions;
+			list.insert(list.begin(), undef_[slot]);
+		}
+		return undef_[slot];
+	}
+};
@@ -0,0 +1,83 @@
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "IrInterpreter.h"
+
+void IrInterpreter::run(IrFunction const& f) {
+	// I registri sono a 64 bit per rappresentare UNDEF fuori dagli int
+	constexpr std::int64_t UNDEF = INT64_MIN;
+	std::vector<std::int64_t> values(f.values.size(), UNDEF);
+	std::vector<std::int64_t> incoming;
+	int previous = -1;
+	int block = 0;
+
+	for (;;) {
+		IrBlock const& b = f.blocks[block];
+		// I PHI leggono tutti i valori del predecessore prima di scrivere
+		std::size_t k = 0;
+		if (previous >= 0) {
+			std::size_t edge = 0;
+			while (b.predecessors[edge] != previous) ++edge;
+			incoming.clear();
+			for (; k < b.instructions.size() && f.values[b.instructions[k]].op == IrOp::PHI; ++k) {
+				incoming.push_back(values[f.values[b.instructions[k]].operands[edge]]);
+			}
+			for (std::size_t p = 0; p < k; ++p) values[b.instructions[p]] = incoming[p];
+		}
+
+		int next = -1;
+		for (; k < b.instructions.size() && next < 0; ++k) {
+			int v = b.instructions[k];
+			IrInstruction const& in = f.values[v];
+			auto operand = [&](std::size_t i) { return static_cast<int>(values[in.operands[i]]); };
+			switch (in.op) {
+			case IrOp::CONST: values[v] = in.imm; break;
+			case IrOp::UNDEF: values[v] = UNDEF; break;
+			case IrOp::PHI: break;
+			case IrOp::CHECK:
+				if (values[in.operands[0]] == UNDEF) symbolTable_.undeclared(in.imm);
+				values[v] = values[in.operands[0]];
+				break;
+			case IrOp::ADD: values[v] = static_cast<int>(static_cast<unsigned>(operand(0)) + static_cast<unsigned>(operand(1))); break;
+			case IrOp::SUB: values[v] = static_cast<int>(static_cast<unsigned>(operand(0)) - static_cast<unsigned>(operand(1))); break;
+			case IrOp::MUL: values[v] = static_cast<int>(static_cast<unsigned>(operand(0)) * static_cast<unsigned>(operand(1))); break;
+			case IrOp::DIV:
+				if (operand(1) == 0) throw std::runtime_error("ERROR: Division by zero.");
+				values[v] = operand(0) / operand(1);
+				break;
+			case IrOp::LT:  values[v] = operand(0) < operand(1); break;
+			case IrOp::LTE: values[v] = operand(0) <= operand(1); break;
+			case IrOp::GT:  values[v] = operand(0) > operand(1); break;
+			case IrOp::GTE: values[v] = operand(0) >= operand(1); break;
+			case IrOp::EQ:  values[v] = operand(0) == operand(1); break;
+			case IrOp::NEQ: values[v] = operand(0) != operand(1); break;
+			case IrOp::NEG: values[v] = static_cast<int>(0u - static_cast<unsigned>(operand(0))); break;
+			case IrOp::NOT: values[v] = operand(0) == 0; break;
+			case IrOp::BOOL: values[v] = operand(0) != 0; break;
+			case IrOp::LIST_NEW:
+				symbolTable_.setList(in.imm);
+				break;
+			case IrOp::APPEND:
+				symbolTable_.appendToList(in.imm, operand(0));
+				break;
+			case IrOp::LIST_GET:
+				values[v] = symbolTable_.getListValue(in.imm, operand(0));
+				break;
+			case IrOp::PRINT:
+				console_.print(operand(0));
+				break;
+			case IrOp::JUMP:
+				next = b.successors[0];
+				break;
+			case IrOp::BRANCH:
+				next = b.successors[operand(0) != 0 ? 0 : 1];
+				break;
+			case IrOp::RETURN:
+				return;
+			}
+		}
+		previous = block;
+		block = next;
+	}
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Ir.h"
+#include "OutputSink.h"
+#include "SymbolTable.h"
+
+// Interprete di riferimento per l'IR SSA: esegue i blocchi uno dopo l'altro
+// tenendo un registro per ogni valore, così l'uscita di ogni passata può
+// essere confrontata con quella di EvaluationVisitor. Le liste e i messaggi
+// di errore sono quelli della SymbolTable.
+class IrInterpreter {
+
+public:
+	IrInterpreter(SymbolTable& st, OutputSink& con)
+		: symbolTable_{ st }, console_{ con } {
+	}
+
+	void run(IrFunction const& function);
+
+private:
+	SymbolTable& symbolTable_;
+	OutputSink& console_;
+};
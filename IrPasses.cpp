@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <map>
+
+#include "IrPasses.h"
+
+void IrPassManager::run(IrFunction& function) {
+	for (Entry& entry : passes_) {
+		auto start = std::chrono::steady_clock::now();
+		std::size_t changed = entry.pass(function);
+		std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+		timings_.push_back(Timing{ entry.name, elapsed.count(), changed });
+	}
+}
+
+IrPassManager IrPassManager::standard() {
+	IrPassManager manager;
+	manager.add("dce", IrPasses::deadCodeElimination);
+	manager.add("gvn", IrPasses::globalValueNumbering);
+	manager.add("licm", IrPasses::loopInvariantCodeMotion);
+	manager.add("dce", IrPasses::deadCodeElimination);
+	return manager;
+}
+
+namespace {
+
+	// Sostituzioni di valori (union-find senza rango)
+	struct Replacements {
+		std::vector<int> to;
+
+		explicit Replacements(std::size_t n) : to(n, -1) { }
+
+		int find(int v) {
+			while (to[v] >= 0) v = to[v];
+			return v;
+		}
+
+		void resolve(IrInstruction& in) {
+			for (int& operand : in.operands) operand = find(operand);
+		}
+	};
+
+	// Toglie dai blocchi le istruzioni segnate
+	std::size_t sweep(IrFunction& f, std::vector<char> const& removed) {
+		std::size_t n = 0;
+		for (IrBlock& b : f.blocks) {
+			auto end = std::remove_if(b.instructions.begin(), b.instructions.end(), [&](int v) { return removed[v] != 0; });
+			n += static_cast<std::size_t>(b.instructions.end() - end);
+			b.instructions.erase(end, b.instructions.end());
+		}
+		return n;
+	}
+
+	bool commutative(IrOp op) {
+		return op == IrOp::ADD || op == IrOp::MUL || op == IrOp::EQ || op == IrOp::NEQ;
+	}
+
+	// Valuta un'istruzione con operandi costanti; false se non si può
+	// (divisione per zero o INT_MIN // -1 restano a runtime)
+	bool evaluate(IrOp op, std::vector<int> const& args, int& result) {
+		unsigned a = args.size() > 0 ? static_cast<unsigned>(args[0]) : 0;
+		unsigned b = args.size() > 1 ? static_cast<unsigned>(args[1]) : 0;
+		switch (op) {
+		case IrOp::ADD: result = static_cast<int>(a + b); return true;
+		case IrOp::SUB: result = static_cast<int>(a - b); return true;
+		case IrOp::MUL: result = static_cast<int>(a * b); return true;
+		case IrOp::DIV:
+			if (args[1] == 0 || (args[0] == INT_MIN && args[1] == -1)) return false;
+			result = args[0] / args[1];
+			return true;
+		case IrOp::LT:  result = args[0] < args[1]; return true;
+		case IrOp::LTE: result = args[0] <= args[1]; return true;
+		case IrOp::GT:  result = args[0] > args[1]; return true;
+		case IrOp::GTE: result = args[0] >= args[1]; return true;
+		case IrOp::EQ:  result = args[0] == args[1]; return true;
+		case IrOp::NEQ: result = args[0] != args[1]; return true;
+		case IrOp::NEG: result = static_cast<int>(0u - a); return true;
+		case IrOp::NOT: result = args[0] == 0; return true;
+		case IrOp::BOOL: result = args[0] != 0; return true;
+		default: return false;
+		}
+	}
+
+}
+
+namespace IrPasses {
+
+	std::size_t deadCodeElimination(IrFunction& f) {
+		std::vector<char> live(f.values.size(), 0);
+		std::vector<int> work;
+		for (IrBlock const& b : f.blocks) {
+			for (int v : b.instructions) {
+				IrOp op = f.values[v].op;
+				if (!IrFunction::pure(op) && op != IrOp::PHI && op != IrOp::UNDEF) {
+					live[v] = 1;
+					work.push_back(v);
+				}
+			}
+		}
+		while (!work.empty()) {
+			int v = work.back();
+			work.pop_back();
+			for (int operand : f.values[v].operands) {
+				if (!live[operand]) {
+					live[operand] = 1;
+					work.push_back(operand);
+				}
+			}
+		}
+		std::vector<char> removed(f.values.size(), 0);
+		for (std::size_t v = 0; v < live.size(); ++v) removed[v] = !live[v];
+		return sweep(f, removed);
+	}
+
+	std::size_t globalValueNumbering(IrFunction& f) {
+		Replacements replace{ f.values.size() };
+		std::vector<char> removed(f.values.size(), 0);
+
+		// PHI banali: tutti gli operandi (escluso il PHI stesso) sono lo stesso valore
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (IrBlock& b : f.blocks) {
+				for (int v : b.instructions) {
+					IrInstruction& in = f.values[v];
+					if (in.op != IrOp::PHI || removed[v]) continue;
+					replace.resolve(in);
+					int same = -1;
+					bool trivial = true;
+					for (int operand : in.operands) {
+						if (operand == v || operand == same) continue;
+						if (same >= 0) { trivial = false; break; }
+						same = operand;
+					}
+					if (trivial && same >= 0) {
+						replace.to[v] = same;
+						removed[v] = 1;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		// Valori che possono essere UNDEF
+		std::vector<char> undefined(f.values.size(), 0);
+		changed = true;
+		while (changed) {
+			changed = false;
+			for (IrBlock const& b : f.blocks) {
+				for (int v : b.instructions) {
+					IrInstruction& in = f.values[v];
+					if (removed[v] || undefined[v]) continue;
+					bool maybe = in.op == IrOp::UNDEF;
+					if (in.op == IrOp::PHI) {
+						for (int operand : in.operands) maybe = maybe || undefined[replace.find(operand)];
+					}
+					if (maybe) {
+						undefined[v] = 1;
+						changed = true;
+					}
+				}
+			}
+		}
+
+		// Visita in preordine dell'albero dei dominatori con una tabella a scope
+		std::vector<int> idom = f.dominators();
+		std::vector<std::vector<int>> children(f.blocks.size());
+		for (std::size_t b = 1; b < f.blocks.size(); ++b) {
+			if (idom[b] >= 0) children[idom[b]].push_back(static_cast<int>(b));
+		}
+		std::map<std::vector<int>, int> table;
+		std::vector<std::vector<std::vector<int>>> scope;
+		std::vector<std::pair<int, bool>> stack{ { 0, false } };
+		std::size_t eliminated = 0;
+		while (!stack.empty()) {
+			auto [b, done] = stack.back();
+			stack.pop_back();
+			if (done) {
+				for (auto const& key : scope.back()) table.erase(key);
+				scope.pop_back();
+				continue;
+			}
+			scope.emplace_back();
+			stack.push_back({ b, true });
+			for (int child : children[b]) stack.push_back({ child, false });
+
+			for (int v : f.blocks[b].instructions) {
+				if (removed[v]) continue;
+				IrInstruction& in = f.values[v];
+				replace.resolve(in);
+				if (in.op == IrOp::CHECK && !undefined[in.operands[0]]) {
+					replace.to[v] = in.operands[0];
+					removed[v] = 1;
+					++eliminated;
+					continue;
+				}
+				bool numbered = IrFunction::pure(in.op) || in.op == IrOp::CHECK || in.op == IrOp::DIV;
+				if (!numbered) continue;
+				if (in.op != IrOp::CONST && in.op != IrOp::CHECK) {
+					std::vector<int> args;
+					for (int operand : in.operands) {
+						if (f.values[operand].op != IrOp::CONST) break;
+						args.push_back(f.values[operand].imm);
+					}
+					int result;
+					if (args.size() == in.operands.size() && evaluate(in.op, args, result)) {
+						in.op = IrOp::CONST;
+						in.imm = result;
+						in.operands.clear();
+					}
+				}
+				std::vector<int> key{ static_cast<int>(in.op), in.imm };
+				key.insert(key.end(), in.operands.begin(), in.operands.end());
+				if (commutative(in.op)) std::sort(key.begin() + 2, key.end());
+				auto itr = table.find(key);
+				if (itr != table.end()) {
+					replace.to[v] = itr->second;
+					removed[v] = 1;
+					++eliminated;
+				}
+				else {
+					table.emplace(key, v);
+					scope.back().push_back(std::move(key));
+				}
+			}
+		}
+
+		for (IrBlock& b : f.blocks) {
+			for (int v : b.instructions) replace.resolve(f.values[v]);
+		}
+		sweep(f, removed);
+		return eliminated;
+	}
+
+	std::size_t loopInvariantCodeMotion(IrFunction& f) {
+		std::size_t moved = 0;
+		std::vector<char> inLoop(f.blocks.size(), 0);
+		for (IrLoop const& loop : f.loops) {
+			for (int b : loop.blocks) inLoop[b] = 1;
+			auto& target = f.blocks[loop.preheader].instructions;
+			bool changed = true;
+			while (changed) {
+				changed = false;
+				for (int b : loop.blocks) {
+					auto& list = f.blocks[b].instructions;
+					for (std::size_t k = 0; k < list.size();) {
+						int v = list[k];
+						IrInstruction& in = f.values[v];
+						bool invariant = IrFunction::pure(in.op);
+						for (int operand : in.operands) {
+							invariant = invariant && !inLoop[f.values[operand].block];
+						}
+						if (!invariant) {
+							++k;
+							continue;
+						}
+						list.erase(list.begin() + static_cast<std::ptrdiff_t>(k));
+						target.insert(target.end() - 1, v);
+						in.block = loop.preheader;
+						++moved;
+						changed = true;
+					}
+				}
+			}
+			for (int b : loop.blocks) inLoop[b] = 0;
+		}
+		return moved;
+	}
+
+}
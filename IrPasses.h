@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "Ir.h"
+
+// Gestore delle passate sull'IR SSA: le passate vengono registrate con un
+// nome ed eseguite in ordine, misurando il tempo di ognuna. Ogni passata
+// restituisce il numero di istruzioni che ha eliminato o spostato.
+class IrPassManager {
+
+public:
+	using Pass = std::function<std::size_t(IrFunction&)>;
+
+	struct Timing {
+		std::string name;
+		double ms;
+		std::size_t changed;
+	};
+
+	void add(std::string name, Pass pass) {
+		passes_.push_back({ std::move(name), std::move(pass) });
+	}
+
+	void run(IrFunction& function);
+
+	std::vector<Timing> const& timings() const { return timings_; }
+
+	// DCE, GVN, LICM, poi di nuovo DCE per i valori rimasti senza usi
+	static IrPassManager standard();
+
+private:
+	struct Entry {
+		std::string name;
+		Pass pass;
+	};
+
+	std::vector<Entry> passes_;
+	std::vector<Timing> timings_;
+};
+
+namespace IrPasses {
+
+	// Elimina le istruzioni pure (e i PHI) il cui valore non viene usato
+	std::size_t deadCodeElimination(IrFunction& function);
+
+	// Numerazione globale dei valori sull'albero dei dominatori: un'istruzione
+	// pura uguale a una che la domina viene sostituita. Elimina anche i PHI
+	// banali, i CHECK di valori sicuramente definiti e calcola le istruzioni
+	// pure con operandi costanti
+	std::size_t globalValueNumbering(IrFunction& function);
+
+	// Sposta nel preheader le istruzioni pure di un ciclo i cui operandi sono
+	// definiti fuori dal ciclo. Le istruzioni pure non possono fallire, quindi
+	// possono essere eseguite anche se il corpo non lo sarebbe stato
+	std::size_t loopInvariantCodeMotion(IrFunction& function);
+
+}
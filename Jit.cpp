@@ -0,0 +1,481 @@
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__linux__) || defined(__APPLE__) || defined(__FreeBSD__))
+#include <sys/mman.h>
+#include <unistd.h>
+#define JIT_X86_64 1
+#endif
+
+#include "Jit.h"
+#include "Visitor.h"
+#include "Token.h"
+
+#if defined(JIT_X86_64)
+
+namespace {
+
+// Numerazione dei registri nella codifica x86-64
+enum Reg { RAX = 0, RCX = 1, RDX = 2, RBX = 3, RSP = 4, RBP = 5, RSI = 6, RDI = 7,
+	R8, R9, R10, R11, R12, R13, R14, R15 };
+
+// rdi punta ai valori delle variabili, rsi alle liste, eax/ecx/edx sono registri di lavoro
+constexpr int VARIABLE_REGS[] = { RBX, R8, R9, R10, R11, R12, R13, R14, R15 };
+constexpr int CALLEE_SAVED[] = { RBP, RBX, R12, R13, R14, R15 };
+
+// Condition code dei jcc/setcc: ogni condizione e la sua negazione
+// differiscono solo nel bit più basso
+enum Cond { CC_AE = 0x3, CC_E = 0x4, CC_NE = 0x5, CC_L = 0xC, CC_GE = 0xD, CC_LE = 0xE, CC_G = 0xF };
+
+// Il ciclo contiene qualcosa che il JIT non gestisce (print, modifiche alle liste, ...)
+struct Unsupported {};
+
+// Genera il codice di un while. Le espressioni lasciano il risultato in eax;
+// un operando destro semplice (variabile o costante) va direttamente in ecx,
+// altrimenti passa dallo stack.
+class JitCompiler : public Visitor {
+
+public:
+	JitCompiler() = default;
+	JitCompiler(std::vector<int> slots, std::vector<char> written)
+		: slots_{ std::move(slots) }, written_{ std::move(written) } {
+		for (std::size_t k = 0; k < slots_.size(); ++k) index_.emplace(slots_[k], static_cast<int>(k));
+	}
+
+	std::vector<int> const& slots() const { return slots_; }
+	std::vector<char> const& written() const { return written_; }
+	std::vector<int> const& lists() const { return lists_; }
+
+	// int loop(int* values, ListView const* lists): 0 se il ciclo è terminato, 1 se bisogna tornare all'interprete
+	std::vector<std::uint8_t> compileLoop(whileStatement const& w) {
+		for (int r : CALLEE_SAVED) push(r);
+		bytes({ 0x48, 0x89, 0xE5 });                     // mov rbp, rsp
+		for (std::size_t k = 0; k < slots_.size(); ++k) load(VARIABLE_REGS[k], static_cast<int>(k));
+
+		// inizio iterazione: salvo lo stato per un eventuale ritorno all'interprete
+		std::size_t head = code_.size();
+		storeWritten();
+		loops_.push_back(Loop{ head, {} });
+		jumpUnless(*w.condition, loops_.back().exits);
+		for (auto* st : w.block) st->accept(*this);
+		jumpTo(head);
+		bind(loops_.back().exits, code_.size());
+		loops_.pop_back();
+
+		storeWritten();
+		bytes({ 0x31, 0xC0 });                           // xor eax, eax
+		std::size_t toEpilogue = jump();
+		bind(bails_, code_.size());
+		bytes({ 0xB8, 1, 0, 0, 0 });                     // mov eax, 1
+		bind(toEpilogue, code_.size());
+		bytes({ 0x48, 0x89, 0xEC });                     // mov rsp, rbp
+		for (int k = 5; k >= 0; --k) pop(CALLEE_SAVED[k]);
+		byte(0xC3);                                      // ret
+		return std::move(code_);
+	}
+
+	void visit(Program const& p) override { throw Unsupported{}; }
+
+	void visit(Definition const& d) override {
+		int target = reg(d.variable_->slot_);
+		written_[index_[d.variable_->slot_]] = 1;
+		d.expression_->accept(*this);
+		movRegReg(target, RAX);
+	}
+
+	void visit(Expression const& o) override { throw Unsupported{}; }
+
+	void visit(Variable const& v) override {
+		movRegReg(RAX, reg(v.slot_));
+	}
+
+	void visit(Constant const& c) override {
+		movRegImm(RAX, c.num_);
+	}
+
+	void visit(ifStatement const& i) override {
+		std::vector<std::size_t> toElse;
+		jumpUnless(*i.condition, toElse);
+		for (auto* st : i.block) st->accept(*this);
+		if (i.elifBlock == nullptr && i.elseBlock.empty()) {
+			bind(toElse, code_.size());
+			return;
+		}
+		std::size_t toEnd = jump();
+		bind(toElse, code_.size());
+		if (i.elifBlock) i.elifBlock->accept(*this);
+		else for (auto* st : i.elseBlock) st->accept(*this);
+		bind(toEnd, code_.size());
+	}
+
+	void visit(whileStatement const& w) override {
+		std::size_t head = code_.size();
+		loops_.push_back(Loop{ head, {} });
+		jumpUnless(*w.condition, loops_.back().exits);
+		for (auto* st : w.block) st->accept(*this);
+		jumpTo(head);
+		bind(loops_.back().exits, code_.size());
+		loops_.pop_back();
+	}
+
+	void visit(Break const& b) override {
+		loops_.back().exits.push_back(jump());
+	}
+
+	void visit(Continue const& c) override {
+		jumpTo(loops_.back().head);
+	}
+
+	void visit(Print const& p) override { throw Unsupported{}; }
+	void visit(listInit const& l) override { throw Unsupported{}; }
+	void visit(listAppend const& l) override { throw Unsupported{}; }
+
+	// Indice fuori dai limiti (anche negativo, col confronto senza segno): interprete.
+	// Gli accessi dimostrati da RangeAnalysis non hanno il controllo
+	void visit(listAccess const& e) override {
+		int k = list(e.slot_);
+		e.index_->accept(*this);
+		if (!e.inBounds_) {
+			bytes({ 0x3B, 0x86 });                       // cmp eax, [rsi + 16k + 8]
+			imm32(16 * k + 8);
+			bails_.push_back(jcc(CC_AE));
+		}
+		bytes({ 0x48, 0x8B, 0x96 });                     // mov rdx, [rsi + 16k]
+		imm32(16 * k);
+		bytes({ 0x8B, 0x04, 0x82 });                     // mov eax, [rdx + rax * 4]
+	}
+
+	void visit(orExpr const& e) override {
+		e.left_->accept(*this);
+		bytes({ 0x85, 0xC0 });                           // test eax, eax
+		std::size_t toRight = jcc(CC_E);
+		bytes({ 0xB8, 1, 0, 0, 0 });                     // mov eax, 1
+		std::size_t toEnd = jump();
+		bind(toRight, code_.size());
+		e.right_->accept(*this);
+		toBool(CC_NE);
+		bind(toEnd, code_.size());
+	}
+
+	void visit(andExpr const& e) override {
+		e.left_->accept(*this);
+		bytes({ 0x85, 0xC0 });                           // test eax, eax
+		std::size_t toEnd = jcc(CC_E);                   // eax vale già 0
+		e.right_->accept(*this);
+		toBool(CC_NE);
+		bind(toEnd, code_.size());
+	}
+
+	void visit(relExpression const& e) override {
+		operands(*e.left_, *e.right_);
+		bytes({ 0x39, 0xC8 });                           // cmp eax, ecx
+		setcc(condition(e.opCode_));
+	}
+
+	void visit(mathExpression const& e) override {
+		if (e.opCode_ == Token::INTDIV && e.shift_ >= 0) {
+			divideByConstant(e);
+			return;
+		}
+		operands(*e.left_, *e.right_);
+		switch (e.opCode_) {
+		case Token::ADD: bytes({ 0x01, 0xC8 }); break;          // add eax, ecx
+		case Token::SUB: bytes({ 0x29, 0xC8 }); break;          // sub eax, ecx
+		case Token::MUL: bytes({ 0x0F, 0xAF, 0xC1 }); break;    // imul eax, ecx
+		case Token::INTDIV:
+			bytes({ 0x85, 0xC9 });                       // test ecx, ecx
+			bails_.push_back(jcc(CC_E));                 // divisione per zero: interprete
+			bytes({ 0x99, 0xF7, 0xF9 });                 // cdq; idiv ecx
+			break;
+		default: throw Unsupported{};
+		}
+	}
+
+	void visit(unaryExpression const& e) override {
+		e.operand_->accept(*this);
+		if (e.opCode_ == Token::SUB) bytes({ 0xF7, 0xD8 });   // neg eax
+		else if (e.opCode_ == Token::NOT) toBool(CC_E);
+		else throw Unsupported{};
+	}
+
+private:
+	struct Loop {
+		std::size_t head;
+		std::vector<std::size_t> exits;
+	};
+
+	std::vector<std::uint8_t> code_;
+	std::vector<int> slots_;
+	std::vector<char> written_;
+	std::unordered_map<int, int> index_;
+	std::vector<int> lists_;
+	std::vector<Loop> loops_;
+	std::vector<std::size_t> bails_;
+
+	int list(int slot) {
+		for (std::size_t k = 0; k < lists_.size(); ++k) {
+			if (lists_[k] == slot) return static_cast<int>(k);
+		}
+		if (lists_.size() == Jit::MAX_LISTS) throw Unsupported{};
+		lists_.push_back(slot);
+		return static_cast<int>(lists_.size() - 1);
+	}
+
+	// Registro della variabile; alla prima passata le variabili vengono raccolte qui
+	int reg(int slot) {
+		auto itr = index_.find(slot);
+		if (itr != index_.end()) return VARIABLE_REGS[itr->second];
+		if (slots_.size() == Jit::MAX_VARIABLES) throw Unsupported{};
+		int k = static_cast<int>(slots_.size());
+		slots_.push_back(slot);
+		written_.push_back(0);
+		index_.emplace(slot, k);
+		return VARIABLE_REGS[k];
+	}
+
+	static int condition(int opCode) {
+		switch (opCode) {
+		case Token::LT:  return CC_L;
+		case Token::LTE: return CC_LE;
+		case Token::GT:  return CC_G;
+		case Token::GTE: return CC_GE;
+		case Token::EQEQ: return CC_E;
+		case Token::NEQ:  return CC_NE;
+		default: throw Unsupported{};
+		}
+	}
+
+	static bool simple(Expression const& e) {
+		return dynamic_cast<Variable const*>(&e) != nullptr || dynamic_cast<Constant const*>(&e) != nullptr;
+	}
+
+	// left in eax, right in ecx
+	void operands(Expression const& left, Expression const& right) {
+		if (simple(right)) {
+			left.accept(*this);
+			if (auto v = dynamic_cast<Variable const*>(&right)) movRegReg(RCX, reg(v->slot_));
+			else movRegImm(RCX, static_cast<Constant const&>(right).num_);
+			return;
+		}
+		right.accept(*this);
+		byte(0x50);                                      // push rax
+		left.accept(*this);
+		byte(0x59);                                      // pop rcx
+	}
+
+	// n // d con d costante: parte alta di M * n, corretta e spostata (MagicDivision.h)
+	void divideByConstant(mathExpression const& e) {
+		int d = static_cast<Constant const&>(*e.right_).num_;
+		e.left_->accept(*this);
+		bytes({ 0x89, 0xC1 });                           // mov ecx, eax
+		bytes({ 0x48, 0x63, 0xC0 });                     // movsxd rax, eax
+		bytes({ 0x48, 0x69, 0xC0 });                     // imul rax, rax, M
+		imm32(e.magic_);
+		bytes({ 0x48, 0xC1, 0xF8, 32 });                 // sar rax, 32
+		if (d > 0 && e.magic_ < 0) bytes({ 0x01, 0xC8 });       // add eax, ecx
+		else if (d < 0 && e.magic_ > 0) bytes({ 0x29, 0xC8 });  // sub eax, ecx
+		if (e.shift_ > 0) bytes({ 0xC1, 0xF8, e.shift_ });      // sar eax, shift
+		bytes({ 0x89, 0xC1 });                           // mov ecx, eax
+		bytes({ 0xC1, 0xE9, 31 });                       // shr ecx, 31
+		bytes({ 0x01, 0xC8 });                           // add eax, ecx
+	}
+
+	// Salto (da collegare in patches) se la condizione è falsa
+	void jumpUnless(Expression const& condition, std::vector<std::size_t>& patches) {
+		if (auto rel = dynamic_cast<relExpression const*>(&condition)) {
+			operands(*rel->left_, *rel->right_);
+			bytes({ 0x39, 0xC8 });                       // cmp eax, ecx
+			patches.push_back(jcc(JitCompiler::condition(rel->opCode_) ^ 1));
+			return;
+		}
+		condition.accept(*this);
+		bytes({ 0x85, 0xC0 });                           // test eax, eax
+		patches.push_back(jcc(CC_E));
+	}
+
+	void storeWritten() {
+		for (std::size_t k = 0; k < slots_.size(); ++k) {
+			if (written_[k]) store(static_cast<int>(k), VARIABLE_REGS[k]);
+		}
+	}
+
+	// Codifica delle istruzioni
+
+	void byte(int b) { code_.push_back(static_cast<std::uint8_t>(b)); }
+
+	void bytes(std::initializer_list<int> bs) {
+		for (int b : bs) byte(b);
+	}
+
+	void imm32(std::int32_t v) {
+		std::uint8_t raw[4];
+		std::memcpy(raw, &v, 4);
+		code_.insert(code_.end(), raw, raw + 4);
+	}
+
+	void rex(int reg, int rm) {
+		int prefix = 0x40 | ((reg >> 3) << 2) | (rm >> 3);
+		if (prefix != 0x40) byte(prefix);
+	}
+
+	void movRegReg(int dst, int src) {
+		if (dst == src) return;
+		rex(src, dst);
+		byte(0x89);
+		byte(0xC0 | ((src & 7) << 3) | (dst & 7));
+	}
+
+	void movRegImm(int dst, std::int32_t value) {
+		rex(0, dst);
+		byte(0xB8 | (dst & 7));
+		imm32(value);
+	}
+
+	// mov reg, [rdi + 4 * index]
+	void load(int dst, int index) {
+		rex(dst, RDI);
+		byte(0x8B);
+		byte(0x80 | ((dst & 7) << 3) | RDI);
+		imm32(4 * index);
+	}
+
+	// mov [rdi + 4 * index], reg
+	void store(int index, int src) {
+		rex(src, RDI);
+		byte(0x89);
+		byte(0x80 | ((src & 7) << 3) | RDI);
+		imm32(4 * index);
+	}
+
+	void push(int r) {
+		if (r >= 8) byte(0x41);
+		byte(0x50 | (r & 7));
+	}
+
+	void pop(int r) {
+		if (r >= 8) byte(0x41);
+		byte(0x58 | (r & 7));
+	}
+
+	// eax = condizione su eax (test) o sul cmp precedente
+	void toBool(int cc) {
+		bytes({ 0x85, 0xC0 });                           // test eax, eax
+		setcc(cc);
+	}
+
+	void setcc(int cc) {
+		bytes({ 0x0F, 0x90 | cc, 0xC0 });                // setcc al
+		bytes({ 0x0F, 0xB6, 0xC0 });                     // movzx eax, al
+	}
+
+	// I salti in avanti restituiscono la posizione del rel32 da collegare
+	std::size_t jcc(int cc) {
+		bytes({ 0x0F, 0x80 | cc });
+		imm32(0);
+		return code_.size() - 4;
+	}
+
+	std::size_t jump() {
+		byte(0xE9);
+		imm32(0);
+		return code_.size() - 4;
+	}
+
+	void jumpTo(std::size_t target) {
+		bind(jump(), target);
+	}
+
+	void bind(std::size_t at, std::size_t target) {
+		std::int32_t rel = static_cast<std::int32_t>(target) - static_cast<std::int32_t>(at + 4);
+		std::memcpy(&code_[at], &rel, 4);
+	}
+
+	void bind(std::vector<std::size_t> const& patches, std::size_t target) {
+		for (std::size_t at : patches) bind(at, target);
+	}
+};
+
+}
+
+#endif
+
+Jit::~Jit() {
+#if defined(JIT_X86_64)
+	for (Buffer& b : buffers_) munmap(b.memory, b.size);
+#endif
+}
+
+bool Jit::available() {
+#if defined(JIT_X86_64)
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Jit::compile(Loop& loop, whileStatement const& w, SymbolTable const& st) {
+	loop.failed = true;
+#if defined(JIT_X86_64)
+	std::vector<std::uint8_t> code;
+	try {
+		// la prima passata raccoglie le variabili, la seconda genera il codice
+		JitCompiler collect;
+		collect.compileLoop(w);
+		JitCompiler compiler{ collect.slots(), collect.written() };
+		code = compiler.compileLoop(w);
+		loop.slots = compiler.slots();
+		loop.written = compiler.written();
+		loop.lists = compiler.lists();
+	}
+	catch (Unsupported&) {
+		return false;
+	}
+	for (int slot : loop.slots) {
+		if (!st.isDefined(slot)) return false;
+	}
+	for (int slot : loop.lists) {
+		if (!st.isList(slot)) return false;
+	}
+
+	// Il codice viene copiato in un buffer scrivibile, poi reso eseguibile
+	std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+	std::size_t size = (code.size() + page - 1) / page * page;
+	void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (memory == MAP_FAILED) return false;
+	std::memcpy(memory, code.data(), code.size());
+	if (mprotect(memory, size, PROT_READ | PROT_EXEC) != 0) {
+		munmap(memory, size);
+		return false;
+	}
+	buffers_.push_back(Buffer{ memory, size });
+	loop.code = reinterpret_cast<Loop::Native>(memory);
+	loop.failed = false;
+	++compiled_;
+	return true;
+#else
+	return false;
+#endif
+}
+
+bool Jit::run(Loop& loop, SymbolTable& st) {
+	int values[MAX_VARIABLES];
+	for (std::size_t k = 0; k < loop.slots.size(); ++k) values[k] = st.getValue(loop.slots[k]);
+	ListView lists[MAX_LISTS];
+	for (std::size_t k = 0; k < loop.lists.size(); ++k) {
+		std::vector<int> const& list = st.list(loop.lists[k]);
+		lists[k] = ListView{ list.data(), static_cast<std::int64_t>(list.size()) };
+	}
+	int bailout = loop.code(values, lists);
+	for (std::size_t k = 0; k < loop.slots.size(); ++k) {
+		if (loop.written[k]) st.setValue(loop.slots[k], values[k]);
+	}
+	if (bailout) {
+		++bailouts_;
+		return false;
+	}
+	return true;
+}
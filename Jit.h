@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "Syntax.h"
+#include "SymbolTable.h"
+
+// JIT x86-64 per i while caldi di EvaluationVisitor.
+// Ogni while conta le proprie iterazioni; oltre HOT_THRESHOLD il ciclo viene
+// compilato (una volta sola) in codice nativo scritto in un buffer mmap, con
+// le variabili tenute nei registri. Sono compilabili solo i cicli fatti di
+// assegnamenti, if, while, break e continue su espressioni intere; le liste
+// possono essere lette (non modificate), con il controllo dei limiti.
+//
+// All'inizio di ogni iterazione il codice nativo salva le variabili: se
+// un'operazione fallirebbe (divisione per zero, indice fuori dai limiti) esce restituendo lo stato
+// salvato e l'interprete riesegue l'iterazione, producendo lo stesso errore.
+// Le variabili lette devono essere già definite quando il ciclo viene compilato,
+// quindi nel codice nativo non può comparire un identificatore non dichiarato.
+class Jit {
+
+public:
+	static constexpr unsigned long HOT_THRESHOLD = 1000;
+	static constexpr std::size_t MAX_VARIABLES = 9;
+	static constexpr std::size_t MAX_LISTS = 8;
+
+	// Lista letta dal codice nativo
+	struct ListView {
+		const int* data;
+		std::int64_t size;
+	};
+
+	// Stato di un while
+	struct Loop {
+		using Native = int (*)(int* values, ListView const* lists);
+
+		unsigned long iterations = 0;
+		bool failed = false;          // non compilabile: non riprovare
+		Native code = nullptr;
+		std::vector<int> slots;       // variabili usate, nell'ordine dei registri
+		std::vector<char> written;    // variabili assegnate nel ciclo
+		std::vector<int> lists;       // liste lette nel ciclo
+	};
+
+	Jit() = default;
+	~Jit();
+	Jit(Jit const&) = delete;
+	Jit& operator=(Jit const&) = delete;
+
+	static bool available();
+
+	Loop& loop(whileStatement const& w) { return loops_[&w]; }
+
+	// Conta un'iterazione; true se il ciclo ha codice nativo pronto da eseguire
+	bool hot(Loop& loop, whileStatement const& w, SymbolTable const& st) {
+		if (loop.code != nullptr) return true;
+		if (loop.failed || ++loop.iterations < HOT_THRESHOLD) return false;
+		return compile(loop, w, st);
+	}
+
+	// Esegue il ciclo dalla condizione: true se è terminato, false se deve
+	// proseguire l'interprete. In entrambi i casi la SymbolTable è aggiornata
+	bool run(Loop& loop, SymbolTable& st);
+
+	// Statistiche
+	std::size_t compiled() const { return compiled_; }
+	std::size_t bailouts() const { return bailouts_; }
+
+private:
+	bool compile(Loop& loop, whileStatement const& w, SymbolTable const& st);
+
+	std::unordered_map<whileStatement const*, Loop> loops_;
+	struct Buffer {
+		void* memory;
+		std::size_t size;
+	};
+	std::vector<Buffer> buffers_;
+	std::size_t compiled_ = 0;
+	std::size_t bailouts_ = 0;
+};
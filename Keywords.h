@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "Token.h"
+
+// Riconoscimento delle keyword con una hash perfetta calcolata a compile time
+// sulla tabella Token::id2word (da Token::AND a Token::FALSE).
+// La hash usa solo primo carattere, ultimo carattere e lunghezza della parola:
+// il seed viene cercato dal compilatore finché le 14 keyword non collidono.
+namespace keywords {
+
+constexpr int FIRST = Token::AND;
+constexpr int LAST = Token::FALSE;
+constexpr int TABLE_BITS = 5;
+constexpr int TABLE_SIZE = 1 << TABLE_BITS;
+constexpr std::size_t MIN_LENGTH = 2;
+constexpr std::size_t MAX_LENGTH = 8;
+
+constexpr std::size_t length(const char* s) {
+	std::size_t n = 0;
+	while (s[n] != '\0') ++n;
+	return n;
+}
+
+constexpr std::uint32_t hash(std::uint32_t seed, char first, char last, std::size_t len) {
+	std::uint32_t key = (static_cast<std::uint32_t>(static_cast<unsigned char>(first)) << 8)
+		| static_cast<unsigned char>(last);
+	key ^= static_cast<std::uint32_t>(len) << 16;
+	return (key * seed) >> (32 - TABLE_BITS);
+}
+
+struct Table {
+	std::uint32_t seed = 0;
+	int tags[TABLE_SIZE] = {};              // -1 se lo slot è vuoto
+	std::size_t lengths[TABLE_SIZE] = {};
+};
+
+constexpr Table build() {
+	for (std::uint32_t seed = 0x9E3779B1u;; seed += 2) {
+		Table t{};
+		t.seed = seed;
+		for (int i = 0; i < TABLE_SIZE; ++i) t.tags[i] = -1;
+		bool ok = true;
+		for (int tag = FIRST; tag <= LAST && ok; ++tag) {
+			const char* word = Token::id2word[tag];
+			std::size_t len = length(word);
+			std::uint32_t h = hash(seed, word[0], word[len - 1], len);
+			if (t.tags[h] != -1) {
+				ok = false;
+			}
+			else {
+				t.tags[h] = tag;
+				t.lengths[h] = len;
+			}
+		}
+		if (ok) return t;
+	}
+}
+
+inline constexpr Table TABLE = build();
+
+// Tag della keyword, oppure Token::ID se word non è una keyword
+inline int lookup(std::string_view word) {
+	if (word.size() < MIN_LENGTH || word.size() > MAX_LENGTH) return Token::ID;
+	std::uint32_t h = hash(TABLE.seed, word.front(), word.back(), word.size());
+	int tag = TABLE.tags[h];
+	if (tag >= 0 && TABLE.lengths[h] == word.size()
+		&& std::memcmp(word.data(), Token::id2word[tag], word.size()) == 0) {
+		return tag;
+	}
+	return Token::ID;
+}
+
+}
@@ -1,189 +1,402 @@
-#include "Lexer.h"
-#include "Exception.h"
-
-#include <sstream>
-#include <vector>
-#include <string>
-#include <iostream>
-
-void printTokens(const std::vector<Token>& tokens) {
-    for (const auto& tk : tokens) {
-        std::cout << tk << std::endl;
-    }
-}
-
-std::string Lexer::tokenizeConstant(std::ifstream& inputFile, std::stringstream& temp) {
-    char ch = inputFile.get();
-    while (ch >= '0' && ch <= '9') {
-        temp << ch;
-        ch = inputFile.get();
-    }
-    inputFile.unget();
-    return temp.str();
-}
-
-void Lexer::tokenizeInputFile(std::ifstream& inputFile, std::vector<Token>& inputTokens) {
-    char ch{};
-    unsigned int rowCount{ 1 };
-    std::vector<int> indents{ 0 };  // stack per indentation
-    bool newLine = true;    // nuova line
-
-    while (inputFile.get(ch)) {
-        // Skippo newline, spazi
-        if (ch == '\n') {
-            inputTokens.push_back(Token{ Token::NEWLINE, "\\n" });
-            rowCount += 1;
-            newLine = true;
-            continue;
-        }
-        else if (ch == ' ' || ch == '\t') {
-            if (!newLine) continue;
-        }
-        // Skippo ; perch presenti in alcuni vettori di test anche se non descritti nel linguaggio
-        if (ch == ';') continue;
-
-        // Indentation
-        if (newLine) {
-            int countSpaces = 0;
-            while (ch == ' ' || ch == '\t') {
-                countSpaces += (ch == ' ') ? 1 : 4;
-                inputFile.get(ch);
-            }
-
-            if (countSpaces > indents.back()) {
-                indents.push_back(countSpaces);
-                inputTokens.push_back(Token{ Token::INDENT, "INDENT" });
-            }
-            else {
-                while (countSpaces < indents.back()) {
-                    indents.pop_back();
-                    inputTokens.push_back(Token{ Token::DEDENT, "DEDENT" });
-                }
-                if (countSpaces != indents.back()) {
-					printTokens(inputTokens);
-                    throw LexicalError("ERROR: Inconsistent indentation at line " + std::to_string(rowCount));
-                }
-            }
-            newLine = false;
-        }
-
-        if (ch == '(') inputTokens.push_back(Token{ Token::LP, "(" });
-        else if (ch == ')') inputTokens.push_back(Token{ Token::RP, ")" });
-        else if (ch == '[') inputTokens.push_back(Token{ Token::LBRACK, "[" });
-        else if (ch == ']') inputTokens.push_back(Token{ Token::RBRACK, "]" });
-        else if (ch == ':') inputTokens.push_back(Token{ Token::COLON, ":" });
-        else if (ch == ',') inputTokens.push_back(Token{ Token::COMMA, "," });
-        else if (ch == '.') inputTokens.push_back(Token{ Token::DOT, "." });
-        else if (ch == '+') inputTokens.push_back(Token{ Token::ADD, "+" });
-        else if (ch == '-') inputTokens.push_back(Token{ Token::SUB, "-" });
-        else if (ch == '*') inputTokens.push_back(Token{ Token::MUL, "*" });
-        // Divisione intera
-        else if (ch == '/') {
-            if (inputFile.peek() == '/') {
-                inputFile.get();
-                inputTokens.push_back(Token{ Token::INTDIV, "//" });
-            }
-        }
-        else if (ch == '=') {
-            char next = inputFile.peek();
-            if (next == '=') {
-                inputFile.get();
-                inputTokens.push_back(Token{ Token::EQEQ, "==" });
-            }
-            else {
-                inputTokens.push_back(Token{ Token::EQ, "=" });
-            }
-        }
-
-        // Operatori di confronto
-        else if (ch == '<') {
-            char next = inputFile.peek();
-            if (next == '=') {
-                inputFile.get();
-                inputTokens.push_back(Token{ Token::LTE, "<=" });
-            }
-            else {
-                inputTokens.push_back(Token{ Token::LT, "<" });
-            }
-        }
-        else if (ch == '>') {
-            char next = inputFile.peek();
-            if (next == '=') {
-                inputFile.get();
-                inputTokens.push_back(Token{ Token::GTE, ">=" });
-            }
-            else {
-                inputTokens.push_back(Token{ Token::GT, ">" });
-            }
-        }
-        else if (ch == '!') {
-            char next = inputFile.get();
-            if (next == '=') {
-                inputTokens.push_back(Token{ Token::NEQ, "!=" });
-            }
-            else {
-                printTokens(inputTokens);
-                throw LexicalError("ERROR: Unexpected character '!' at line " + std::to_string(rowCount));
-            }
-        }
-
-        else if (ch >= '0' && ch <= '9') {
-            std::stringstream temp;
-            temp << ch;
-            tokenizeConstant(inputFile, temp);
-            inputTokens.push_back(Token{ Token::CONST, temp.str() });
-        }
-
-        // Indentificatori/keywords
-
-        else if (std::isalpha(ch)) {
-            std::stringstream temp;
-            // isAlpha  true se ch  a-zA-Z
-			// isAlnum  true se ch  a-zA-Z0-9
-            temp << ch;
-            do {
-                std::isalnum(ch);
-				ch = inputFile.get();
-				if (std::isalnum(ch)) temp << ch;
-                
-            } while (std::isalnum(ch));
-            
-            inputFile.unget();
-
-            std::string word = temp.str();
-            int tag = Token::ID;
-
-            // Keywords
-            if (word == "if") tag = Token::IF;
-            else if (word == "elif") tag = Token::ELIF;
-            else if (word == "else") tag = Token::ELSE;
-            else if (word == "while") tag = Token::WHILE;
-            else if (word == "break") tag = Token::BREAK;
-            else if (word == "continue") tag = Token::CONTINUE;
-            else if (word == "list") tag = Token::LIST;
-            else if (word == "append") tag = Token::APPEND;
-            else if (word == "print") tag = Token::PRINT;
-            else if (word == "True") tag = Token::TRUE;
-            else if (word == "False") tag = Token::FALSE;
-            else if (word == "and") tag = Token::AND;
-            else if (word == "or") tag = Token::OR;
-            else if (word == "not") tag = Token::NOT;
-
-            inputTokens.push_back(Token{ tag, word });
-        }
-
-        // Stray character -> lexical error in Exception.h
-        else {
-            throw LexicalError("ERROR: Stray character '" + std::string(1, ch) + "' at line " + std::to_string(rowCount));
-        }
-    }
-
-    // End of File
-    while (indents.size() > 1) {
-        indents.pop_back();
-        inputTokens.push_back(Token{ Token::DEDENT, "DEDENT" });
-    }
-
-    inputTokens.push_back(Token{ Token::ENDMARKER, "ENDMARKER" });
-
-}
+#include "Lexer.h"
+#include "Exception.h"
+#include "Keywords.h"
+#include "CharScan.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <thread>
+
+void printTokens(const TokenStream& tokens, std::ostream& out) {
+    for (std::size_t i = 0; i < tokens.size(); ++i) {
+        Token tk = tokens[i];
+        printToken(out, tk, tokens.word(tk)) << std::endl;
+    }
+}
+
+namespace {
+
+std::string_view tokenizeConstant(std::string_view source, std::size_t& pos) {
+    // pos punta alla prima cifra
+    std::size_t start = pos;
+    pos += charscan::scanDigits(source.data() + pos, source.data() + source.size());
+    return source.substr(start, pos - start);
+}
+
+// Aggiorna lo stack dell'indentazione a inizio linea emettendo INDENT/DEDENT.
+// dump() stampa i token letti finora prima dell'errore di indentazione.
+template <class Emit, class Dump>
+void applyIndentation(int countSpaces, LexerState& state, Emit&& emit, Dump&& dump) {
+    if (countSpaces > state.indents.back()) {
+        state.indents.push_back(countSpaces);
+        emit(Token::INDENT);
+    }
+    else {
+        while (countSpaces < state.indents.back()) {
+            state.indents.pop_back();
+            emit(Token::DEDENT);
+        }
+        if (countSpaces != state.indents.back()) {
+			dump();
+            throw LexicalError("ERROR: Inconsistent indentation at line " + std::to_string(state.rowCount));
+        }
+    }
+}
+
+// Tokenizza una singola linea (compreso il '\n' finale, se presente).
+// Tra una linea e l'altra passano solo indentazione e numero di riga: i token non attraversano mai un '\n'.
+// emit(tag, posizione nella linea, lunghezza, valore) riceve i token prodotti,
+// indent(spazi, posizione) gestisce l'indentazione a inizio linea,
+// fail(messaggio, dump) segnala un errore (il numero di riga viene aggiunto da chi lo riceve).
+template <class Emit, class Indent, class Fail>
+void tokenizeLine(std::string_view line, LexerState& state, SymbolInterner& symbols, Emit&& emit, Indent&& indent, Fail&& fail) {
+    char ch{};
+    std::size_t pos{ 0 };
+    const std::size_t end{ line.size() };
+    bool newLine = true;    // nuova line
+
+    while (pos < end) {
+        ch = line[pos++];
+        // Skippo newline, spazi
+        if (ch == '\n') {
+            emit(Token::NEWLINE, pos - 1, 1);
+            state.rowCount += 1;
+            newLine = true;
+            continue;
+        }
+        else if (ch == ' ' || ch == '\t') {
+            if (!newLine) continue;
+        }
+        // Skippo ; perché presenti in alcuni vettori di test anche se non descritti nel linguaggio
+        if (ch == ';') continue;
+
+        // Indentation
+        if (newLine) {
+            // Spazi contano 1, tab contano 4
+            std::size_t tabs = 0;
+            std::size_t run = charscan::scanBlanks(line.data() + pos - 1, line.data() + end, tabs);
+            int countSpaces = static_cast<int>(run - tabs + 4 * tabs);
+            pos += run - 1;
+            // Solo spazi fino alla fine del file
+            if (pos == end) return;
+            ch = line[pos++];
+
+            indent(countSpaces, pos - 1);
+            newLine = false;
+        }
+
+        if (ch == '(') emit(Token::LP, pos - 1, 1);
+        else if (ch == ')') emit(Token::RP, pos - 1, 1);
+        else if (ch == '[') emit(Token::LBRACK, pos - 1, 1);
+        else if (ch == ']') emit(Token::RBRACK, pos - 1, 1);
+        else if (ch == ':') emit(Token::COLON, pos - 1, 1);
+        else if (ch == ',') emit(Token::COMMA, pos - 1, 1);
+        else if (ch == '.') emit(Token::DOT, pos - 1, 1);
+        else if (ch == '+') emit(Token::ADD, pos - 1, 1);
+        else if (ch == '-') emit(Token::SUB, pos - 1, 1);
+        else if (ch == '*') emit(Token::MUL, pos - 1, 1);
+        // Divisione intera
+        else if (ch == '/') {
+            if (pos < end && line[pos] == '/') {
+                ++pos;
+                emit(Token::INTDIV, pos - 2, 2);
+            }
+        }
+        else if (ch == '=') {
+            if (pos < end && line[pos] == '=') {
+                ++pos;
+                emit(Token::EQEQ, pos - 2, 2);
+            }
+            else {
+                emit(Token::EQ, pos - 1, 1);
+            }
+        }
+
+        // Operatori di confronto
+        else if (ch == '<') {
+            if (pos < end && line[pos] == '=') {
+                ++pos;
+                emit(Token::LTE, pos - 2, 2);
+            }
+            else {
+                emit(Token::LT, pos - 1, 1);
+            }
+        }
+        else if (ch == '>') {
+            if (pos < end && line[pos] == '=') {
+                ++pos;
+                emit(Token::GTE, pos - 2, 2);
+            }
+            else {
+                emit(Token::GT, pos - 1, 1);
+            }
+        }
+        else if (ch == '!') {
+            if (pos < end && line[pos++] == '=') {
+                emit(Token::NEQ, pos - 2, 2);
+            }
+            else {
+                fail("ERROR: Unexpected character '!' at line ", true);
+            }
+        }
+
+        else if (ch >= '0' && ch <= '9') {
+            --pos;  // la prima cifra fa parte della costante
+            std::size_t start = pos;
+            std::string_view digits = tokenizeConstant(line, pos);
+            // Il valore viene convertito qui con from_chars e salvato nel token;
+            // come lo stringstream usato in precedenza, in caso di overflow satura a INT_MAX
+            int num{};
+            auto result = std::from_chars(digits.data(), digits.data() + digits.size(), num);
+            if (result.ec == std::errc::result_out_of_range) num = std::numeric_limits<int>::max();
+            emit(Token::CONST, start, static_cast<std::uint32_t>(digits.size()), num);
+        }
+
+        // Indentificatori/keywords
+
+        else if (std::isalpha(static_cast<unsigned char>(ch))) {
+            // isAlpha è true se ch è a-zA-Z
+			// isAlnum è true se ch è a-zA-Z0-9
+            std::size_t start = pos - 1;
+            pos += charscan::scanAlnum(line.data() + pos, line.data() + end);
+
+            // La parola punta direttamente al buffer sorgente, nessuna copia
+            // (solo gli identificatori vengono internati)
+            std::string_view word = line.substr(start, pos - start);
+
+            // Keywords (hash perfetta, vedi Keywords.h)
+            int tag = keywords::lookup(word);
+
+            std::int32_t symbol = (tag == Token::ID) ? symbols.intern(word) : 0;
+            emit(tag, start, static_cast<std::uint32_t>(word.size()), symbol);
+        }
+
+        // Stray character -> lexical error in Exception.h
+        else {
+            fail("ERROR: Stray character '" + std::string(1, ch) + "' at line ", false);
+        }
+    }
+
+}
+
+}
+
+void Lexer::tokenizeInputFile(std::string_view source, TokenStream& inputTokens) {
+    LexerState state;
+    const std::size_t end{ source.size() };
+    std::size_t lineStart{ 0 };
+
+    while (lineStart < end) {
+        const void* nl = std::memchr(source.data() + lineStart, '\n', end - lineStart);
+        std::size_t lineEnd = nl ? static_cast<const char*>(nl) - source.data() + 1 : end;
+        auto emit = [&](int tag, std::size_t pos, std::uint32_t length, std::int32_t value = 0) {
+            inputTokens.push(tag, static_cast<std::uint32_t>(lineStart + pos), length, value);
+        };
+        tokenizeLine(source.substr(lineStart, lineEnd - lineStart), state, inputTokens.symbols(), emit,
+            [&](int countSpaces, std::size_t pos) {
+                applyIndentation(countSpaces, state, [&](int tag) { emit(tag, pos, 0); },
+                    [&]() { printTokens(inputTokens, dump_); });
+            },
+            [&](std::string const& message, bool dump) {
+                if (dump) printTokens(inputTokens, dump_);
+                throw LexicalError(message + std::to_string(state.rowCount));
+            });
+        lineStart = lineEnd;
+    }
+
+    // End of File
+    while (state.indents.size() > 1) {
+        state.indents.pop_back();
+        inputTokens.push(Token::DEDENT, end, 0);
+    }
+
+    inputTokens.push(Token::ENDMARKER, end, 0);
+
+}
+
+namespace {
+
+// Marcatore usato dai chunk paralleli al posto di INDENT/DEDENT: value contiene
+// gli spazi di indentazione, che vengono risolti nel passo sequenziale finale
+constexpr int INDENT_MARKER = 255;
+
+// Porzione di sorgente (a confine di linea) tokenizzata da un thread
+struct Chunk {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    TokenStream tokens;         // offset globali, simboli locali al chunk
+    bool failed = false;        // errore lessicale: il chunk si ferma lì
+    bool dump = false;
+    std::string message;        // messaggio senza numero di riga
+};
+
+struct ChunkStop {};
+
+void tokenizeChunk(std::string_view source, Chunk& chunk) {
+    LexerState state;   // il numero di riga qui non serve, lo ricalcola il merge
+    std::size_t lineStart{ chunk.begin };
+    try {
+        while (lineStart < chunk.end) {
+            const void* nl = std::memchr(source.data() + lineStart, '\n', chunk.end - lineStart);
+            std::size_t lineEnd = nl ? static_cast<const char*>(nl) - source.data() + 1 : chunk.end;
+            auto emit = [&](int tag, std::size_t pos, std::uint32_t length, std::int32_t value = 0) {
+                chunk.tokens.push(tag, static_cast<std::uint32_t>(lineStart + pos), length, value);
+            };
+            tokenizeLine(source.substr(lineStart, lineEnd - lineStart), state, chunk.tokens.symbols(), emit,
+                [&](int countSpaces, std::size_t pos) { emit(INDENT_MARKER, pos, 0, countSpaces); },
+                [&](std::string const& message, bool dump) {
+                    chunk.failed = true;
+                    chunk.dump = dump;
+                    chunk.message = message;
+                    throw ChunkStop{};
+                });
+            lineStart = lineEnd;
+        }
+    }
+    catch (ChunkStop&) {}
+}
+
+}
+
+void Lexer::tokenizeParallel(std::string_view source, TokenStream& inputTokens) {
+    // Divido il sorgente in più chunk che thread, tagliando sempre dopo un '\n'
+    const std::size_t end{ source.size() };
+    const std::size_t target = end / (jobs_ * 4) + 1;
+    std::vector<Chunk> chunks;
+    for (std::size_t begin = 0; begin < end;) {
+        std::size_t cut = std::min(begin + target, end);
+        if (cut < end) {
+            const void* nl = std::memchr(source.data() + cut, '\n', end - cut);
+            cut = nl ? static_cast<const char*>(nl) - source.data() + 1 : end;
+        }
+        chunks.emplace_back();
+        chunks.back().begin = begin;
+        chunks.back().end = cut;
+        chunks.back().tokens.reserve((cut - begin) / BYTES_PER_TOKEN);
+        begin = cut;
+    }
+
+    // Pool di thread: ognuno prende il prossimo chunk libero
+    std::atomic<std::size_t> nextChunk{ 0 };
+    std::vector<std::thread> pool;
+    unsigned int workers = std::min<std::size_t>(jobs_, chunks.size());
+    for (unsigned int w = 0; w < workers; ++w) {
+        pool.emplace_back([&]() {
+            for (std::size_t i = nextChunk++; i < chunks.size(); i = nextChunk++) {
+                tokenizeChunk(source, chunks[i]);
+            }
+        });
+    }
+    for (auto& t : pool) t.join();
+
+    // Passo sequenziale: risolvo INDENT/DEDENT con lo stack globale, riporto i simboli
+    // nella tabella globale e ricostruisco gli errori nello stesso ordine del lexer sequenziale
+    std::size_t total = 1;
+    for (auto const& chunk : chunks) total += chunk.tokens.size();
+    inputTokens.reserve(total);
+
+    LexerState state;
+    for (auto const& chunk : chunks) {
+        std::vector<std::int32_t> remap(chunk.tokens.symbols().size());
+        for (std::size_t i = 0; i < remap.size(); ++i) {
+            remap[i] = inputTokens.symbols().intern(chunk.tokens.symbols().name(static_cast<std::int32_t>(i)));
+        }
+        for (std::size_t i = 0; i < chunk.tokens.size(); ++i) {
+            Token tk = chunk.tokens[i];
+            if (tk.tag == INDENT_MARKER) {
+                applyIndentation(tk.value, state, [&](int tag) { inputTokens.push(tag, tk.offset, 0); },
+                    [&]() { printTokens(inputTokens, dump_); });
+                continue;
+            }
+            if (tk.tag == Token::ID) tk.value = remap[tk.value];
+            else if (tk.tag == Token::NEWLINE) state.rowCount += 1;
+            inputTokens.push(tk.tag, tk.offset, tk.length, tk.value);
+        }
+        if (chunk.failed) {
+            if (chunk.dump) printTokens(inputTokens, dump_);
+            throw LexicalError(chunk.message + std::to_string(state.rowCount));
+        }
+    }
+
+    // End of File
+    while (state.indents.size() > 1) {
+        state.indents.pop_back();
+        inputTokens.push(Token::DEDENT, end, 0);
+    }
+
+    inputTokens.push(Token::ENDMARKER, end, 0);
+}
+
+bool StreamLexer::fill(TokenRing& ring) {
+    while (!ring.full()) {
+        if (!pending_.empty()) {
+            ring.push(pending_.front());
+            pending_.pop_front();
+            continue;
+        }
+        if (finished_) break;
+
+        // Leggo la prossima linea; getline toglie il '\n', che rimetto se c'era
+        if (std::getline(input_, line_)) {
+            if (!input_.eof()) line_.push_back('\n');
+            auto emit = [&](int tag, std::size_t pos, std::uint32_t length, std::int32_t value = 0) {
+                Token tk{ tag, static_cast<std::uint32_t>(offset_ + pos), length, value };
+                pending_.push_back(TokenRing::Entry{ tk, static_cast<int>(state_.rowCount), static_cast<int>(pos) + 1 });
+            };
+            if (spool_ != nullptr) std::fwrite(line_.data(), 1, line_.size(), spool_);
+            tokenizeLine(line_, state_, symbols_, emit,
+                [&](int countSpaces, std::size_t pos) {
+                    applyIndentation(countSpaces, state_, [&](int tag) { emit(tag, pos, 0); },
+                        [] {});
+                },
+                [&](std::string const& message, bool) {
+                    throw LexicalError(message + std::to_string(state_.rowCount));
+                });
+            offset_ += line_.size();
+        }
+        else {
+            // End of File
+            std::uint32_t end = static_cast<std::uint32_t>(offset_);
+            while (state_.indents.size() > 1) {
+                state_.indents.pop_back();
+                pending_.push_back(TokenRing::Entry{ Token{ Token::DEDENT, end, 0 }, static_cast<int>(state_.rowCount), 1 });
+            }
+            pending_.push_back(TokenRing::Entry{ Token{ Token::ENDMARKER, end, 0 }, static_cast<int>(state_.rowCount), 1 });
+            finished_ = true;
+        }
+    }
+    return !ring.empty();
+}
+
+void StreamLexer::dump(std::ostream& out) const {
+    if (spool_ == nullptr) return;
+    // Rileggo le linee lette fin qui: Lexer stampa gli stessi token che avrebbe
+    // stampato sull'intero file e si ferma sullo stesso errore
+    std::string source;
+    std::rewind(spool_);
+    char buffer[4096];
+    for (std::size_t n; (n = std::fread(buffer, 1, sizeof buffer, spool_)) != 0;) source.append(buffer, n);
+    try {
+        Lexer{ 1, out }(source);
+    }
+    catch (LexicalError&) {
+    }
+    out.flush();
+}
+
+std::string StreamLexer::word(Token const& t) const {
+    // Senza sorgente in memoria le costanti vengono ristampate dal valore
+    switch (t.tag) {
+    case Token::ID: return std::string{ symbols_.name(t.value) };
+    case Token::CONST: return std::to_string(t.value);
+    case Token::NEWLINE: return "\\n";
+    default: return Token::id2word[t.tag];
+    }
+}
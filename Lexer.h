@@ -1,26 +1,126 @@
-#pragma once
-
-#include <vector>
-#include <fstream>
-
-#include "Token.h"
-#include "Exception.h"
-
-// Funzione object per tokenizzare uno stream di input
-class Lexer {
-public:
-	Lexer() = default;
-	~Lexer() = default;
-	Lexer(Lexer const&) = delete;
-	Lexer& operator=(Lexer const&) = delete;
-
-	std::vector<Token> operator()(std::ifstream& inputFile) {
-		std::vector<Token> inputTokens;
-		tokenizeInputFile(inputFile, inputTokens);
-		return inputTokens;
-	}
-
-private:
-	std::string tokenizeConstant(std::ifstream& inputFile, std::stringstream& temp);
-	void tokenizeInputFile(std::ifstream& inputFile, std::vector<Token>& inputTokens);
-};
\ No newline at end of file
+#pragma once
+
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Token.h"
+#include "TokenStream.h"
+#include "Exception.h"
+
+// Stato che il lexer si porta da una linea alla successiva
+struct LexerState {
+	unsigned int rowCount{ 1 };
+	std::vector<int> indents{ 0 };  // stack per indentation
+};
+
+// Funzione object per tokenizzare il contenuto di un file sorgente.
+// I token restituiti puntano a source (offset/length): il buffer deve sopravvivere al parsing.
+// Con jobs > 1 i file grandi vengono tokenizzati in parallelo, con lo stesso risultato.
+// In caso di errore i token letti fin lì vengono stampati su dump.
+class Lexer {
+public:
+	explicit Lexer(unsigned int jobs = 1, std::ostream& dump = std::cout) : jobs_{ jobs == 0 ? 1 : jobs }, dump_{ dump } {}
+	~Lexer() = default;
+	Lexer(Lexer const&) = delete;
+	Lexer& operator=(Lexer const&) = delete;
+
+	TokenStream operator()(std::string_view source) {
+		TokenStream inputTokens{ source };
+		if (jobs_ > 1 && source.size() >= PARALLEL_THRESHOLD) {
+			tokenizeParallel(source, inputTokens);
+		}
+		else {
+			inputTokens.reserve(source.size() / BYTES_PER_TOKEN);
+			tokenizeInputFile(source, inputTokens);
+		}
+		return inputTokens;
+	}
+
+private:
+	// Stima per difetto: gli script hanno in media un token ogni 2-3 byte e di
+	// rado meno di uno ogni 8. Oltre la stima i vettori crescono geometricamente,
+	// quindi la memoria riservata non supera mai il doppio di quella usata
+	static constexpr std::size_t BYTES_PER_TOKEN = 8;
+
+	// Sotto questa dimensione il lexing parallelo non conviene
+	static constexpr std::size_t PARALLEL_THRESHOLD = 1 << 20;
+
+	unsigned int jobs_;
+	std::ostream& dump_;
+
+	void tokenizeInputFile(std::string_view source, TokenStream& inputTokens);
+	void tokenizeParallel(std::string_view source, TokenStream& inputTokens);
+};
+
+// Lexer incrementale su un qualunque std::istream (file, stdin, pipe).
+// Legge una linea alla volta e produce token solo quando il ring ha spazio,
+// quindi la memoria usata non dipende dalla lunghezza dello script.
+// I token già consumati non sono più in memoria: per poterli stampare dopo un
+// errore come fa Lexer, le linee lette vengono accodate a un file temporaneo.
+class StreamLexer {
+public:
+	explicit StreamLexer(std::istream& input) : input_{ input }, spool_{ std::tmpfile() } {}
+	~StreamLexer() {
+		if (spool_ != nullptr) std::fclose(spool_);
+	}
+	StreamLexer(StreamLexer const&) = delete;
+	StreamLexer& operator=(StreamLexer const&) = delete;
+
+	// Riempie il ring finché c'è spazio; false se non ci sono più token
+	bool fill(TokenRing& ring);
+
+	SymbolInterner const& symbols() const { return symbols_; }
+	std::string word(Token const& t) const;
+
+	// Dopo un LexicalError stampa i token letti prima dell'errore, se l'errore
+	// lo prevede (come Lexer). Va chiamata dopo aver svuotato l'uscita del programma
+	void dump(std::ostream& out) const;
+
+private:
+	std::istream& input_;
+	LexerState state_;
+	SymbolInterner symbols_;
+	std::string line_;
+	std::uint64_t offset_ = 0;
+	std::deque<TokenRing::Entry> pending_;  // token di una linea che non stanno nel ring
+	bool finished_ = false;
+	std::FILE* spool_;                      // linee lette (nullptr se non disponibile)
+};
+
+// Sorgente di token per il Parser in modalità streaming: i token passano dal ring
+// e vengono scartati appena consumati
+class StreamingSource : public TokenSource {
+public:
+	explicit StreamingSource(StreamLexer& lexer, std::size_t capacity = 4096)
+		: lexer_{ lexer }, ring_{ capacity } {
+	}
+
+	bool next(Token& t) override {
+		if (ring_.empty() && !lexer_.fill(ring_)) return false;
+		TokenRing::Entry e = ring_.pop();
+		t = e.token;
+		lastOffset_ = e.token.offset;
+		lastLocation_ = { e.line, e.column };
+		return true;
+	}
+
+	std::string word(Token const& t) const override { return lexer_.word(t); }
+
+	// Gli errori riguardano sempre l'ultimo token letto, l'unico di cui conservo la posizione
+	std::pair<int, int> location(Token const& t) const override {
+		if (t.offset == lastOffset_) return lastLocation_;
+		return { 0, 0 };
+	}
+
+	SymbolInterner const& symbols() const override { return lexer_.symbols(); }
+
+private:
+	StreamLexer& lexer_;
+	TokenRing ring_;
+	std::uint32_t lastOffset_ = 0;
+	std::pair<int, int> lastLocation_{ 0, 0 };
+};
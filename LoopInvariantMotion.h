@@ -0,0 +1,357 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Syntax.h"
+#include "Token.h"
+
+// Spostamento del codice invariante fuori dai while (LICM sull'AST), eseguito
+// dopo il Resolver. Un'espressione è invariante se nessuna variabile che legge
+// viene assegnata nel ciclo e nessuna lista che legge viene creata o estesa;
+// viene calcolata una volta in un temporaneo ($licmN) prima del ciclo e le
+// sue occorrenze diventano letture del temporaneo.
+//
+// Le espressioni che non possono fallire (niente liste, divisioni solo per
+// costanti diverse da 0 e -1, variabili sicuramente assegnate prima del
+// ciclo) vengono spostate da qualunque punto del ciclo. Quelle che possono
+// fallire (// , accesso a lista, variabile forse non dichiarata) vengono
+// spostate solo se protette, cioè se la loro prima valutazione avviene
+// comunque all'ingresso del ciclo prima di ogni altra operazione che può
+// fallire o stampare:
+//  - nella condizione, valutata sempre all'ingresso: il temporaneo viene
+//    calcolato subito prima del ciclo;
+//  - nei primi statement del corpo: il temporaneo viene calcolato sotto
+//    `if <condizione>:` prima del ciclo e sostituito solo nel corpo.
+// In entrambi i casi l'eventuale errore arriva nello stesso punto.
+class LoopInvariantMotion {
+
+public:
+	// Restituisce il numero di espressioni spostate
+	static std::size_t hoist(Program& program) {
+		LoopInvariantMotion pass{ program };
+		program.statements = pass.block(program.statements, true);
+		program.symbols = program.arena.copy(pass.names_);
+		return pass.hoisted_;
+	}
+
+private:
+	explicit LoopInvariantMotion(Program& program)
+		: program_{ program }, names_(program.symbols.begin(), program.symbols.end()),
+		defined_(program.symbols.size(), 0) {
+	}
+
+	// Dove viene calcolato un temporaneo
+	enum class Place { BEFORE, GUARDED };
+
+	struct Hoisted {
+		Variable* temp;
+		Expression* value;
+		Place place;
+	};
+
+	// Stato del ciclo in esame
+	struct Loop {
+		std::vector<char> assigned;     // variabili assegnate nel ciclo
+		std::vector<char> modified;     // liste create o estese nel ciclo
+		std::vector<char> defined;      // variabili sicuramente assegnate all'ingresso
+		std::vector<Hoisted> hoisted;
+		std::unordered_map<std::string, std::size_t> keys;
+		bool blocked = false;           // è già stata valutata un'operazione che può fallire
+		bool cond = false;              // si sta esaminando la condizione
+	};
+
+	Program& program_;
+	std::vector<std::string_view> names_;
+	std::vector<char> defined_;
+	std::size_t hoisted_ = 0;
+	Loop* loop_ = nullptr;
+
+	NodeList<Statement*> block(NodeList<Statement*> const& statements, bool topLevel) {
+		std::vector<Statement*> out;
+		for (Statement* st : statements) {
+			std::vector<char> entry = defined_;
+			statement(st, out);
+			// al top-level break/continue interrompono lo statement a metà
+			if (topLevel && escapes(st)) restore(std::move(entry));
+		}
+		return program_.arena.copy(out);
+	}
+
+	void statement(Statement* st, std::vector<Statement*>& out) {
+		if (auto d = dynamic_cast<Definition*>(st)) {
+			defined_[d->variable_->slot_] = 1;
+		}
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			branch(i);
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			loop(w, out);
+		}
+		out.push_back(st);
+	}
+
+	void branch(ifStatement* i) {
+		std::vector<char> entry = defined_;
+		i->block = block(i->block, false);
+		std::vector<char> afterThen = std::move(defined_);
+		restore(std::move(entry));
+		if (i->elifBlock != nullptr) branch(i->elifBlock);
+		else i->elseBlock = block(i->elseBlock, false);
+		afterThen.resize(defined_.size(), 0);
+		for (std::size_t k = 0; k < defined_.size(); ++k) defined_[k] = defined_[k] && afterThen[k];
+	}
+
+	// I temporanei creati dopo la copia non sono assegnati
+	void restore(std::vector<char> saved) {
+		saved.resize(names_.size(), 0);
+		defined_ = std::move(saved);
+	}
+
+	// I cicli interni vengono trattati per primi: i loro temporanei finiscono
+	// nel corpo del ciclo esterno e possono essere spostati di nuovo
+	void loop(whileStatement* w, std::vector<Statement*>& out) {
+		std::vector<char> entry = defined_;
+		w->block = block(w->block, false);
+		restore(entry);
+		entry.resize(names_.size(), 0);
+
+		Loop loop;
+		loop.assigned.assign(names_.size(), 0);
+		loop.modified.assign(names_.size(), 0);
+		for (Statement const* st : w->block) writes(st, loop);
+		loop.defined = std::move(entry);
+		Loop* outer = loop_;
+		loop_ = &loop;
+
+		// condizione e primi statement del corpo, nell'ordine di valutazione
+		loop.cond = true;
+		scan(w->condition, true);
+		loop.cond = false;
+		for (Statement* st : w->block) {
+			if (loop.blocked) break;
+			if (auto d = dynamic_cast<Definition*>(st)) {
+				scan(d->expression_, true);
+			}
+			else if (auto p = dynamic_cast<Print*>(st)) {
+				scan(p->expr_, true);
+				loop.blocked = true;
+			}
+			else if (auto a = dynamic_cast<listAppend*>(st)) {
+				scan(a->expr_, true);
+				loop.blocked = true;
+			}
+			else break;
+		}
+		// resto del ciclo: solo espressioni che non possono fallire
+		loop.blocked = true;
+		for (Statement* st : w->block) rest(st);
+		loop_ = outer;
+
+		std::vector<Statement*> guarded;
+		for (Hoisted const& h : loop.hoisted) {
+			Definition* d = program_.arena.make<Definition>(h.temp, h.value);
+			if (h.place == Place::BEFORE) {
+				out.push_back(d);
+				defined_[h.temp->slot_] = 1;
+			}
+			else {
+				guarded.push_back(d);
+			}
+		}
+		if (!guarded.empty()) {
+			ifStatement* guard = program_.arena.make<ifStatement>();
+			guard->condition = clone(w->condition);
+			guard->block = program_.arena.copy(guarded);
+			out.push_back(guard);
+		}
+		hoisted_ += loop.hoisted.size();
+	}
+
+	// Tutti gli statement del corpo (anche nei cicli interni), tranne le
+	// espressioni già esaminate
+	void rest(Statement* st) {
+		if (auto d = dynamic_cast<Definition*>(st)) scan(d->expression_, false);
+		else if (auto p = dynamic_cast<Print*>(st)) scan(p->expr_, false);
+		else if (auto a = dynamic_cast<listAppend*>(st)) scan(a->expr_, false);
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			scan(i->condition, false);
+			for (Statement* s : i->block) rest(s);
+			if (i->elifBlock != nullptr) rest(i->elifBlock);
+			for (Statement* s : i->elseBlock) rest(s);
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			scan(w->condition, false);
+			for (Statement* s : w->block) rest(s);
+		}
+	}
+
+	// Visita un'espressione nell'ordine di valutazione dell'interprete e
+	// sostituisce le sotto-espressioni invarianti massimali
+	void scan(Expression*& e, bool leading) {
+		Loop& loop = *loop_;
+		if (dynamic_cast<Constant*>(e) != nullptr) return;
+		if (auto v = dynamic_cast<Variable*>(e)) {
+			if (!loop.defined[v->slot_]) loop.blocked = true;
+			return;
+		}
+		if (invariant(e)) {
+			auto itr = loop.keys.find(key(e));
+			if (itr != loop.keys.end()) {
+				Hoisted const& h = loop.hoisted[itr->second];
+				// un temporaneo protetto esiste solo dentro il corpo
+				if (h.place == Place::BEFORE || !loop.cond) {
+					e = read(h.temp);
+					return;
+				}
+			}
+			else if (safe(e)) {
+				e = replace(e, Place::BEFORE);
+				return;
+			}
+			else if (leading && !loop.blocked) {
+				e = replace(e, loop.cond ? Place::BEFORE : Place::GUARDED);
+				return;
+			}
+		}
+
+		if (auto m = dynamic_cast<mathExpression*>(e)) {
+			scan(m->left_, leading);
+			scan(m->right_, leading);
+			if (m->opCode_ == Token::INTDIV && !constantDivisor(m)) loop.blocked = true;
+		}
+		else if (auto r = dynamic_cast<relExpression*>(e)) {
+			scan(r->left_, leading);
+			scan(r->right_, leading);
+		}
+		else if (auto u = dynamic_cast<unaryExpression*>(e)) {
+			scan(u->operand_, leading);
+		}
+		else if (auto a = dynamic_cast<andExpr*>(e)) {
+			scan(a->left_, leading);
+			// il destro può non essere valutato
+			loop.blocked = true;
+			scan(a->right_, leading);
+		}
+		else if (auto o = dynamic_cast<orExpr*>(e)) {
+			scan(o->left_, leading);
+			loop.blocked = true;
+			scan(o->right_, leading);
+		}
+		else if (auto l = dynamic_cast<listAccess*>(e)) {
+			scan(l->index_, leading);
+			loop.blocked = true;
+		}
+	}
+
+	Expression* replace(Expression* e, Place place) {
+		std::string name = "$licm" + std::to_string(names_.size());
+		Variable* temp = program_.arena.make<Variable>(program_.arena.copy(std::string_view{ name }));
+		temp->slot_ = static_cast<int>(names_.size());
+		names_.push_back(temp->id_);
+		defined_.push_back(0);
+		loop_->assigned.push_back(0);
+		loop_->modified.push_back(0);
+		loop_->defined.push_back(0);
+		loop_->keys.emplace(key(e), loop_->hoisted.size());
+		loop_->hoisted.push_back(Hoisted{ temp, e, place });
+		return read(temp);
+	}
+
+	Variable* read(Variable const* temp) {
+		Variable* v = program_.arena.make<Variable>(temp->id_);
+		v->slot_ = temp->slot_;
+		return v;
+	}
+
+	// Nessun operando cambia nel ciclo (e non è una semplice costante o variabile)
+	bool invariant(Expression const* e) const {
+		if (auto v = dynamic_cast<Variable const*>(e)) return !loop_->assigned[v->slot_];
+		if (dynamic_cast<Constant const*>(e) != nullptr) return true;
+		if (auto m = dynamic_cast<mathExpression const*>(e)) return invariant(m->left_) && invariant(m->right_);
+		if (auto r = dynamic_cast<relExpression const*>(e)) return invariant(r->left_) && invariant(r->right_);
+		if (auto a = dynamic_cast<andExpr const*>(e)) return invariant(a->left_) && invariant(a->right_);
+		if (auto o = dynamic_cast<orExpr const*>(e)) return invariant(o->left_) && invariant(o->right_);
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return invariant(u->operand_);
+		if (auto l = dynamic_cast<listAccess const*>(e)) return !loop_->modified[l->slot_] && invariant(l->index_);
+		return false;
+	}
+
+	// Non può fallire (né produrre l'errore di identificatore non dichiarato)
+	bool safe(Expression const* e) const {
+		if (auto v = dynamic_cast<Variable const*>(e)) return loop_->defined[v->slot_] != 0;
+		if (dynamic_cast<Constant const*>(e) != nullptr) return true;
+		if (auto m = dynamic_cast<mathExpression const*>(e)) {
+			if (m->opCode_ == Token::INTDIV && !constantDivisor(m)) return false;
+			return safe(m->left_) && safe(m->right_);
+		}
+		if (auto r = dynamic_cast<relExpression const*>(e)) return safe(r->left_) && safe(r->right_);
+		if (auto a = dynamic_cast<andExpr const*>(e)) return safe(a->left_) && safe(a->right_);
+		if (auto o = dynamic_cast<orExpr const*>(e)) return safe(o->left_) && safe(o->right_);
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return safe(u->operand_);
+		return false;
+	}
+
+	static bool constantDivisor(mathExpression const* m) {
+		auto c = dynamic_cast<Constant const*>(m->right_);
+		return c != nullptr && c->num_ != 0 && c->num_ != -1;
+	}
+
+	// Slot assegnati e liste modificate da uno statement
+	static void writes(Statement const* st, Loop& loop) {
+		if (auto d = dynamic_cast<Definition const*>(st)) loop.assigned[d->variable_->slot_] = 1;
+		else if (auto l = dynamic_cast<listInit const*>(st)) loop.modified[l->slot_] = 1;
+		else if (auto a = dynamic_cast<listAppend const*>(st)) loop.modified[a->slot_] = 1;
+		else if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			for (Statement const* s : i->block) writes(s, loop);
+			if (i->elifBlock != nullptr) writes(i->elifBlock, loop);
+			for (Statement const* s : i->elseBlock) writes(s, loop);
+		}
+		else if (auto w = dynamic_cast<whileStatement const*>(st)) {
+			for (Statement const* s : w->block) writes(s, loop);
+		}
+	}
+
+	// break/continue che escono dallo statement (non racchiusi in un while)
+	static bool escapes(Statement const* st) {
+		if (dynamic_cast<Break const*>(st) || dynamic_cast<Continue const*>(st)) return true;
+		if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			for (Statement const* s : i->block) if (escapes(s)) return true;
+			for (Statement const* s : i->elseBlock) if (escapes(s)) return true;
+			return i->elifBlock != nullptr && escapes(i->elifBlock);
+		}
+		return false;
+	}
+
+	// Chiave strutturale per riconoscere espressioni uguali
+	static std::string key(Expression const* e) {
+		if (auto v = dynamic_cast<Variable const*>(e)) return "v" + std::to_string(v->slot_);
+		if (auto c = dynamic_cast<Constant const*>(e)) return "c" + std::to_string(c->num_);
+		if (auto m = dynamic_cast<mathExpression const*>(e)) return "(m" + std::to_string(m->opCode_) + " " + key(m->left_) + " " + key(m->right_) + ")";
+		if (auto r = dynamic_cast<relExpression const*>(e)) return "(r" + std::to_string(r->opCode_) + " " + key(r->left_) + " " + key(r->right_) + ")";
+		if (auto a = dynamic_cast<andExpr const*>(e)) return "(and " + key(a->left_) + " " + key(a->right_) + ")";
+		if (auto o = dynamic_cast<orExpr const*>(e)) return "(or " + key(o->left_) + " " + key(o->right_) + ")";
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return "(u" + std::to_string(u->opCode_) + " " + key(u->operand_) + ")";
+		if (auto l = dynamic_cast<listAccess const*>(e)) return "(l" + std::to_string(l->slot_) + " " + key(l->index_) + ")";
+		return "?";
+	}
+
+	// Copia di un'espressione (la condizione usata dalla guardia)
+	Expression* clone(Expression const* e) {
+		Arena& arena = program_.arena;
+		if (auto v = dynamic_cast<Variable const*>(e)) return read(v);
+		if (auto c = dynamic_cast<Constant const*>(e)) return arena.make<Constant>(c->num_);
+		if (auto m = dynamic_cast<mathExpression const*>(e)) return arena.make<mathExpression>(m->opCode_, clone(m->left_), clone(m->right_));
+		if (auto r = dynamic_cast<relExpression const*>(e)) return arena.make<relExpression>(r->opCode_, clone(r->left_), clone(r->right_));
+		if (auto a = dynamic_cast<andExpr const*>(e)) return arena.make<andExpr>(clone(a->left_), clone(a->right_));
+		if (auto o = dynamic_cast<orExpr const*>(e)) return arena.make<orExpr>(clone(o->left_), clone(o->right_));
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return arena.make<unaryExpression>(u->opCode_, clone(u->operand_));
+		auto l = static_cast<listAccess const*>(e);
+		listAccess* copy = arena.make<listAccess>(l->id_, clone(l->index_));
+		copy->slot_ = l->slot_;
+		return copy;
+	}
+};
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+// Divisione intera per una costante con una moltiplicazione e uno shift
+// (Hacker's Delight, cap. 10): il quoziente è la parte alta di M * n,
+// corretta con n quando M e il divisore hanno segni diversi, spostata di
+// shift bit e arrotondata verso lo zero come `/` di C++.
+// Vale per ogni divisore tranne 0, 1 e -1.
+struct MagicDivisor {
+	int multiplier = 0;
+	int shift = 0;
+
+	static bool applicable(int d) {
+		return d != 0 && d != 1 && d != -1;
+	}
+
+	static MagicDivisor of(int d) {
+		const std::uint32_t two31 = 0x80000000u;
+		std::uint32_t ad = d < 0 ? 0u - static_cast<std::uint32_t>(d) : static_cast<std::uint32_t>(d);
+		std::uint32_t t = two31 + (static_cast<std::uint32_t>(d) >> 31);
+		std::uint32_t anc = t - 1 - t % ad;
+		int p = 31;
+		std::uint32_t q1 = two31 / anc, r1 = two31 - q1 * anc;
+		std::uint32_t q2 = two31 / ad, r2 = two31 - q2 * ad;
+		std::uint32_t delta;
+		do {
+			++p;
+			q1 *= 2; r1 *= 2;
+			if (r1 >= anc) { ++q1; r1 -= anc; }
+			q2 *= 2; r2 *= 2;
+			if (r2 >= ad) { ++q2; r2 -= ad; }
+			delta = ad - r2;
+		} while (q1 < delta || (q1 == delta && r1 == 0));
+		std::uint32_t m = q2 + 1;
+		if (d < 0) m = 0u - m;
+		return MagicDivisor{ static_cast<int>(m), p - 32 };
+	}
+
+	// n / d, con multiplier e shift calcolati da of(d)
+	static int divide(int n, int d, int multiplier, int shift) {
+		std::int64_t product = static_cast<std::int64_t>(multiplier) * n;
+		std::uint32_t q = static_cast<std::uint32_t>(static_cast<std::uint64_t>(product) >> 32);
+		if (d > 0 && multiplier < 0) q += static_cast<std::uint32_t>(n);
+		else if (d < 0 && multiplier > 0) q -= static_cast<std::uint32_t>(n);
+		std::int32_t s = static_cast<std::int32_t>(q) >> shift;
+		return static_cast<int>(static_cast<std::uint32_t>(s) + (static_cast<std::uint32_t>(s) >> 31));
+	}
+};
@@ -0,0 +1,225 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+#include "OutputSink.h"
+#include "SpscQueue.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+#define OUTPUT_SINK_ISATTY(file) isatty(fileno(file))
+#elif defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#define OUTPUT_SINK_ISATTY(file) _isatty(_fileno(file))
+#else
+#define OUTPUT_SINK_ISATTY(file) 0
+#endif
+
+OutputSink::Policy OutputSink::standard() {
+	return OUTPUT_SINK_ISATTY(stdout) ? Policy{ Flush::LINE, 1 } : Policy{ Flush::FULL, 1 };
+}
+
+bool OutputSink::parse(std::string_view text, Policy& policy) {
+	if (text == "exit") policy = Policy{ Flush::EXIT, 1 };
+	else if (text == "full") policy = Policy{ Flush::FULL, 1 };
+	else if (text == "line") policy = Policy{ Flush::LINE, 1 };
+	else {
+		std::size_t lines = 0;
+		auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), lines);
+		if (error != std::errc{} || end != text.data() + text.size() || lines == 0) return false;
+		policy = Policy{ Flush::LINES, lines };
+	}
+	return true;
+}
+
+bool OutputSink::parse(std::string_view text, Format& format) {
+	if (text == "32") format = Format::INT32;
+	else if (text == "64") format = Format::INT64;
+	else return false;
+	return true;
+}
+
+void OutputSink::binaryStdout() {
+#if defined(_WIN32)
+	_setmode(_fileno(stdout), _O_BINARY);
+#endif
+}
+
+bool OutputSink::decode(std::istream& in, std::ostream& out, Encoding encoding) {
+	std::size_t width = encoding.format == Format::INT32 ? 4 : 8;
+	std::vector<char> input(CAPACITY);
+	std::vector<char> text(CAPACITY / 4 * 21);     // al più 20 cifre e segno, più '\n', ogni 4 byte
+	std::size_t pending = 0;                        // byte letti e non ancora convertiti
+	std::size_t frame = 0;                          // valori rimasti nel blocco
+	for (;;) {
+		in.read(input.data() + pending, static_cast<std::streamsize>(input.size() - pending));
+		std::size_t size = pending + static_cast<std::size_t>(in.gcount());
+		if (size == pending && !in) return pending == 0 && frame == 0;
+		std::size_t at = 0;
+		char* last = text.data();
+		for (;;) {
+			if (encoding.frame != 0 && frame == 0) {
+				if (size - at < 4) break;
+				std::uint32_t count = 0;
+				for (std::size_t k = 0; k < 4; ++k) count |= static_cast<std::uint32_t>(static_cast<unsigned char>(input[at + k])) << (8 * k);
+				at += 4;
+				frame = count;
+				continue;
+			}
+			if (size - at < width) break;
+			std::uint64_t bits = 0;
+			for (std::size_t k = 0; k < width; ++k) bits |= static_cast<std::uint64_t>(static_cast<unsigned char>(input[at + k])) << (8 * k);
+			at += width;
+			std::int64_t value = width == 4 ? static_cast<std::int32_t>(static_cast<std::uint32_t>(bits)) : static_cast<std::int64_t>(bits);
+			last = std::to_chars(last, last + 20, value).ptr;
+			*last++ = '\n';
+			if (frame != 0) --frame;
+		}
+		out.write(text.data(), last - text.data());
+		pending = size - at;
+		std::memmove(input.data(), input.data() + at, pending);
+	}
+}
+
+// Thread di scrittura. I buffer girano in cerchio su due code SPSC: `full_`
+// (dal chiamante al thread) e `free_` (i buffer scritti tornano indietro).
+// Passarsi un buffer non prende lock; mutex e condition variable servono solo
+// a un thread che non ha nulla da fare per addormentarsi, e chi sveglia li
+// tocca solo se qualcuno dorme.
+class OutputSink::Writer {
+
+public:
+	static constexpr std::size_t BUFFERS = 8;
+
+	Writer(std::ostream& out, std::size_t capacity) : out_{ out } {
+		for (std::size_t k = 1; k < BUFFERS; ++k) free_.push(std::vector<char>(capacity));
+		thread_ = std::thread{ [this] { run(); } };
+	}
+
+	~Writer() {
+		drain();
+		stop_.store(true, std::memory_order_release);
+		wake();
+		thread_.join();
+	}
+
+	// Consegna i primi `used` byte di buffer e restituisce un buffer libero
+	std::vector<char> swap(std::vector<char> buffer, std::size_t used) {
+		full_.push(Block{ std::move(buffer), used });
+		++submitted_;
+		wake();
+		std::vector<char> next;
+		await([&] { return !free_.empty(); });
+		free_.pop(next);
+		return next;
+	}
+
+	// Aspetta che tutti i buffer consegnati siano stati scritti
+	void drain() {
+		await([&] { return written_.load(std::memory_order_acquire) == submitted_; });
+	}
+
+private:
+	struct Block {
+		std::vector<char> data;
+		std::size_t used = 0;
+	};
+
+	std::ostream& out_;
+	SpscQueue<Block, BUFFERS> full_;
+	SpscQueue<std::vector<char>, BUFFERS> free_;
+	std::size_t submitted_ = 0;                 // solo il chiamante
+	std::atomic<std::size_t> written_{ 0 };
+	std::atomic<bool> stop_{ false };
+	std::atomic<int> sleeping_{ 0 };
+	std::mutex mutex_;
+	std::condition_variable wakeup_;
+	std::thread thread_;
+
+	void run() {
+		for (;;) {
+			Block block;
+			if (!full_.pop(block)) {
+				if (stop_.load(std::memory_order_acquire)) return;
+				await([&] { return !full_.empty() || stop_.load(std::memory_order_acquire); });
+				continue;
+			}
+			out_.write(block.data.data(), static_cast<std::streamsize>(block.used));
+			out_.flush();
+			free_.push(std::move(block.data));
+			written_.fetch_add(1, std::memory_order_release);
+			wake();
+		}
+	}
+
+	// Chi dorme incrementa sleeping_ prima di controllare ready, chi sveglia
+	// lo legge con una read-modify-write dopo aver modificato le code: le due
+	// RMW sono ordinate, quindi o chi sveglia vede sleeping_ > 0, o la sua
+	// RMW viene prima e chi dorme vede le code modificate. Nessun risveglio
+	// si perde, senza fence (che ThreadSanitizer non sa controllare). Prima
+	// di dormire si riprova un po' (non su un solo core, dove toglierebbe il
+	// processore proprio all'altro thread)
+	template <typename Ready>
+	void await(Ready ready) {
+		static const int spins = std::thread::hardware_concurrency() > 1 ? 64 : 0;
+		for (int spin = 0; spin < spins; ++spin) {
+			if (ready()) return;
+			std::this_thread::yield();
+		}
+		std::unique_lock<std::mutex> lock{ mutex_ };
+		sleeping_.fetch_add(1, std::memory_order_seq_cst);
+		wakeup_.wait(lock, ready);
+		sleeping_.fetch_sub(1, std::memory_order_seq_cst);
+	}
+
+	void wake() {
+		if (sleeping_.fetch_add(0, std::memory_order_seq_cst) == 0) return;
+		std::lock_guard<std::mutex> lock{ mutex_ };
+		wakeup_.notify_all();
+	}
+};
+
+OutputSink::OutputSink(std::ostream& out, Policy policy, Encoding encoding, bool async, std::size_t capacity)
+	: out_{ out }, policy_{ policy }, encoding_{ encoding }, buffer_(capacity < MAX_RECORD ? MAX_RECORD : capacity) {
+	if (policy_.when == Flush::LINE) policy_ = Policy{ Flush::LINES, 1 };
+	if (policy_.lines == 0) policy_.lines = 1;
+	if (async) writer_ = std::make_unique<Writer>(out_, buffer_.size());
+}
+
+OutputSink::~OutputSink() {
+	flush();
+}
+
+void OutputSink::emit() {
+	std::size_t ready = framed_ != 0 ? header_ : used_;
+	std::size_t open = used_ - ready;
+	if (ready != 0) {
+		if (writer_ != nullptr) {
+			std::vector<char> frame(buffer_.begin() + ready, buffer_.begin() + used_);
+			buffer_ = writer_->swap(std::move(buffer_), ready);
+			if (buffer_.size() < open + MAX_RECORD) buffer_.resize(open + MAX_RECORD);
+			std::copy(frame.begin(), frame.end(), buffer_.begin());
+		}
+		else {
+			out_.write(buffer_.data(), static_cast<std::streamsize>(ready));
+			std::memmove(buffer_.data(), buffer_.data() + ready, open);
+		}
+	}
+	if (writer_ == nullptr) out_.flush();
+	header_ = 0;
+	used_ = open;
+	pending_ = 0;
+}
+
+void OutputSink::flush() {
+	if (framed_ != 0) close();
+	emit();
+	if (writer_ != nullptr) writer_->drain();
+}
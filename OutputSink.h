@@ -0,0 +1,131 @@
+#pragma once
+
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Uscita di print: i numeri vengono formattati con std::to_chars in un
+// buffer e passati allo stream a blocchi, invece di un operator<< seguito da
+// std::endl (e quindi da una write) per ogni riga. Il buffer viene svuotato
+// secondo la politica scelta, alla distruzione, e con flush() prima di ogni
+// messaggio su stderr, così uscita ed errori restano nell'ordine giusto.
+// In modalità asincrona i buffer pieni passano a un thread che li scrive e
+// li restituisce (vedi OutputSink.cpp): il chiamante si ferma solo se tutti i
+// buffer sono in scrittura, e flush() aspetta che siano stati scritti tutti.
+// Invece del testo si possono scrivere i valori in binario (little-endian a
+// 32 o 64 bit), anche a blocchi preceduti dal numero di valori (uint32);
+// decode() riconverte il formato binario in testo. Un blocco esce solo quando
+// è completo (o con flush()): le politiche di flush scrivono fino al blocco
+// aperto, che resta nel buffer, e il buffer cresce se il blocco non ci sta.
+class OutputSink {
+
+public:
+	enum class Flush {
+		EXIT,       // solo alla fine (o prima di un errore): il buffer cresce
+		FULL,       // quando il buffer è pieno
+		LINES,      // ogni `lines` righe (e quando il buffer è pieno)
+		LINE        // a ogni riga, come std::endl
+	};
+
+	struct Policy {
+		Flush when = Flush::FULL;
+		std::size_t lines = 1;
+	};
+
+	enum class Format { TEXT, INT32, INT64 };
+
+	struct Encoding {
+		Format format = Format::TEXT;
+		std::size_t frame = 0;      // valori per blocco; 0 senza blocchi
+	};
+
+	static constexpr std::size_t CAPACITY = std::size_t{ 1 } << 16;
+
+	OutputSink(std::ostream& out, Policy policy, Encoding encoding, bool async = false,
+		std::size_t capacity = CAPACITY);
+	~OutputSink();
+
+	OutputSink(OutputSink const&) = delete;
+	OutputSink& operator=(OutputSink const&) = delete;
+
+	// Riga a ogni print se stdout è un terminale, altrimenti a buffer pieno
+	static Policy standard();
+
+	// "exit", "full", "line" o un numero di righe; false se non è valida
+	static bool parse(std::string_view text, Policy& policy);
+
+	// "32" o "64"; false se non è valido
+	static bool parse(std::string_view text, Format& format);
+
+	// Converte in testo l'uscita binaria; false se è troncata
+	static bool decode(std::istream& in, std::ostream& out, Encoding encoding);
+
+	// Niente conversione dei fine riga su stdout (Windows)
+	static void binaryStdout();
+
+	void print(int value) {
+		if (buffer_.size() - used_ < MAX_RECORD) overflow();
+		char* first = buffer_.data() + used_;
+		if (encoding_.format == Format::TEXT) {
+			char* last = std::to_chars(first, first + MAX_RECORD, value).ptr;
+			*last++ = '\n';
+			used_ += static_cast<std::size_t>(last - first);
+		}
+		else {
+			if (encoding_.frame != 0 && framed_ == 0) {
+				header_ = used_;
+				used_ += 4;
+				first += 4;
+			}
+			if (encoding_.format == Format::INT32) little<4>(first, static_cast<std::uint32_t>(value));
+			else little<8>(first, static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+			used_ += encoding_.format == Format::INT32 ? 4 : 8;
+			if (encoding_.frame != 0 && ++framed_ == encoding_.frame) close();
+		}
+		if (policy_.when == Flush::LINES && ++pending_ >= policy_.lines) emit();
+	}
+
+	// Scrive tutto quello che è stato stampato, chiudendo il blocco aperto anche
+	// se incompleto (e aspetta il thread di scrittura)
+	void flush();
+
+private:
+	class Writer;
+
+	// "-2147483648\n", o intestazione del blocco e valore a 64 bit
+	static constexpr std::size_t MAX_RECORD = 12;
+
+	std::ostream& out_;
+	Policy policy_;
+	Encoding encoding_;
+	std::size_t header_ = 0;    // posizione nel buffer del contatore del blocco aperto
+	std::size_t framed_ = 0;    // valori nel blocco aperto
+	std::vector<char> buffer_;
+	std::size_t used_ = 0;
+	std::size_t pending_ = 0;   // righe dall'ultimo flush (Flush::LINES)
+	std::unique_ptr<Writer> writer_;
+
+	void overflow() {
+		if (policy_.when != Flush::EXIT) emit();
+		if (buffer_.size() - used_ < MAX_RECORD) buffer_.resize(buffer_.size() * 2);
+	}
+
+	// Passa il buffer allo stream (o al thread di scrittura), tranne il blocco
+	// aperto che viene spostato all'inizio del buffer
+	void emit();
+
+	// Chiude il blocco aperto scrivendo quanti valori contiene
+	void close() {
+		little<4>(buffer_.data() + header_, static_cast<std::uint32_t>(framed_));
+		framed_ = 0;
+	}
+
+	template <std::size_t Bytes, typename Unsigned>
+	static void little(char* out, Unsigned value) {
+		for (std::size_t k = 0; k < Bytes; ++k) out[k] = static_cast<char>(value >> (8 * k));
+	}
+};
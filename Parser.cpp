@@ -1,456 +1,513 @@
-#include <sstream>
-#include <iostream>
-
-#include "Parser.h"
-#include "Syntax.h"
-
-// Entrypoint
-Program* Parser::doParsing(std::vector<Token> const& tokenStream)
-{
-    auto itr = tokenStream.begin();
-    end_ = tokenStream.end();
-    Program* p = parseProgram(itr);
-    if (p->statements.size() == 0) {
-        throw SyntaxError{ "ERROR: empty program!" };
-    }
-    return p;
-}
-
-static void unexpectedTokenError(Token const& found, std::string const& expected) {
-    std::stringstream temp;
-    temp << "Unexpected token ERROR: " << found << ". Expected " << expected << " instead.";
-    throw SyntaxError{ temp.str() };
-}
-
-// Program
-Program* Parser::parseProgram(std::vector<Token>::const_iterator& itr) {
-    Program* p = new Program();
-
-	// Ciclo finch non sono alla fine o arrivo a ENDMARKER
-    while (itr != end_ && itr->tag != Token::ENDMARKER) {
-        Statement* s = parseStatement(itr);
-        p->statements.push_back(s);
-    }
-
-    if (itr == end_ || itr->tag != Token::ENDMARKER) {
-        throw SyntaxError{ "ERROR: Program must end with ENDMARKER" };
-    }
-
-    safe_next(itr); // Consumo ENDMARKER
-    return p;
-}
-
-// Statement che pu essere Compound (se c' if o while) o semplice
-Statement* Parser::parseStatement(std::vector<Token>::const_iterator& itr) {
-    
-    while (itr->tag == Token::NEWLINE) safe_next(itr); // salto le righe vuote
-
-    if (itr == end_ || itr->tag == Token::ENDMARKER) return nullptr;
-    if (itr->tag == Token::IF || itr->tag == Token::WHILE) {
-        return parseCompoundStatement(itr);
-    }
-    else {
-        return parseSimpleStatement(itr);
-    }
-}
-
-Statement* Parser::parseSimpleStatement(std::vector<Token>::const_iterator& itr) {
-    if (itr->tag == Token::ID) {
-        std::string id = itr->word;
-        safe_next(itr);
-        
-        // Inizializzazione lista
-        if (itr->tag == Token::EQ) {
-            safe_next(itr);
-            if (itr->tag == Token::LIST) { // id = list()
-                safe_next(itr); // consumo list
-                if (itr->tag != Token::LP) unexpectedTokenError(*itr, "'('");
-                safe_next(itr); // LP
-                if (itr->tag != Token::RP) unexpectedTokenError(*itr, "')'");
-                safe_next(itr); // RP
-                if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
-                    unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
-                if (itr->tag == Token::NEWLINE)
-                    safe_next(itr);
-                return new listInit(id);
-            }
-            else {
-                // Caso con id = <expr> newline
-                Expression* e = parseExpression(itr);
-                if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
-                    unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
-                if (itr->tag == Token::NEWLINE)
-                    safe_next(itr);
-				// Faccio return nuova Definition
-                return new Definition(new Variable(id), e);
-            }
-        }
-        else if (itr->tag == Token::DOT) {
-            // Caso <id>.append( <expr> ) newline
-            safe_next(itr);
-            if (itr->tag != Token::APPEND) unexpectedTokenError(*itr, "APPEND");
-            safe_next(itr); // consumo append
-            if (itr->tag != Token::LP) unexpectedTokenError(*itr, "'('");
-            safe_next(itr); // LP
-            Expression* e = parseExpression(itr);
-            if (itr->tag != Token::RP) unexpectedTokenError(*itr, "')'");
-            safe_next(itr); // RP
-            if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
-                unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
-            if (itr->tag == Token::NEWLINE)
-                safe_next(itr);
-            return new listAppend(id, e);
-        }
-        else {
-            unexpectedTokenError(*itr, "'= <expr> ', = list() or '.append(<expr>)'");
-        }
-    }
-    
-    // Caso BREAK newline
-    else if (itr->tag == Token::BREAK) {
-        safe_next(itr);
-        if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
-            unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
-        if (itr->tag == Token::NEWLINE)
-            safe_next(itr);
-        return new Break();
-    }
-
-    // Caso CONTINUE newline
-    else if (itr->tag == Token::CONTINUE) {
-        safe_next(itr);
-        if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
-            unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
-        if (itr->tag == Token::NEWLINE)
-            safe_next(itr);
-        return new Continue();
-    }
-	
-    // Caso PRINT ( <expr> ) newline
-    else if (itr->tag == Token::PRINT) {
-        safe_next(itr);
-        if (itr->tag != Token::LP) unexpectedTokenError(*itr, "'('");
-        safe_next(itr); // LP
-        Expression* e = parseExpression(itr);
-        if (itr->tag != Token::RP) unexpectedTokenError(*itr, "')'");
-        safe_next(itr); // RP
-        if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
-            unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
-        if (itr->tag == Token::NEWLINE)
-            safe_next(itr);
-        return new Print(e);
-    }
-    else {
-        // Altrimenti errore
-        unexpectedTokenError(*itr, "ID, break, continue or print");
-        return nullptr;
-    }
-}
-
-
-Statement* Parser::parseCompoundStatement(std::vector<Token>::const_iterator& itr)
-{
-    // Compound statement iniziano con IF / WHILE
-    if (itr->tag == Token::IF)
-        return parseIfStatement(itr);
-
-    else if (itr->tag == Token::WHILE)
-		return parseWhileStatement(itr);
-}
-
-ifStatement* Parser::parseIfStatement(std::vector<Token>::const_iterator& itr) {
-    ifStatement* ifSt = new ifStatement;
-    safe_next(itr); // consumo IF/ELIF
-
-    ifSt->condition = parseExpression(itr);
-
-    if (itr == end_ || itr->tag != Token::COLON) unexpectedTokenError(*itr, "COLON");
-    safe_next(itr);
-    if (itr == end_ || itr->tag != Token::NEWLINE) unexpectedTokenError(*itr, "NEWLINE");
-    safe_next(itr);
-    if (itr == end_ || itr->tag != Token::INDENT) unexpectedTokenError(*itr, "INDENT");
-    safe_next(itr);
-
-    while (itr != end_ && itr->tag != Token::DEDENT) {
-        while (itr->tag == Token::NEWLINE) safe_next(itr);
-        if (itr->tag == Token::DEDENT) break;
-        Statement* st = parseStatement(itr);
-        if (!st) break;
-        ifSt->block.push_back(st);
-    }
-
-    if (itr == end_) unexpectedTokenError(*itr, "DEDENT");
-    safe_next(itr); // consumo DEDENT
-
-    // Gestione ELIF
-    if (itr != end_ && itr->tag == Token::ELIF) {
-        ifSt->elifBlock = parseIfStatement(itr);
-    }
-    // Gestione ELSE
-    else if (itr != end_ && itr->tag == Token::ELSE) {
-        safe_next(itr);
-        if (itr == end_ || itr->tag != Token::COLON) unexpectedTokenError(*itr, "COLON");
-        safe_next(itr);
-        if (itr == end_ || itr->tag != Token::NEWLINE) unexpectedTokenError(*itr, "NEWLINE");
-        safe_next(itr);
-        if (itr == end_ || itr->tag != Token::INDENT) unexpectedTokenError(*itr, "INDENT");
-        safe_next(itr);
-
-        while (itr != end_ && itr->tag != Token::DEDENT) {
-            while (itr->tag == Token::NEWLINE) safe_next(itr);
-            if (itr->tag == Token::DEDENT) break;
-            Statement* st = parseStatement(itr);
-            if (!st) break;
-            ifSt->elseBlock.push_back(st);
-        }
-
-        if (itr == end_) unexpectedTokenError(*itr, "DEDENT");
-        safe_next(itr); // consumo DEDENT
-    }
-
-    return ifSt;
-}
-
-
-whileStatement* Parser::parseWhileStatement(std::vector<Token>::const_iterator& itr) {
-    // I blocchi WHILE sono formati da - while <expr> : NEWLINE INDENT <statements> DEDENT
-    whileStatement* whileSt = new whileStatement;
-    safe_next(itr);
-    whileSt->condition = parseExpression(itr);
-
-    if (itr->tag != Token::COLON) 
-        unexpectedTokenError(*itr, ":");
-    safe_next(itr);
-    if (itr->tag != Token::NEWLINE)
-        unexpectedTokenError(*itr, "NEWLINE");
-    safe_next(itr);
-    if (itr->tag != Token::INDENT)
-        unexpectedTokenError(*itr, "INDENT");
-
-    safe_next(itr);
-
-    while (itr->tag != Token::DEDENT) {
-
-        // Skippo linee vuote
-        if (itr->tag == Token::NEWLINE) {
-            safe_next(itr);
-            continue;
-        }
-
-        Statement* st = parseStatement(itr);
-        whileSt->block.push_back(st);
-    }
-    // Consumo DEDENT
-    safe_next(itr);
-    return whileSt;
-}
-
-
-// Definzione
-Definition* Parser::parseDefinition(std::vector<Token>::const_iterator& itr) {
-    Variable* v = parseVariable(itr);
-    if (itr->tag != Token::EQ) {
-		unexpectedTokenError(*itr, "EQ");
-    }
-    safe_next(itr);
-    Expression* e = parseExpression(itr);
-
-    // Dopo l'espressione consumo il NEWLINE
-    if (itr->tag != Token::NEWLINE) {
-        unexpectedTokenError(*itr, "NEWLINE");
-    }
-    safe_next(itr);
-
-    return new Definition{ v, e };
-}
-
-Expression* Parser::parseExpression(std::vector<Token>::const_iterator& itr) {
-    // Caso <join>
-    Expression* left = parseJoin(itr);
-
-    // Ciclo finch trovo loperatore OR
-    while (itr->tag == Token::OR) {
-        safe_next(itr); // consumo token OR
-        Expression* right = parseJoin(itr);
-        left = new orExpr(left, right);
-    }
-
-    return left;
-}
-
-Expression* Parser::parseJoin(std::vector<Token>::const_iterator& itr) {
-    // Parso il primo equality
-    Expression* left = parseEquality(itr);
-
-    // Finch trovo AND faccio AndExpr
-    while (itr != end_ && itr->tag == Token::AND) {
-        int op = itr->tag;
-        safe_next(itr); // consumo token AND
-        Expression* right = parseEquality(itr);
-        left = new andExpr(left, right);
-    }
-
-    return left;
-}
-
-Expression* Parser::parseEquality(std::vector<Token>::const_iterator& itr) {
-    // Parso il primo operatore relazionale
-    Expression* left = parseRel(itr);
-
-    // Finch trovo == oppure != faccio RelExpression
-    while (itr != end_ && (itr->tag == Token::EQEQ || itr->tag == Token::NEQ)) {
-        int op = itr->tag;
-        safe_next(itr); // consumo l'operatore
-        Expression* right = parseRel(itr);
-        left = new relExpression(op, left, right);
-    }
-
-    return left;
-}
-
-Expression* Parser::parseRel(std::vector<Token>::const_iterator& itr) {
-	// Parso il primo numExpr
-    Expression* left = parseNumExpr(itr);
-
-	// Finch trovo <, <=, >, >= faccio RelExpression
-    while (itr != end_ &&
-        (itr->tag == Token::LT || itr->tag == Token::LTE ||
-            itr->tag == Token::GT || itr->tag == Token::GTE)) {
-        int op = itr->tag;
-		safe_next(itr); // consumo l'operatore
-        Expression* right = parseNumExpr(itr);
-        left = new relExpression(op, left, right);
-    }
-
-    return left;
-}
-
-Expression* Parser::parseNumExpr(std::vector<Token>::const_iterator& itr) {
-    // Parso il primo term
-    Expression* left = parseTerm(itr);
-
-    // Finch trovo + oppure - faccio mathExpression
-    while (itr != end_ && (itr->tag == Token::ADD || itr->tag == Token::SUB)) {
-        int op = itr->tag;
-        safe_next(itr); // consumo l'operatore
-        Expression* right = parseTerm(itr);
-        left = new mathExpression(op, left, right);
-    }
-
-    return left;
-}
-
-Expression* Parser::parseTerm(std::vector<Token>::const_iterator& itr) {
-    // Parso il primo unary
-    Expression* left = parseUnary(itr);
-
-	// Finch trovo * oppure // faccio mathExpression
-    while (itr != end_ && (itr->tag == Token::MUL || itr->tag == Token::INTDIV)) {
-        int op = itr->tag;
-        safe_next(itr); // consumo l'operatore
-        Expression* right = parseUnary(itr);
-        left = new mathExpression(op, left, right);
-    }
-
-    return left;
-}
-
-Expression* Parser::parseUnary(std::vector<Token>::const_iterator& itr) {
-    if (itr == end_) {
-        throw SyntaxError{ "Unexpected end of input in unary expression" };
-    }
-
-	// Caso con NOT <unary> | - <unary>
-    if (itr->tag == Token::NOT || itr->tag == Token::SUB) {
-        int op = itr->tag;
-        safe_next(itr); // consumo l'operatore
-
-        Expression* expr = parseUnary(itr);
-        return new unaryExpression(op, expr);
-    }
-
-    // Caso con <factor>
-    return parseFactor(itr);
-}
-
-Expression* Parser::parseFactor(std::vector<Token>::const_iterator& itr) {
-    if (itr == end_) {
-        throw SyntaxError{ "Unexpected end of input in factor" };
-    }
-
-    if (itr->tag == Token::LP) {
-        // Caso ( <expr> )
-        safe_next(itr); // consumo "("
-        Expression* expr = parseExpression(itr);
-
-        if (itr == end_ || itr->tag != Token::RP) {
-            unexpectedTokenError(*itr, ")");
-        }
-        safe_next(itr); // consumo ")"
-        return expr;
-    }
-    else if (itr->tag == Token::ID) {
-        // Caso con <loc> (che a sua volta pu essere id o id[ <expr> ] -> chiamo parseLoc)
-        return parseLoc(itr);
-    }
-	// Caso con num (CONST)
-    else if (itr->tag == Token::CONST) {
-        return parseConstant(itr);
-    }
-    // Caso con True o False
-    else if (itr->tag == Token::TRUE || itr->tag == Token::FALSE) {
-        bool value = (itr->tag == Token::TRUE);
-        safe_next(itr);
-        return new Constant(value ? 1 : 0); // valori booleani, metto 1 oppure 0 per TRUE || FALSE
-    }
-    else {
-        // Altro -> errore
-        unexpectedTokenError(*itr, "ID, CONST, True, False or '('");
-        return nullptr;
-    }
-}
-
-Expression* Parser::parseLoc(std::vector<Token>::const_iterator& itr) {
-    // <loc> deve iniziare con un ID per definizione altrimenti errore
-    if (itr->tag != Token::ID) {
-        unexpectedTokenError(*itr, "ID");
-    }
-
-    std::string varName = itr->word;
-    safe_next(itr);
-
-    // Caso con id[ <expr> ] -> listAccess
-    if (itr != end_ && itr->tag == Token::LBRACK) {
-        safe_next(itr); // consumo "["
-        Expression* index = parseExpression(itr);
-
-        if (itr == end_ || itr->tag != Token::RBRACK) {
-            unexpectedTokenError(*itr, "]");
-        }
-        safe_next(itr); // consumo "]"
-
-		// Faccio listAccess con varName e index
-        return new listAccess(varName, index);
-    }
-
-	// Altrimenti ho solo che <loc>  un id
-    return new Variable(varName);
-}
-
-
-// Variabili e costanti
-Variable* Parser::parseVariable(std::vector<Token>::const_iterator& itr) {
-    Variable* v = new Variable{ itr->word };
-    safe_next(itr);
-    return v;
-}
-
-Constant* Parser::parseConstant(std::vector<Token>::const_iterator& itr) {
-    std::stringstream temp;
-    temp << itr->word;
-    int num;
-    temp >> num;
-    Constant* c = new Constant{ num };
-    safe_next(itr);
-    return c;
+#include <sstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Parser.h"
+#include "Syntax.h"
+
+// Entrypoint
+Program* Parser::doParsing(TokenStream const& tokenStream)
+{
+    TokenStreamSource source{ tokenStream };
+    return doParsing(source);
+}
+
+Program* Parser::doParsing(TokenSource& tokenSource)
+{
+    tokens_ = &tokenSource;
+    names_.clear();
+    TokenCursor itr{ tokenSource };
+    // In caso di errore il programma (e con lui l'arena) viene liberato
+    std::unique_ptr<Program> p{ parseProgram(itr) };
+    if (p->statements.size() == 0) {
+        throw SyntaxError{ "ERROR: empty program!" };
+    }
+    return p.release();
+}
+
+void Parser::doParsing(TokenSource& tokenSource, Arena& names, std::function<void(Program&)> const& run)
+{
+    tokens_ = &tokenSource;
+    names_.clear();
+    nameArena_ = &names;
+    TokenCursor itr{ tokenSource };
+    bool empty = true;
+    while (!itr.atEnd() && itr->tag != Token::ENDMARKER) {
+        Program p;
+        arena_ = &p.arena;
+        Statement* s = parseStatement(itr);
+        arena_ = nullptr;
+        // nullptr se dopo l'ultimo statement ci sono solo righe vuote
+        if (s == nullptr) continue;
+        p.statements = p.arena.copy(std::vector<Statement*>{ s });
+        empty = false;
+        run(p);
+    }
+
+    if (itr.atEnd() || itr->tag != Token::ENDMARKER) {
+        throw SyntaxError{ "ERROR: Program must end with ENDMARKER" };
+    }
+    safe_next(itr); // Consumo ENDMARKER
+    if (empty) {
+        throw SyntaxError{ "ERROR: empty program!" };
+    }
+}
+
+std::string_view Parser::name(Token const& t) {
+    // Ogni simbolo viene copiato nell'arena una volta sola
+    std::size_t id = static_cast<std::size_t>(t.value);
+    if (names_.size() <= id) names_.resize(id + 1);
+    if (names_[id].data() == nullptr) names_[id] = nameArena_->copy(tokens_->symbols().name(t.value));
+    return names_[id];
+}
+
+void Parser::unexpectedTokenError(Token const& found, std::string const& expected) const {
+    std::stringstream temp;
+    auto [line, column] = tokens_->location(found);
+    temp << "Unexpected token ERROR: ";
+    printToken(temp, found, tokens_->word(found));
+    temp << " at line " << line << ", column " << column << ". Expected " << expected << " instead.";
+    throw SyntaxError{ temp.str() };
+}
+
+// Program
+Program* Parser::parseProgram(TokenCursor& itr) {
+    std::unique_ptr<Program> p = std::make_unique<Program>();
+    arena_ = &p->arena;
+    nameArena_ = &p->arena;
+    std::vector<Statement*> statements;
+
+	// Ciclo finché non sono alla fine o arrivo a ENDMARKER
+    while (!itr.atEnd() && itr->tag != Token::ENDMARKER) {
+        Statement* s = parseStatement(itr);
+        // nullptr se dopo l'ultimo statement ci sono solo righe vuote
+        if (s) statements.push_back(s);
+    }
+
+    if (itr.atEnd() || itr->tag != Token::ENDMARKER) {
+        throw SyntaxError{ "ERROR: Program must end with ENDMARKER" };
+    }
+
+    safe_next(itr); // Consumo ENDMARKER
+    p->statements = arena_->copy(statements);
+    return p.release();
+}
+
+// Statement che può essere Compound (se c'è if o while) o semplice
+Statement* Parser::parseStatement(TokenCursor& itr) {
+    
+    while (itr->tag == Token::NEWLINE) safe_next(itr); // salto le righe vuote
+
+    if (itr.atEnd() || itr->tag == Token::ENDMARKER) return nullptr;
+    if (itr->tag == Token::IF || itr->tag == Token::WHILE) {
+        return parseCompoundStatement(itr);
+    }
+    else {
+        return parseSimpleStatement(itr);
+    }
+}
+
+Statement* Parser::parseSimpleStatement(TokenCursor& itr) {
+    if (itr->tag == Token::ID) {
+        std::string_view id = name(*itr);
+        safe_next(itr);
+        
+        // Inizializzazione lista
+        if (itr->tag == Token::EQ) {
+            safe_next(itr);
+            if (itr->tag == Token::LIST) { // id = list()
+                safe_next(itr); // consumo list
+                if (itr->tag != Token::LP) unexpectedTokenError(*itr, "'('");
+                safe_next(itr); // LP
+                if (itr->tag != Token::RP) unexpectedTokenError(*itr, "')'");
+                safe_next(itr); // RP
+                if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
+                    unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
+                if (itr->tag == Token::NEWLINE)
+                    safe_next(itr);
+                return arena_->make<listInit>(id);
+            }
+            else {
+                // Caso con id = <expr> newline
+                Expression* e = parseExpression(itr);
+                if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
+                    unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
+                if (itr->tag == Token::NEWLINE)
+                    safe_next(itr);
+				// Faccio return nuova Definition
+                return arena_->make<Definition>(arena_->make<Variable>(id), e);
+            }
+        }
+        else if (itr->tag == Token::DOT) {
+            // Caso <id>.append( <expr> ) newline
+            safe_next(itr);
+            if (itr->tag != Token::APPEND) unexpectedTokenError(*itr, "APPEND");
+            safe_next(itr); // consumo append
+            if (itr->tag != Token::LP) unexpectedTokenError(*itr, "'('");
+            safe_next(itr); // LP
+            Expression* e = parseExpression(itr);
+            if (itr->tag != Token::RP) unexpectedTokenError(*itr, "')'");
+            safe_next(itr); // RP
+            if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
+                unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
+            if (itr->tag == Token::NEWLINE)
+                safe_next(itr);
+            return arena_->make<listAppend>(id, e);
+        }
+        else {
+            unexpectedTokenError(*itr, "'= <expr> ', = list() or '.append(<expr>)'");
+        }
+    }
+    
+    // Caso BREAK newline
+    else if (itr->tag == Token::BREAK) {
+        safe_next(itr);
+        if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
+            unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
+        if (itr->tag == Token::NEWLINE)
+            safe_next(itr);
+        return arena_->make<Break>();
+    }
+
+    // Caso CONTINUE newline
+    else if (itr->tag == Token::CONTINUE) {
+        safe_next(itr);
+        if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
+            unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
+        if (itr->tag == Token::NEWLINE)
+            safe_next(itr);
+        return arena_->make<Continue>();
+    }
+	
+    // Caso PRINT ( <expr> ) newline
+    else if (itr->tag == Token::PRINT) {
+        safe_next(itr);
+        if (itr->tag != Token::LP) unexpectedTokenError(*itr, "'('");
+        safe_next(itr); // LP
+        Expression* e = parseExpression(itr);
+        if (itr->tag != Token::RP) unexpectedTokenError(*itr, "')'");
+        safe_next(itr); // RP
+        if (itr->tag != Token::NEWLINE && itr->tag != Token::ENDMARKER && itr->tag != Token::DEDENT)
+            unexpectedTokenError(*itr, "NEWLINE, DEDENT or ENDMARKER");
+        if (itr->tag == Token::NEWLINE)
+            safe_next(itr);
+        return arena_->make<Print>(e);
+    }
+    else {
+        // Altrimenti errore
+        unexpectedTokenError(*itr, "ID, break, continue or print");
+        return nullptr;
+    }
+}
+
+
+Statement* Parser::parseCompoundStatement(TokenCursor& itr)
+{
+    // Compound statement iniziano con IF / WHILE
+    if (itr->tag == Token::IF)
+        return parseIfStatement(itr);
+
+    else if (itr->tag == Token::WHILE)
+		return parseWhileStatement(itr);
+}
+
+ifStatement* Parser::parseIfStatement(TokenCursor& itr) {
+    ifStatement* ifSt = arena_->make<ifStatement>();
+    std::vector<Statement*> block;
+    safe_next(itr); // consumo IF/ELIF
+
+    ifSt->condition = parseExpression(itr);
+
+    if (itr.atEnd() || itr->tag != Token::COLON) unexpectedTokenError(*itr, "COLON");
+    safe_next(itr);
+    if (itr.atEnd() || itr->tag != Token::NEWLINE) unexpectedTokenError(*itr, "NEWLINE");
+    safe_next(itr);
+    if (itr.atEnd() || itr->tag != Token::INDENT) unexpectedTokenError(*itr, "INDENT");
+    safe_next(itr);
+
+    while (!itr.atEnd() && itr->tag != Token::DEDENT) {
+        while (itr->tag == Token::NEWLINE) safe_next(itr);
+        if (itr->tag == Token::DEDENT) break;
+        Statement* st = parseStatement(itr);
+        if (!st) break;
+        block.push_back(st);
+    }
+    ifSt->block = arena_->copy(block);
+
+    if (itr.atEnd()) unexpectedTokenError(*itr, "DEDENT");
+    safe_next(itr); // consumo DEDENT
+
+    // Gestione ELIF
+    if (!itr.atEnd() && itr->tag == Token::ELIF) {
+        ifSt->elifBlock = parseIfStatement(itr);
+    }
+    // Gestione ELSE
+    else if (!itr.atEnd() && itr->tag == Token::ELSE) {
+        safe_next(itr);
+        if (itr.atEnd() || itr->tag != Token::COLON) unexpectedTokenError(*itr, "COLON");
+        safe_next(itr);
+        if (itr.atEnd() || itr->tag != Token::NEWLINE) unexpectedTokenError(*itr, "NEWLINE");
+        safe_next(itr);
+        if (itr.atEnd() || itr->tag != Token::INDENT) unexpectedTokenError(*itr, "INDENT");
+        safe_next(itr);
+
+        std::vector<Statement*> elseBlock;
+        while (!itr.atEnd() && itr->tag != Token::DEDENT) {
+            while (itr->tag == Token::NEWLINE) safe_next(itr);
+            if (itr->tag == Token::DEDENT) break;
+            Statement* st = parseStatement(itr);
+            if (!st) break;
+            elseBlock.push_back(st);
+        }
+        ifSt->elseBlock = arena_->copy(elseBlock);
+
+        if (itr.atEnd()) unexpectedTokenError(*itr, "DEDENT");
+        safe_next(itr); // consumo DEDENT
+    }
+
+    return ifSt;
+}
+
+
+whileStatement* Parser::parseWhileStatement(TokenCursor& itr) {
+    // I blocchi WHILE sono formati da - while <expr> : NEWLINE INDENT <statements> DEDENT
+    whileStatement* whileSt = arena_->make<whileStatement>();
+    std::vector<Statement*> block;
+    safe_next(itr);
+    whileSt->condition = parseExpression(itr);
+
+    if (itr->tag != Token::COLON) 
+        unexpectedTokenError(*itr, ":");
+    safe_next(itr);
+    if (itr->tag != Token::NEWLINE)
+        unexpectedTokenError(*itr, "NEWLINE");
+    safe_next(itr);
+    if (itr->tag != Token::INDENT)
+        unexpectedTokenError(*itr, "INDENT");
+
+    safe_next(itr);
+
+    while (itr->tag != Token::DEDENT) {
+
+        // Skippo linee vuote
+        if (itr->tag == Token::NEWLINE) {
+            safe_next(itr);
+            continue;
+        }
+
+        Statement* st = parseStatement(itr);
+        block.push_back(st);
+    }
+    whileSt->block = arena_->copy(block);
+    // Consumo DEDENT
+    safe_next(itr);
+    return whileSt;
+}
+
+
+// Definzione
+Definition* Parser::parseDefinition(TokenCursor& itr) {
+    Variable* v = parseVariable(itr);
+    if (itr->tag != Token::EQ) {
+		unexpectedTokenError(*itr, "EQ");
+    }
+    safe_next(itr);
+    Expression* e = parseExpression(itr);
+
+    // Dopo l'espressione consumo il NEWLINE
+    if (itr->tag != Token::NEWLINE) {
+        unexpectedTokenError(*itr, "NEWLINE");
+    }
+    safe_next(itr);
+
+    return arena_->make<Definition>(v, e);
+}
+
+Expression* Parser::parseExpression(TokenCursor& itr) {
+    // Caso <join>
+    Expression* left = parseJoin(itr);
+
+    // Ciclo finché trovo loperatore OR
+    while (itr->tag == Token::OR) {
+        safe_next(itr); // consumo token OR
+        Expression* right = parseJoin(itr);
+        left = arena_->make<orExpr>(left, right);
+    }
+
+    return left;
+}
+
+Expression* Parser::parseJoin(TokenCursor& itr) {
+    // Parso il primo equality
+    Expression* left = parseEquality(itr);
+
+    // Finché trovo AND faccio AndExpr
+    while (!itr.atEnd() && itr->tag == Token::AND) {
+        int op = itr->tag;
+        safe_next(itr); // consumo token AND
+        Expression* right = parseEquality(itr);
+        left = arena_->make<andExpr>(left, right);
+    }
+
+    return left;
+}
+
+Expression* Parser::parseEquality(TokenCursor& itr) {
+    // Parso il primo operatore relazionale
+    Expression* left = parseRel(itr);
+
+    // Finché trovo == oppure != faccio RelExpression
+    while (!itr.atEnd() && (itr->tag == Token::EQEQ || itr->tag == Token::NEQ)) {
+        int op = itr->tag;
+        safe_next(itr); // consumo l'operatore
+        Expression* right = parseRel(itr);
+        left = arena_->make<relExpression>(op, left, right);
+    }
+
+    return left;
+}
+
+Expression* Parser::parseRel(TokenCursor& itr) {
+	// Parso il primo numExpr
+    Expression* left = parseNumExpr(itr);
+
+	// Finché trovo <, <=, >, >= faccio RelExpression
+    while (!itr.atEnd() &&
+        (itr->tag == Token::LT || itr->tag == Token::LTE ||
+            itr->tag == Token::GT || itr->tag == Token::GTE)) {
+        int op = itr->tag;
+		safe_next(itr); // consumo l'operatore
+        Expression* right = parseNumExpr(itr);
+        left = arena_->make<relExpression>(op, left, right);
+    }
+
+    return left;
+}
+
+Expression* Parser::parseNumExpr(TokenCursor& itr) {
+    // Parso il primo term
+    Expression* left = parseTerm(itr);
+
+    // Finché trovo + oppure - faccio mathExpression
+    while (!itr.atEnd() && (itr->tag == Token::ADD || itr->tag == Token::SUB)) {
+        int op = itr->tag;
+        safe_next(itr); // consumo l'operatore
+        Expression* right = parseTerm(itr);
+        left = arena_->make<mathExpression>(op, left, right);
+    }
+
+    return left;
+}
+
+Expression* Parser::parseTerm(TokenCursor& itr) {
+    // Parso il primo unary
+    Expression* left = parseUnary(itr);
+
+	// Finché trovo * oppure // faccio mathExpression
+    while (!itr.atEnd() && (itr->tag == Token::MUL || itr->tag == Token::INTDIV)) {
+        int op = itr->tag;
+        safe_next(itr); // consumo l'operatore
+        Expression* right = parseUnary(itr);
+        left = arena_->make<mathExpression>(op, left, right);
+    }
+
+    return left;
+}
+
+Expression* Parser::parseUnary(TokenCursor& itr) {
+    if (itr.atEnd()) {
+        throw SyntaxError{ "Unexpected end of input in unary expression" };
+    }
+
+	// Caso con NOT <unary> | - <unary>
+    if (itr->tag == Token::NOT || itr->tag == Token::SUB) {
+        int op = itr->tag;
+        safe_next(itr); // consumo l'operatore
+
+        Expression* expr = parseUnary(itr);
+        return arena_->make<unaryExpression>(op, expr);
+    }
+
+    // Caso con <factor>
+    return parseFactor(itr);
+}
+
+Expression* Parser::parseFactor(TokenCursor& itr) {
+    if (itr.atEnd()) {
+        throw SyntaxError{ "Unexpected end of input in factor" };
+    }
+
+    if (itr->tag == Token::LP) {
+        // Caso ( <expr> )
+        safe_next(itr); // consumo "("
+        Expression* expr = parseExpression(itr);
+
+        if (itr.atEnd() || itr->tag != Token::RP) {
+            unexpectedTokenError(*itr, ")");
+        }
+        safe_next(itr); // consumo ")"
+        return expr;
+    }
+    else if (itr->tag == Token::ID) {
+        // Caso con <loc> (che a sua volta può essere id o id[ <expr> ] -> chiamo parseLoc)
+        return parseLoc(itr);
+    }
+	// Caso con num (CONST)
+    else if (itr->tag == Token::CONST) {
+        return parseConstant(itr);
+    }
+    // Caso con True o False
+    else if (itr->tag == Token::TRUE || itr->tag == Token::FALSE) {
+        bool value = (itr->tag == Token::TRUE);
+        safe_next(itr);
+        return arena_->make<Constant>(value ? 1 : 0); // valori booleani, metto 1 oppure 0 per TRUE || FALSE
+    }
+    else {
+        // Altro -> errore
+        unexpectedTokenError(*itr, "ID, CONST, True, False or '('");
+        return nullptr;
+    }
+}
+
+Expression* Parser::parseLoc(TokenCursor& itr) {
+    // <loc> deve iniziare con un ID per definizione altrimenti errore
+    if (itr->tag != Token::ID) {
+        unexpectedTokenError(*itr, "ID");
+    }
+
+    std::string_view varName = name(*itr);
+    safe_next(itr);
+
+    // Caso con id[ <expr> ] -> listAccess
+    if (!itr.atEnd() && itr->tag == Token::LBRACK) {
+        safe_next(itr); // consumo "["
+        Expression* index = parseExpression(itr);
+
+        if (itr.atEnd() || itr->tag != Token::RBRACK) {
+            unexpectedTokenError(*itr, "]");
+        }
+        safe_next(itr); // consumo "]"
+
+		// Faccio listAccess con varName e index
+        return arena_->make<listAccess>(varName, index);
+    }
+
+	// Altrimenti ho solo che <loc> è un id
+    return arena_->make<Variable>(varName);
+}
+
+
+// Variabili e costanti
+Variable* Parser::parseVariable(TokenCursor& itr) {
+    Variable* v = arena_->make<Variable>(name(*itr));
+    safe_next(itr);
+    return v;
+}
+
+Constant* Parser::parseConstant(TokenCursor& itr) {
+    // Il valore è già stato convertito dal Lexer
+    Constant* c = arena_->make<Constant>(itr->value);
+    safe_next(itr);
+    return c;
 }
\ No newline at end of file
@@ -1,59 +1,75 @@
-#pragma once
-
-#include <vector>
-
-#include "Token.h"
-#include "Syntax.h"
-#include "Exception.h"
-
-class Parser {
-
-public:
-	Parser() = default;
-	~Parser() = default;
-	Parser(const Parser&) = delete;
-	Parser& operator=(const Parser&) = delete;
-
-	Program* doParsing(std::vector<Token> const& tokenStream);
-
-private:
-	std::vector<Token>::const_iterator end_;
-
-	// Parse per program
-	Program* parseProgram(std::vector<Token>::const_iterator& itr);
-
-	// Parse per statement
-	Statement* parseStatement(std::vector<Token>::const_iterator& itr);
-	Statement* parseSimpleStatement(std::vector<Token>::const_iterator& itr);
-	Statement* parseCompoundStatement(std::vector<Token>::const_iterator& itr);
-
-	// Parse per if e while
-	ifStatement* parseIfStatement(std::vector<Token>::const_iterator& itr);
-	whileStatement* parseWhileStatement(std::vector<Token>::const_iterator& itr);
-
-	// Parse per espressioni
-	Expression* parseExpression(std::vector<Token>::const_iterator& itr);
-	Expression* parseJoin(std::vector<Token>::const_iterator& itr);
-	Expression* parseEquality(std::vector<Token>::const_iterator& itr);
-	Expression* parseRel(std::vector<Token>::const_iterator& itr);
-	Expression* parseNumExpr(std::vector<Token>::const_iterator& itr);
-	Expression* parseTerm(std::vector<Token>::const_iterator& itr);
-	Expression* parseUnary(std::vector<Token>::const_iterator& itr);
-	Expression* parseFactor(std::vector<Token>::const_iterator& itr);
-	Expression* parseLoc(std::vector<Token>::const_iterator& itr);
-
-	Definition* parseDefinition(std::vector<Token>::const_iterator& itr);
-
-	Variable* parseVariable(std::vector<Token>::const_iterator& itr);
-	Constant* parseConstant(std::vector<Token>::const_iterator& itr);
-
-	void safe_next(std::vector<Token>::const_iterator& itr) const {
-		if (itr != end_) {
-			++itr;
-		}
-		else {
-			throw SyntaxError{ "Premature end of input!" };
-		}
-	}
-
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "Token.h"
+#include "TokenStream.h"
+#include "Syntax.h"
+#include "Exception.h"
+
+class Parser {
+
+public:
+	Parser() = default;
+	~Parser() = default;
+	Parser(const Parser&) = delete;
+	Parser& operator=(const Parser&) = delete;
+
+	Program* doParsing(TokenStream const& tokenStream);
+	// Modalità streaming: i token vengono letti man mano dalla sorgente
+	Program* doParsing(TokenSource& tokenSource);
+	// Esecuzione in streaming: ogni statement di primo livello viene passato a
+	// run appena letto, in un Program suo che viene liberato subito dopo.
+	// I nomi degli identificatori vengono copiati in names, che resta valida
+	void doParsing(TokenSource& tokenSource, Arena& names, std::function<void(Program&)> const& run);
+
+private:
+	TokenSource const* tokens_ = nullptr;
+	Arena* arena_ = nullptr;                  // arena del Program in costruzione
+	Arena* nameArena_ = nullptr;              // arena in cui vengono copiati i nomi
+	std::vector<std::string_view> names_;     // nomi già copiati nell'arena, per id di simbolo
+
+	// Nome dell'identificatore, copiato una volta sola in nameArena_
+	std::string_view name(Token const& t);
+
+	[[noreturn]] void unexpectedTokenError(Token const& found, std::string const& expected) const;
+
+	// Parse per program
+	Program* parseProgram(TokenCursor& itr);
+
+	// Parse per statement
+	Statement* parseStatement(TokenCursor& itr);
+	Statement* parseSimpleStatement(TokenCursor& itr);
+	Statement* parseCompoundStatement(TokenCursor& itr);
+
+	// Parse per if e while
+	ifStatement* parseIfStatement(TokenCursor& itr);
+	whileStatement* parseWhileStatement(TokenCursor& itr);
+
+	// Parse per espressioni
+	Expression* parseExpression(TokenCursor& itr);
+	Expression* parseJoin(TokenCursor& itr);
+	Expression* parseEquality(TokenCursor& itr);
+	Expression* parseRel(TokenCursor& itr);
+	Expression* parseNumExpr(TokenCursor& itr);
+	Expression* parseTerm(TokenCursor& itr);
+	Expression* parseUnary(TokenCursor& itr);
+	Expression* parseFactor(TokenCursor& itr);
+	Expression* parseLoc(TokenCursor& itr);
+
+	Definition* parseDefinition(TokenCursor& itr);
+
+	Variable* parseVariable(TokenCursor& itr);
+	Constant* parseConstant(TokenCursor& itr);
+
+	void safe_next(TokenCursor& itr) const {
+		if (!itr.atEnd()) {
+			++itr;
+		}
+		else {
+			throw SyntaxError{ "Premature end of input!" };
+		}
+	}
+
 };
\ No newline at end of file
@@ -0,0 +1,586 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "Syntax.h"
+#include "Token.h"
+
+// Analisi degli intervalli per gli accessi alle liste, eseguita dopo il
+// Resolver. Il dominio sono le zone (vincoli a - b <= c) tra le variabili e le
+// lunghezze delle liste, più lo zero per i limiti semplici: così
+// `while i < n` con n <= lunghezza di L, o un ciclo che aggiunge un elemento a
+// L per ogni incremento di k, bastano a dimostrare che L[i] è nei limiti.
+// L'aritmetica degli int fa il giro, quindi una relazione x = y + c viene
+// registrata solo se y + c non può uscire dal range. I while vengono iterati
+// fino al punto fisso (con widening), poi ricalcolati una volta per
+// recuperare i limiti persi (narrowing).
+// Gli accessi dimostrati (0 <= indice < lunghezza, e quindi lista creata)
+// vengono marcati listAccess::inBounds_ e gli interpreti saltano i controlli;
+// gli altri restano controllati e danno lo stesso errore di prima.
+class RangeAnalysis {
+
+public:
+	struct Stats {
+		std::size_t accesses = 0;
+		std::size_t proven = 0;
+	};
+
+	static Stats analyze(Program& program) {
+		RangeAnalysis pass{ program };
+		if (pass.nodes_ == 1) return pass.stats_;
+		State state = pass.entry();
+		for (Statement* statement : program.statements) {
+			// break/continue fuori da un while saltano alla fine dello statement
+			pass.loops_.push_back(Loop{});
+			pass.statement(statement, state, true);
+			state = join(state, pass.loops_.back().breaks);
+			state = join(state, pass.loops_.back().continues);
+			pass.loops_.pop_back();
+		}
+		return pass.stats_;
+	}
+
+private:
+	static constexpr std::int64_t INF = INT64_MAX / 4;
+	// Oltre questo numero di iterazioni la testa del ciclo diventa top
+	static constexpr int MAX_ITERATIONS = 12;
+	static constexpr int WIDEN_AFTER = 2;
+
+	// Matrice dei vincoli chiusa: m[a * n + b] è il massimo di v_a - v_b.
+	// Vuota se il punto è irraggiungibile
+	using State = std::vector<std::int64_t>;
+
+	struct Loop {
+		State breaks;
+		State continues;
+	};
+
+	// Termine lineare: nodo + costante (nodo 0 per una costante)
+	struct Linear {
+		int node;
+		std::int64_t offset;
+	};
+
+	explicit RangeAnalysis(Program const& program)
+		: variables_(program.symbols.size(), -1), lists_(program.symbols.size(), -1) {
+		relevant(program);
+	}
+
+	int nodes_ = 1;
+	int firstList_ = 1;             // i nodi delle lunghezze seguono quelli delle variabili
+	std::vector<int> variables_;    // nodo della variabile di ogni slot, -1 se non serve
+	std::vector<int> lists_;        // nodo della lunghezza della lista
+	std::vector<Loop> loops_;
+	Stats stats_;
+
+	// Nodi solo per le variabili che possono influire su un indice: quelle
+	// negli indici, e (fino al punto fisso) quelle che le definiscono o che
+	// vengono confrontate con loro
+	void relevant(Program const& program) {
+		std::vector<char> variable(variables_.size(), 0), list(lists_.size(), 0);
+		for (Statement const* st : program.statements) indices(st, variable, list);
+		bool changed = true;
+		while (changed) {
+			changed = false;
+			for (Statement const* st : program.statements) changed = expand(st, variable) || changed;
+		}
+		for (std::size_t k = 0; k < variables_.size(); ++k) if (variable[k]) variables_[k] = nodes_++;
+		firstList_ = nodes_;
+		for (std::size_t k = 0; k < lists_.size(); ++k) if (list[k]) lists_[k] = nodes_++;
+	}
+
+	// Chiama visit su ogni statement semplice e ogni condizione, in profondità
+	template <typename Visit>
+	static void walk(Statement const* st, Visit& visit) {
+		if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			visit(nullptr, i->condition);
+			for (Statement const* s : i->block) walk(s, visit);
+			if (i->elifBlock != nullptr) walk(i->elifBlock, visit);
+			for (Statement const* s : i->elseBlock) walk(s, visit);
+		}
+		else if (auto w = dynamic_cast<whileStatement const*>(st)) {
+			visit(nullptr, w->condition);
+			for (Statement const* s : w->block) walk(s, visit);
+		}
+		else if (auto d = dynamic_cast<Definition const*>(st)) visit(d, d->expression_);
+		else if (auto p = dynamic_cast<Print const*>(st)) visit(nullptr, p->expr_);
+		else if (auto a = dynamic_cast<listAppend const*>(st)) visit(nullptr, a->expr_);
+	}
+
+	static void indices(Statement const* st, std::vector<char>& variable, std::vector<char>& list) {
+		auto visit = [&](Definition const*, Expression const* e) { accesses(e, variable, list); };
+		walk(st, visit);
+	}
+
+	static void accesses(Expression const* e, std::vector<char>& variable, std::vector<char>& list) {
+		if (auto l = dynamic_cast<listAccess const*>(e)) {
+			list[l->slot_] = 1;
+			reads(l->index_, variable);
+			accesses(l->index_, variable, list);
+		}
+		else if (auto m = dynamic_cast<mathExpression const*>(e)) { accesses(m->left_, variable, list); accesses(m->right_, variable, list); }
+		else if (auto r = dynamic_cast<relExpression const*>(e)) { accesses(r->left_, variable, list); accesses(r->right_, variable, list); }
+		else if (auto a = dynamic_cast<andExpr const*>(e)) { accesses(a->left_, variable, list); accesses(a->right_, variable, list); }
+		else if (auto o = dynamic_cast<orExpr const*>(e)) { accesses(o->left_, variable, list); accesses(o->right_, variable, list); }
+		else if (auto u = dynamic_cast<unaryExpression const*>(e)) accesses(u->operand_, variable, list);
+	}
+
+	// Segna le variabili lette da un'espressione; true se ne ha aggiunte
+	static bool reads(Expression const* e, std::vector<char>& variable) {
+		if (auto v = dynamic_cast<Variable const*>(e)) {
+			if (variable[v->slot_]) return false;
+			variable[v->slot_] = 1;
+			return true;
+		}
+		if (auto m = dynamic_cast<mathExpression const*>(e)) return reads(m->left_, variable) | reads(m->right_, variable);
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return reads(u->operand_, variable);
+		return false;
+	}
+
+	static bool mentions(Expression const* e, std::vector<char> const& variable) {
+		if (auto v = dynamic_cast<Variable const*>(e)) return variable[v->slot_] != 0;
+		if (auto m = dynamic_cast<mathExpression const*>(e)) return mentions(m->left_, variable) || mentions(m->right_, variable);
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return mentions(u->operand_, variable);
+		return false;
+	}
+
+	static bool expand(Statement const* st, std::vector<char>& variable) {
+		bool changed = false;
+		auto visit = [&](Definition const* d, Expression const* e) {
+			if (d != nullptr && variable[d->variable_->slot_]) changed = reads(e, variable) || changed;
+			changed = comparisons(e, variable) || changed;
+		};
+		walk(st, visit);
+		return changed;
+	}
+
+	static bool comparisons(Expression const* e, std::vector<char>& variable) {
+		if (auto r = dynamic_cast<relExpression const*>(e)) {
+			if (mentions(r->left_, variable) || mentions(r->right_, variable)) {
+				return reads(r->left_, variable) | reads(r->right_, variable);
+			}
+			return false;
+		}
+		if (auto a = dynamic_cast<andExpr const*>(e)) return comparisons(a->left_, variable) | comparisons(a->right_, variable);
+		if (auto o = dynamic_cast<orExpr const*>(e)) return comparisons(o->left_, variable) | comparisons(o->right_, variable);
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) return comparisons(u->operand_, variable);
+		return false;
+	}
+
+	// Zone
+
+	std::int64_t& at(State& s, int a, int b) const { return s[static_cast<std::size_t>(a) * nodes_ + b]; }
+	std::int64_t at(State const& s, int a, int b) const { return s[static_cast<std::size_t>(a) * nodes_ + b]; }
+
+	static std::int64_t sum(std::int64_t a, std::int64_t b) {
+		return a >= INF || b >= INF ? INF : a + b;
+	}
+
+	// Variabili negli int, lunghezze in [0, INT_MAX]
+	std::pair<std::int64_t, std::int64_t> range(int node) const {
+		if (node >= firstList_) return { 0, INT_MAX };
+		return { INT_MIN, INT_MAX };
+	}
+
+	State top() const {
+		State s(static_cast<std::size_t>(nodes_) * nodes_, 0);
+		for (int a = 1; a < nodes_; ++a) {
+			auto [lo, hi] = range(a);
+			at(s, a, 0) = hi;
+			at(s, 0, a) = -lo;
+		}
+		for (int a = 1; a < nodes_; ++a) {
+			for (int b = 1; b < nodes_; ++b) if (a != b) at(s, a, b) = at(s, a, 0) + at(s, 0, b);
+		}
+		return s;
+	}
+
+	// Una lista non creata ha lunghezza 0: un indice dimostrato minore della
+	// lunghezza implica quindi anche che la lista esiste
+	State entry() const {
+		State s = top();
+		for (int n : lists_) if (n >= 0) assign(s, n, 0, 0);
+		return s;
+	}
+
+	static State unreachable() { return {}; }
+
+	static State join(State const& a, State const& b) {
+		if (a.empty()) return b;
+		if (b.empty()) return a;
+		State joined(a.size());
+		for (std::size_t k = 0; k < a.size(); ++k) joined[k] = a[k] > b[k] ? a[k] : b[k];
+		return joined;
+	}
+
+	static bool includes(State const& big, State const& small) {
+		if (small.empty()) return true;
+		if (big.empty()) return false;
+		for (std::size_t k = 0; k < big.size(); ++k) if (small[k] > big[k]) return false;
+		return true;
+	}
+
+	// I vincoli che crescono spariscono; i limiti del tipo restano
+	State widen(State const& old, State const& next) const {
+		if (old.empty()) return next;
+		State w(old.size());
+		for (std::size_t k = 0; k < old.size(); ++k) w[k] = next[k] <= old[k] ? old[k] : INF;
+		for (int a = 1; a < nodes_; ++a) {
+			auto [lo, hi] = range(a);
+			if (at(w, a, 0) > hi) at(w, a, 0) = hi;
+			if (at(w, 0, a) > -lo) at(w, 0, a) = -lo;
+		}
+		close(w);
+		return w;
+	}
+
+	void close(State& s) const {
+		for (int k = 0; k < nodes_; ++k) {
+			for (int a = 0; a < nodes_; ++a) {
+				std::int64_t ak = at(s, a, k);
+				if (ak >= INF) continue;
+				for (int b = 0; b < nodes_; ++b) {
+					std::int64_t via = sum(ak, at(s, k, b));
+					if (via < at(s, a, b)) at(s, a, b) = via;
+				}
+			}
+		}
+		for (int a = 0; a < nodes_; ++a) {
+			if (at(s, a, a) < 0) {
+				s.clear();
+				return;
+			}
+		}
+	}
+
+	// Aggiunge v_a - v_b <= c mantenendo la matrice chiusa
+	void constrain(State& s, int a, int b, std::int64_t c) const {
+		if (s.empty() || c >= at(s, a, b)) return;
+		if (sum(at(s, b, a), c) < 0) {
+			s.clear();
+			return;
+		}
+		for (int x = 0; x < nodes_; ++x) {
+			std::int64_t xa = at(s, x, a);
+			if (xa >= INF) continue;
+			for (int y = 0; y < nodes_; ++y) {
+				std::int64_t via = sum(sum(xa, c), at(s, b, y));
+				if (via < at(s, x, y)) at(s, x, y) = via;
+			}
+		}
+	}
+
+	// Il nodo assume un valore qualunque in [lo, hi]
+	void assign(State& s, int node, std::int64_t lo, std::int64_t hi) const {
+		at(s, node, 0) = hi;
+		at(s, 0, node) = -lo;
+		for (int b = 1; b < nodes_; ++b) {
+			if (b == node) continue;
+			at(s, node, b) = sum(hi, at(s, 0, b));
+			at(s, b, node) = sum(at(s, b, 0), -lo);
+		}
+	}
+
+	// node = other + c (senza giro)
+	void copy(State& s, int node, int other, std::int64_t c) const {
+		for (int b = 0; b < nodes_; ++b) {
+			if (b == node) continue;
+			at(s, node, b) = b == other ? c : sum(at(s, other, b), c);
+			at(s, b, node) = b == other ? -c : sum(at(s, b, other), -c);
+		}
+	}
+
+	// node = node + c (senza giro)
+	void shift(State& s, int node, std::int64_t c) const {
+		for (int b = 0; b < nodes_; ++b) {
+			if (b == node) continue;
+			if (at(s, node, b) < INF) at(s, node, b) += c;
+			if (at(s, b, node) < INF) at(s, b, node) -= c;
+		}
+	}
+
+	std::pair<std::int64_t, std::int64_t> bounds(State const& s, int node) const {
+		return { -at(s, 0, node), at(s, node, 0) };
+	}
+
+	// Espressioni
+
+	// Intervallo del valore di un'espressione (quello degli int se non si sa di meglio)
+	std::pair<std::int64_t, std::int64_t> interval(Expression const* e, State const& s) const {
+		const std::pair<std::int64_t, std::int64_t> any{ INT_MIN, INT_MAX };
+		if (auto c = dynamic_cast<Constant const*>(e)) return { c->num_, c->num_ };
+		if (auto v = dynamic_cast<Variable const*>(e)) {
+			return variables_[v->slot_] >= 0 ? bounds(s, variables_[v->slot_]) : any;
+		}
+		if (auto m = dynamic_cast<mathExpression const*>(e)) {
+			auto [a, b] = interval(m->left_, s);
+			auto [c, d] = interval(m->right_, s);
+			std::int64_t lo, hi;
+			switch (m->opCode_) {
+			case Token::ADD: lo = a + c; hi = b + d; break;
+			case Token::SUB: lo = a - d; hi = b - c; break;
+			case Token::MUL: {
+				std::int64_t p[] = { a * c, a * d, b * c, b * d };
+				lo = hi = p[0];
+				for (std::int64_t x : p) {
+					if (x < lo) lo = x;
+					if (x > hi) hi = x;
+				}
+				break;
+			}
+			case Token::INTDIV:
+				// divisione per una costante positiva: monotona
+				if (c != d || c <= 0) return any;
+				lo = a / c;
+				hi = b / c;
+				break;
+			default:
+				return any;
+			}
+			if (lo < INT_MIN || hi > INT_MAX) return any;
+			return { lo, hi };
+		}
+		if (auto u = dynamic_cast<unaryExpression const*>(e)) {
+			if (u->opCode_ != Token::SUB) return { 0, 1 };
+			auto [a, b] = interval(u->operand_, s);
+			return a == INT_MIN ? any : std::pair<std::int64_t, std::int64_t>{ -b, -a };
+		}
+		if (dynamic_cast<relExpression const*>(e) || dynamic_cast<andExpr const*>(e) || dynamic_cast<orExpr const*>(e)) return { 0, 1 };
+		return any;
+	}
+
+	// v, v + c, c + v, v - c, c, se il valore non fa il giro
+	bool linear(Expression const* e, State const& s, Linear& out) const {
+		if (auto c = dynamic_cast<Constant const*>(e)) {
+			out = Linear{ 0, c->num_ };
+			return true;
+		}
+		if (auto v = dynamic_cast<Variable const*>(e)) {
+			if (variables_[v->slot_] < 0) return false;
+			out = Linear{ variables_[v->slot_], 0 };
+			return true;
+		}
+		auto m = dynamic_cast<mathExpression const*>(e);
+		if (m == nullptr || (m->opCode_ != Token::ADD && m->opCode_ != Token::SUB)) return false;
+		Expression const* var = m->left_;
+		auto c = dynamic_cast<Constant const*>(m->right_);
+		if (c == nullptr && m->opCode_ == Token::ADD) {
+			var = m->right_;
+			c = dynamic_cast<Constant const*>(m->left_);
+		}
+		auto v = dynamic_cast<Variable const*>(var);
+		if (c == nullptr || v == nullptr || variables_[v->slot_] < 0) return false;
+		std::int64_t offset = m->opCode_ == Token::ADD ? c->num_ : -static_cast<std::int64_t>(c->num_);
+		auto [lo, hi] = bounds(s, variables_[v->slot_]);
+		if (lo + offset < INT_MIN || hi + offset > INT_MAX) return false;
+		out = Linear{ variables_[v->slot_], offset };
+		return true;
+	}
+
+	// Restringe lo stato ai cammini in cui la condizione vale truth
+	void refine(Expression const* e, State& s, bool truth) const {
+		if (s.empty()) return;
+		if (auto u = dynamic_cast<unaryExpression const*>(e); u != nullptr && u->opCode_ == Token::NOT) {
+			refine(u->operand_, s, !truth);
+		}
+		else if (auto a = dynamic_cast<andExpr const*>(e)) {
+			logical(a->left_, a->right_, s, truth, true);
+		}
+		else if (auto o = dynamic_cast<orExpr const*>(e)) {
+			logical(o->left_, o->right_, s, truth, false);
+		}
+		else if (auto r = dynamic_cast<relExpression const*>(e)) {
+			Linear l, rr;
+			if (!linear(r->left_, s, l) || !linear(r->right_, s, rr)) return;
+			// l.node + l.offset OP rr.node + rr.offset
+			std::int64_t d = rr.offset - l.offset;
+			int op = r->opCode_;
+			if (!truth) op = negate(op);
+			switch (op) {
+			case Token::LT:  constrain(s, l.node, rr.node, d - 1); break;
+			case Token::LTE: constrain(s, l.node, rr.node, d); break;
+			case Token::GT:  constrain(s, rr.node, l.node, -d - 1); break;
+			case Token::GTE: constrain(s, rr.node, l.node, -d); break;
+			case Token::EQEQ:
+				constrain(s, l.node, rr.node, d);
+				constrain(s, rr.node, l.node, -d);
+				break;
+			default: break;
+			}
+		}
+	}
+
+	// and vero / or falso: valgono entrambi; negli altri casi l'unione dei due cammini
+	void logical(Expression const* left, Expression const* right, State& s, bool truth, bool isAnd) const {
+		if (truth == isAnd) {
+			refine(left, s, truth);
+			refine(right, s, truth);
+			return;
+		}
+		State shortCircuit = s;
+		refine(left, shortCircuit, !isAnd);
+		refine(left, s, isAnd);
+		refine(right, s, !isAnd);
+		s = join(shortCircuit, s);
+	}
+
+	static int negate(int op) {
+		switch (op) {
+		case Token::LT:  return Token::GTE;
+		case Token::LTE: return Token::GT;
+		case Token::GT:  return Token::LTE;
+		case Token::GTE: return Token::LT;
+		case Token::EQEQ: return Token::NEQ;
+		default: return Token::EQEQ;
+		}
+	}
+
+	// Accessi alle liste nell'ordine di valutazione; il destro di and/or
+	// vede lo stato ristretto dal sinistro
+	void check(Expression* e, State const& s, bool rewrite) {
+		if (!rewrite || s.empty()) return;
+		if (auto l = dynamic_cast<listAccess*>(e)) {
+			check(l->index_, s, rewrite);
+			++stats_.accesses;
+			if (inBounds(l, s)) {
+				l->inBounds_ = true;
+				++stats_.proven;
+			}
+		}
+		else if (auto m = dynamic_cast<mathExpression*>(e)) { check(m->left_, s, rewrite); check(m->right_, s, rewrite); }
+		else if (auto r = dynamic_cast<relExpression*>(e)) { check(r->left_, s, rewrite); check(r->right_, s, rewrite); }
+		else if (auto u = dynamic_cast<unaryExpression*>(e)) check(u->operand_, s, rewrite);
+		else if (auto a = dynamic_cast<andExpr*>(e)) {
+			check(a->left_, s, rewrite);
+			State taken = s;
+			refine(a->left_, taken, true);
+			check(a->right_, taken, rewrite);
+		}
+		else if (auto o = dynamic_cast<orExpr*>(e)) {
+			check(o->left_, s, rewrite);
+			State taken = s;
+			refine(o->left_, taken, false);
+			check(o->right_, taken, rewrite);
+		}
+	}
+
+	bool inBounds(listAccess const* l, State const& s) const {
+		int length = lists_[l->slot_];
+		Linear index;
+		if (linear(l->index_, s, index)) {
+			return at(s, 0, index.node) <= index.offset && at(s, index.node, length) <= -1 - index.offset;
+		}
+		auto [lo, hi] = interval(l->index_, s);
+		return lo >= 0 && hi <= -at(s, 0, length) - 1;
+	}
+
+	// Statement
+
+	// Con rewrite == false si calcolano solo gli stati (iterazioni del punto
+	// fisso); gli accessi vengono marcati nell'ultima passata
+	void statement(Statement* st, State& state, bool rewrite) {
+		if (state.empty()) return;
+		if (auto d = dynamic_cast<Definition*>(st)) {
+			check(d->expression_, state, rewrite);
+			definition(d, state);
+		}
+		else if (auto p = dynamic_cast<Print*>(st)) {
+			check(p->expr_, state, rewrite);
+		}
+		else if (auto a = dynamic_cast<listAppend*>(st)) {
+			check(a->expr_, state, rewrite);
+			if (lists_[a->slot_] >= 0) {
+				auto [lo, hi] = bounds(state, lists_[a->slot_]);
+				if (hi < INT_MAX) shift(state, lists_[a->slot_], 1);
+				else assign(state, lists_[a->slot_], lo + 1 < INT_MAX ? lo + 1 : INT_MAX, INT_MAX);
+			}
+		}
+		else if (auto l = dynamic_cast<listInit*>(st)) {
+			if (lists_[l->slot_] >= 0) assign(state, lists_[l->slot_], 0, 0);
+		}
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			branch(i, state, rewrite);
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			loop(w, state, rewrite);
+		}
+		else if (dynamic_cast<Break*>(st)) {
+			loops_.back().breaks = join(loops_.back().breaks, state);
+			state = unreachable();
+		}
+		else if (dynamic_cast<Continue*>(st)) {
+			loops_.back().continues = join(loops_.back().continues, state);
+			state = unreachable();
+		}
+	}
+
+	void definition(Definition const* d, State& state) const {
+		int node = variables_[d->variable_->slot_];
+		if (node < 0) return;
+		Linear value;
+		if (linear(d->expression_, state, value)) {
+			if (value.node == node) shift(state, node, value.offset);
+			else if (value.node == 0) assign(state, node, value.offset, value.offset);
+			else copy(state, node, value.node, value.offset);
+			return;
+		}
+		auto [lo, hi] = interval(d->expression_, state);
+		assign(state, node, lo, hi);
+	}
+
+	void block(NodeList<Statement*> const& statements, State& state, bool rewrite) {
+		for (Statement* st : statements) statement(st, state, rewrite);
+	}
+
+	void branch(ifStatement* i, State& state, bool rewrite) {
+		check(i->condition, state, rewrite);
+		State taken = state;
+		refine(i->condition, taken, true);
+		refine(i->condition, state, false);
+		block(i->block, taken, rewrite);
+		if (i->elifBlock != nullptr) branch(i->elifBlock, state, rewrite);
+		else block(i->elseBlock, state, rewrite);
+		state = join(taken, state);
+	}
+
+	struct Pass {
+		State end;          // fine del corpo e continue
+		State breaks;
+	};
+
+	Pass iterate(whileStatement* w, State const& head, bool rewrite) {
+		check(w->condition, head, rewrite);
+		State body = head;
+		refine(w->condition, body, true);
+		loops_.push_back(Loop{});
+		block(w->block, body, rewrite);
+		Pass pass{ join(body, loops_.back().continues), std::move(loops_.back().breaks) };
+		loops_.pop_back();
+		return pass;
+	}
+
+	// Punto fisso sulla testa del ciclo: unione con l'ingresso per le prime
+	// iterazioni, poi widening; un passo in più recupera i limiti della
+	// condizione (narrowing)
+	void loop(whileStatement* w, State& state, bool rewrite) {
+		State head = state;
+		for (int k = 0;; ++k) {
+			State next = join(state, iterate(w, head, false).end);
+			if (includes(head, next)) break;
+			if (k >= MAX_ITERATIONS) {
+				head = top();
+				break;
+			}
+			head = k < WIDEN_AFTER ? join(head, next) : widen(head, next);
+		}
+		head = join(state, iterate(w, head, false).end);
+		Pass pass = iterate(w, head, rewrite);
+		State exit = std::move(head);
+		refine(w->condition, exit, false);
+		state = join(exit, pass.breaks);
+	}
+};
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Visitor.h"
+#include "Syntax.h"
+#include "Token.h"
+#include "Bytecode.h"
+#include "SwitchLowering.h"
+
+// Compila un Program (già risolto dal Resolver) per la VM a registri.
+// Le variabili sono registri, quindi x = x + y diventa una sola istruzione.
+// Il compilatore tiene traccia degli slot sicuramente assegnati: solo le
+// letture non garantite pagano un CHECK per l'errore di identificatore non
+// dichiarato, e solo la prima assegnazione paga un DEFINE.
+class RegisterCompiler : public Visitor {
+
+public:
+	RegisterCompiler() = default;
+	~RegisterCompiler() = default;
+
+	static RegisterChunk compile(Program const& program) {
+		RegisterCompiler compiler;
+		compiler.chunk_.slots = static_cast<int>(program.symbols.size());
+		compiler.defined_.assign(program.symbols.size(), 0);
+		compiler.visit(program);
+		return std::move(compiler.chunk_);
+	}
+
+	// break/continue fuori da un while saltano alla fine dello statement top-level
+	void visit(Program const& p) override {
+		for (Statement* statement : p.statements) {
+			std::vector<char> entry = defined_;
+			loops_.push_back(Loop{ true, {}, {} });
+			statement->accept(*this);
+			if (!loops_.back().exits.empty()) {
+				patch(loops_.back().exits, here());
+				// lo statement può essere stato interrotto a metà
+				defined_ = std::move(entry);
+			}
+			loops_.pop_back();
+		}
+		emit(ROp::HALT);
+	}
+
+	void visit(Definition const& d) override {
+		int slot = d.variable_->slot_;
+		int step = 0;
+		if (increment(d, step)) {
+			read(slot);
+			emit(ROp::INC, slot, step);
+			return;
+		}
+		int mark = temps_;
+		expression(*d.expression_, slot);
+		temps_ = mark;
+		if (!defined_[slot]) {
+			emit(ROp::DEFINE, slot);
+			defined_[slot] = 1;
+		}
+	}
+
+	void visit(Expression const& o) override {
+		throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+
+	void visit(ifStatement const& i) override {
+		if (i.dispatch_ != nullptr) {
+			dispatch(*i.dispatch_);
+			return;
+		}
+		std::size_t toElse = branch(*i.condition, false);
+		std::vector<char> afterCondition = defined_;
+		for (auto* st : i.block) st->accept(*this);
+		std::vector<char> afterThen = std::move(defined_);
+		defined_ = std::move(afterCondition);
+		if (i.elifBlock == nullptr && i.elseBlock.empty()) {
+			patch(toElse, here());
+		}
+		else {
+			std::size_t toEnd = emit(ROp::JUMP);
+			patch(toElse, here());
+			if (i.elifBlock) i.elifBlock->accept(*this);
+			else for (auto* st : i.elseBlock) st->accept(*this);
+			patch(toEnd, here());
+		}
+		intersect(afterThen);
+	}
+
+	// Il test viene ripetuto in fondo al corpo (loop inversion): ogni
+	// iterazione costa un solo salto condizionale
+	void visit(whileStatement const& w) override {
+		std::size_t toExit = branch(*w.condition, false);
+		std::vector<char> entry = defined_;
+		loops_.push_back(Loop{ false, { toExit }, {} });
+		int body = here();
+		for (auto* st : w.block) st->accept(*this);
+		patch(loops_.back().continues, here());
+		defined_ = entry;
+		patch(branch(*w.condition, true), body);
+		patch(loops_.back().exits, here());
+		loops_.pop_back();
+		defined_ = std::move(entry);
+	}
+
+	void visit(Break const& b) override {
+		loops_.back().exits.push_back(emit(ROp::JUMP));
+	}
+
+	void visit(Continue const& c) override {
+		Loop& loop = loops_.back();
+		if (loop.topLevel) loop.exits.push_back(emit(ROp::JUMP));
+		else loop.continues.push_back(emit(ROp::JUMP));
+	}
+
+	void visit(Print const& p) override {
+		int mark = temps_;
+		int value = expression(*p.expr_, ANY);
+		temps_ = mark;
+		emit(ROp::PRINT, 0, value);
+	}
+
+	void visit(listInit const& l) override {
+		emit(ROp::LIST_NEW, l.slot_);
+	}
+
+	void visit(listAppend const& l) override {
+		int mark = temps_;
+		int value = expression(*l.expr_, ANY);
+		temps_ = mark;
+		emit(ROp::APPEND, l.slot_, value);
+	}
+
+	// or/and: il ramo destro può non essere valutato, quindi i suoi CHECK
+	// non rendono assegnati gli slot per il codice che segue
+	void visit(orExpr const& e) override {
+		logical(e.left_, e.right_, ROp::JUMP_IF_TRUE, 1);
+	}
+
+	void visit(andExpr const& e) override {
+		logical(e.left_, e.right_, ROp::JUMP_IF_FALSE, 0);
+	}
+
+	void visit(relExpression const& e) override {
+		binary(compare(e.opCode_), *e.left_, *e.right_);
+	}
+
+	void visit(mathExpression const& e) override {
+		switch (e.opCode_) {
+		case Token::ADD: binary(ROp::ADD, *e.left_, *e.right_); break;
+		case Token::SUB: binary(ROp::SUB, *e.left_, *e.right_); break;
+		case Token::MUL: binary(ROp::MUL, *e.left_, *e.right_); break;
+		case Token::INTDIV: binary(ROp::DIV, *e.left_, *e.right_); break;
+		default: throw std::runtime_error("ERROR: Unknown math operator.");
+		}
+	}
+
+	void visit(unaryExpression const& e) override {
+		ROp op;
+		if (e.opCode_ == Token::SUB) op = ROp::NEG;
+		else if (e.opCode_ == Token::NOT) op = ROp::NOT;
+		else throw std::runtime_error("ERROR: Unknown unary operator.");
+		int target = target_;
+		int mark = temps_;
+		int operand = expression(*e.operand_, ANY);
+		temps_ = mark;
+		result_ = destination(target);
+		emit(op, result_, operand);
+	}
+
+	void visit(Variable const& v) override {
+		read(v.slot_);
+		result_ = move(target_, v.slot_);
+	}
+
+	void visit(Constant const& c) override {
+		result_ = move(target_, constant(c.num_));
+	}
+
+	void visit(listAccess const& e) override {
+		int target = target_;
+		int mark = temps_;
+		int index = expression(*e.index_, ANY);
+		temps_ = mark;
+		result_ = destination(target);
+		emit(e.inBounds_ ? ROp::LIST_GET_UNCHECKED : ROp::LIST_GET, result_, e.slot_, index);
+	}
+
+private:
+	static constexpr int ANY = INT_MIN;
+
+	struct Loop {
+		bool topLevel;
+		std::vector<std::size_t> exits;
+		std::vector<std::size_t> continues;
+	};
+
+	RegisterChunk chunk_;
+	std::vector<Loop> loops_;
+	std::vector<char> defined_;
+	std::unordered_map<int, int> constants_;
+	int temps_ = 0;
+	int target_ = ANY;
+	int result_ = 0;
+
+	int here() const { return static_cast<int>(chunk_.code.size()); }
+
+	// Catena if/elif annotata da SwitchLowering: la tabella salta al ramo.
+	// Dopo la catena sono assegnati gli slot assegnati in tutti i rami
+	void dispatch(Dispatch const& d) {
+		int mark = temps_;
+		int subject = expression(*d.subject, ANY);
+		temps_ = mark;
+		int table = static_cast<int>(chunk_.tables.size());
+		chunk_.tables.emplace_back();
+		emit(ROp::SWITCH, table, subject);
+		std::vector<char> entry = defined_;
+		std::vector<char> after(defined_.size(), 1);
+		std::vector<int> targets;
+		std::vector<std::size_t> toEnd;
+		for (ifStatement const* arm : d.arms) {
+			targets.push_back(here());
+			defined_ = entry;
+			for (auto* st : arm->block) st->accept(*this);
+			for (std::size_t k = 0; k < after.size(); ++k) after[k] = after[k] && defined_[k];
+			toEnd.push_back(emit(ROp::JUMP));
+		}
+		int otherwise = here();
+		defined_ = std::move(entry);
+		if (d.rest != nullptr) d.rest->accept(*this);
+		else for (auto* st : d.otherwise) st->accept(*this);
+		patch(toEnd, here());
+		intersect(after);
+		chunk_.tables[table] = JumpTable::build(std::vector<int>(d.values.begin(), d.values.end()), targets, otherwise);
+	}
+
+	std::size_t emit(ROp op, int a = 0, int b = 0, int c = 0) {
+		chunk_.code.push_back(RInstruction{ op, a, b, c });
+		return chunk_.code.size() - 1;
+	}
+
+	void patch(std::size_t at, int target) {
+		chunk_.code[at].a = target;
+	}
+
+	void patch(std::vector<std::size_t> const& jumps, int target) {
+		for (std::size_t at : jumps) patch(at, target);
+	}
+
+	// Compila un'espressione; con target == ANY il risultato può stare in
+	// qualunque registro (anche quello di una variabile o di una costante)
+	int expression(Expression const& e, int target) {
+		target_ = target;
+		e.accept(*this);
+		return result_;
+	}
+
+	int temp() {
+		int t = -1 - temps_++;
+		if (temps_ > chunk_.temps) chunk_.temps = temps_;
+		return t;
+	}
+
+	int destination(int target) {
+		return target != ANY ? target : temp();
+	}
+
+	int move(int target, int source) {
+		if (target == ANY || target == source) return source;
+		emit(ROp::MOVE, target, source);
+		return target;
+	}
+
+	int constant(int value) {
+		auto itr = constants_.find(value);
+		if (itr != constants_.end()) return itr->second;
+		int reg = chunk_.slots + static_cast<int>(chunk_.constants.size());
+		chunk_.constants.push_back(value);
+		constants_.emplace(value, reg);
+		return reg;
+	}
+
+	void read(int slot) {
+		if (!defined_[slot]) {
+			emit(ROp::CHECK, slot);
+			defined_[slot] = 1;
+		}
+	}
+
+	void intersect(std::vector<char> const& other) {
+		for (std::size_t k = 0; k < defined_.size(); ++k) defined_[k] = defined_[k] && other[k];
+	}
+
+	// Gli operandi vengono letti prima della scrittura, quindi il risultato
+	// può riusare il temporaneo di uno degli operandi
+	void binary(ROp op, Expression const& left, Expression const& right) {
+		int target = target_;
+		int mark = temps_;
+		int l = expression(left, ANY);
+		int r = expression(right, ANY);
+		temps_ = mark;
+		result_ = destination(target);
+		emit(op, result_, l, r);
+	}
+
+	void logical(Expression const* left, Expression const* right, ROp shortCircuit, int value) {
+		int target = target_;
+		int mark = temps_;
+		int l = expression(*left, ANY);
+		temps_ = mark;
+		std::size_t toShort = emit(shortCircuit, 0, l);
+		std::vector<char> afterLeft = defined_;
+		int r = expression(*right, ANY);
+		temps_ = mark;
+		defined_ = std::move(afterLeft);
+		int d = destination(target);
+		emit(ROp::BOOL, d, r);
+		std::size_t toEnd = emit(ROp::JUMP);
+		patch(toShort, here());
+		emit(ROp::MOVE, d, constant(value));
+		patch(toEnd, here());
+		result_ = d;
+	}
+
+	static ROp compare(int opCode) {
+		switch (opCode) {
+		case Token::LT:  return ROp::LT;
+		case Token::LTE: return ROp::LTE;
+		case Token::GT:  return ROp::GT;
+		case Token::GTE: return ROp::GTE;
+		case Token::EQEQ: return ROp::EQ;
+		case Token::NEQ:  return ROp::NEQ;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+	}
+
+	// Salto (da collegare) se la condizione vale when. Un confronto diventa
+	// una sola superistruzione compare-and-branch; per when == false si usa
+	// il confronto opposto (!(l < r) equivale a l >= r sugli interi)
+	std::size_t branch(Expression const& condition, bool when) {
+		int mark = temps_;
+		if (auto rel = dynamic_cast<relExpression const*>(&condition)) {
+			int l = expression(*rel->left_, ANY);
+			int r = expression(*rel->right_, ANY);
+			temps_ = mark;
+			ROp op;
+			switch (rel->opCode_) {
+			case Token::LT:  op = when ? ROp::JUMP_IF_LT : ROp::JUMP_IF_GTE; break;
+			case Token::LTE: op = when ? ROp::JUMP_IF_LTE : ROp::JUMP_IF_GT; break;
+			case Token::GT:  op = when ? ROp::JUMP_IF_GT : ROp::JUMP_IF_LTE; break;
+			case Token::GTE: op = when ? ROp::JUMP_IF_GTE : ROp::JUMP_IF_LT; break;
+			case Token::EQEQ: op = when ? ROp::JUMP_IF_EQ : ROp::JUMP_IF_NEQ; break;
+			case Token::NEQ:  op = when ? ROp::JUMP_IF_NEQ : ROp::JUMP_IF_EQ; break;
+			default: throw std::runtime_error("ERROR: Unknown relational operator.");
+			}
+			return emit(op, 0, l, r);
+		}
+		int value = expression(condition, ANY);
+		temps_ = mark;
+		return emit(when ? ROp::JUMP_IF_TRUE : ROp::JUMP_IF_FALSE, 0, value);
+	}
+
+	// x = x + k, x = k + x, x = x - k: incremento con immediato
+	static bool increment(Definition const& d, int& step) {
+		auto math = dynamic_cast<mathExpression const*>(d.expression_);
+		if (math == nullptr) return false;
+		int slot = d.variable_->slot_;
+		auto lv = dynamic_cast<Variable const*>(math->left_);
+		auto rv = dynamic_cast<Variable const*>(math->right_);
+		auto lc = dynamic_cast<Constant const*>(math->left_);
+		auto rc = dynamic_cast<Constant const*>(math->right_);
+		if (math->opCode_ == Token::ADD) {
+			if (lv && lv->slot_ == slot && rc) { step = rc->num_; return true; }
+			if (rv && rv->slot_ == slot && lc) { step = lc->num_; return true; }
+		}
+		else if (math->opCode_ == Token::SUB) {
+			if (lv && lv->slot_ == slot && rc && rc->num_ != INT_MIN) { step = -rc->num_; return true; }
+		}
+		return false;
+	}
+};
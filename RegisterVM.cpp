@@ -0,0 +1,79 @@
+#include <stdexcept>
+#include <vector>
+
+#include "RegisterVM.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define REGISTER_VM_COMPUTED_GOTO 1
+#endif
+
+void RegisterVM::run(RegisterChunk const& chunk) {
+	// [temporanei | slot | costanti]: r punta al primo slot
+	std::vector<int> registers(chunk.temps + chunk.slots + chunk.constants.size());
+	int* r = registers.data() + chunk.temps;
+	for (std::size_t k = 0; k < chunk.constants.size(); ++k) r[chunk.slots + k] = chunk.constants[k];
+	std::vector<char> defined(chunk.slots);
+
+	const RInstruction* code = chunk.code.data();
+	const RInstruction* ip = code;
+
+#if defined(REGISTER_VM_COMPUTED_GOTO)
+	static void* const labels[] = {
+#define REGISTER_OP_LABEL(name) &&op_##name,
+		REGISTER_OPS(REGISTER_OP_LABEL)
+#undef REGISTER_OP_LABEL
+	};
+#define OP(name) op_##name:
+#define NEXT() goto *labels[static_cast<int>(ip->op)]
+	NEXT();
+#else
+#define OP(name) case ROp::name:
+#define NEXT() goto dispatch
+dispatch:
+	switch (ip->op) {
+#endif
+
+	OP(MOVE) r[ip->a] = r[ip->b]; ++ip; NEXT();
+	OP(ADD) r[ip->a] = r[ip->b] + r[ip->c]; ++ip; NEXT();
+	OP(SUB) r[ip->a] = r[ip->b] - r[ip->c]; ++ip; NEXT();
+	OP(MUL) r[ip->a] = r[ip->b] * r[ip->c]; ++ip; NEXT();
+	OP(DIV)
+		if (r[ip->c] == 0) throw std::runtime_error("ERROR: Division by zero.");
+		r[ip->a] = r[ip->b] / r[ip->c]; ++ip; NEXT();
+	OP(LT) r[ip->a] = r[ip->b] < r[ip->c]; ++ip; NEXT();
+	OP(LTE) r[ip->a] = r[ip->b] <= r[ip->c]; ++ip; NEXT();
+	OP(GT) r[ip->a] = r[ip->b] > r[ip->c]; ++ip; NEXT();
+	OP(GTE) r[ip->a] = r[ip->b] >= r[ip->c]; ++ip; NEXT();
+	OP(EQ) r[ip->a] = r[ip->b] == r[ip->c]; ++ip; NEXT();
+	OP(NEQ) r[ip->a] = r[ip->b] != r[ip->c]; ++ip; NEXT();
+	OP(NEG) r[ip->a] = -r[ip->b]; ++ip; NEXT();
+	OP(NOT) r[ip->a] = r[ip->b] == 0; ++ip; NEXT();
+	OP(BOOL) r[ip->a] = r[ip->b] != 0; ++ip; NEXT();
+	OP(INC) r[ip->a] += ip->b; ++ip; NEXT();
+	OP(JUMP) ip = code + ip->a; NEXT();
+	OP(JUMP_IF_FALSE) ip = r[ip->b] == 0 ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_TRUE) ip = r[ip->b] != 0 ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_LT) ip = r[ip->b] < r[ip->c] ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_LTE) ip = r[ip->b] <= r[ip->c] ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_GT) ip = r[ip->b] > r[ip->c] ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_GTE) ip = r[ip->b] >= r[ip->c] ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_EQ) ip = r[ip->b] == r[ip->c] ? code + ip->a : ip + 1; NEXT();
+	OP(JUMP_IF_NEQ) ip = r[ip->b] != r[ip->c] ? code + ip->a : ip + 1; NEXT();
+	OP(CHECK)
+		if (!defined[ip->a]) symbolTable_.undeclared(ip->a);
+		++ip; NEXT();
+	OP(DEFINE) defined[ip->a] = 1; ++ip; NEXT();
+	OP(LIST_NEW) symbolTable_.setList(ip->a); ++ip; NEXT();
+	OP(APPEND) symbolTable_.appendToList(ip->a, r[ip->b]); ++ip; NEXT();
+	OP(LIST_GET) r[ip->a] = symbolTable_.getListValue(ip->b, r[ip->c]); ++ip; NEXT();
+	OP(LIST_GET_UNCHECKED) r[ip->a] = symbolTable_.getListValueUnchecked(ip->b, r[ip->c]); ++ip; NEXT();
+	OP(PRINT) console_.print(r[ip->b]); ++ip; NEXT();
+	OP(SWITCH) ip = code + chunk.tables[ip->a].target(r[ip->b]); NEXT();
+	OP(HALT) return;
+
+#if !defined(REGISTER_VM_COMPUTED_GOTO)
+	}
+#endif
+#undef OP
+#undef NEXT
+}
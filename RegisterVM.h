@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Bytecode.h"
+#include "OutputSink.h"
+#include "SymbolTable.h"
+
+// VM a registri per il bytecode di RegisterCompiler. Le variabili scalari
+// vivono nei registri della VM; le liste e i messaggi di errore restano
+// quelli della SymbolTable. Con GCC/Clang il dispatch usa i computed goto
+// (un salto indiretto per istruzione), altrimenti uno switch.
+class RegisterVM {
+
+public:
+	RegisterVM(SymbolTable& st, OutputSink& con)
+		: symbolTable_{ st }, console_{ con } {
+	}
+
+	void run(RegisterChunk const& chunk);
+
+private:
+	SymbolTable& symbolTable_;
+	OutputSink& console_;
+};
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Visitor.h"
+#include "Syntax.h"
+
+// Passata eseguita dopo il parsing: assegna a ogni identificatore uno slot
+// intero denso e lo scrive nei nodi, così la SymbolTable non deve più cercare
+// le stringhe durante la valutazione. Variabili e liste con lo stesso nome
+// condividono lo slot ma hanno memorie separate nella SymbolTable.
+class Resolver : public Visitor {
+
+public:
+	Resolver() = default;
+	~Resolver() = default;
+
+	// Risolve tutto il programma e salva i nomi per slot in program.symbols
+	static void resolve(Program& program) {
+		Resolver resolver;
+		resolver.visit(program);
+		program.symbols = program.arena.copy(resolver.names_);
+	}
+
+	// Nomi per slot degli identificatori visti finora. Visitando più programmi
+	// con lo stesso Resolver (streaming) gli slot già assegnati non cambiano
+	std::vector<std::string_view> const& names() const { return names_; }
+
+	void visit(Program const& p) override {
+		for (Statement* statement : p.statements) statement->accept(*this);
+	}
+	void visit(Definition const& d) override {
+		d.variable_->accept(*this);
+		d.expression_->accept(*this);
+	}
+	void visit(Expression const& o) override {
+		throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+	void visit(Variable const& v) override {
+		v.slot_ = slot(v.id_);
+	}
+	void visit(Constant const& c) override { }
+
+	void visit(ifStatement const& i) override {
+		i.condition->accept(*this);
+		for (Statement* st : i.block) st->accept(*this);
+		if (i.elifBlock != nullptr) i.elifBlock->accept(*this);
+		for (Statement* st : i.elseBlock) st->accept(*this);
+	}
+	void visit(whileStatement const& w) override {
+		w.condition->accept(*this);
+		for (Statement* st : w.block) st->accept(*this);
+	}
+
+	void visit(Break const& b) override { }
+	void visit(Continue const& c) override { }
+	void visit(Print const& p) override {
+		p.expr_->accept(*this);
+	}
+	void visit(listInit const& l) override {
+		l.slot_ = slot(l.id_);
+	}
+	void visit(listAppend const& l) override {
+		l.slot_ = slot(l.id_);
+		l.expr_->accept(*this);
+	}
+
+	void visit(orExpr const& e) override {
+		e.left_->accept(*this);
+		e.right_->accept(*this);
+	}
+	void visit(andExpr const& e) override {
+		e.left_->accept(*this);
+		e.right_->accept(*this);
+	}
+	void visit(relExpression const& e) override {
+		e.left_->accept(*this);
+		e.right_->accept(*this);
+	}
+	void visit(mathExpression const& e) override {
+		e.left_->accept(*this);
+		e.right_->accept(*this);
+	}
+	void visit(unaryExpression const& e) override {
+		e.operand_->accept(*this);
+	}
+	void visit(listAccess const& e) override {
+		e.slot_ = slot(e.id_);
+		e.index_->accept(*this);
+	}
+
+private:
+	int slot(std::string_view name) {
+		auto itr = slots_.find(name);
+		if (itr != slots_.end()) return itr->second;
+		int s = static_cast<int>(names_.size());
+		names_.push_back(name);
+		slots_.emplace(name, s);
+		return s;
+	}
+
+	std::unordered_map<std::string_view, int> slots_;
+	std::vector<std::string_view> names_;
+};
@@ -0,0 +1,528 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "Syntax.h"
+#include "Token.h"
+#include "MagicDivision.h"
+
+// Analisi delle variabili di induzione dei while, eseguita dopo il Resolver e
+// le altre passate di -O. Una variabile di induzione è assegnata una sola
+// volta nel ciclo, da uno statement `i = i + c` (o `i - c`) del corpo.
+//  - Forma chiusa: un ciclo `while i < N` (o <=, >, >=, ==, !=) il cui corpo
+//    contiene solo l'incremento e accumulatori `s = s + e`, con e costante,
+//    i, i * k o k (k invariante), viene sostituito dai valori finali, se il
+//    valore iniziale di i è una costante assegnata prima del ciclo e i non
+//    esce dal range degli int. Le somme sono calcolate modulo 2^32, come le
+//    fa l'interprete.
+//  - Riduzione di forza: nei cicli rimasti, i * k (k costante o variabile
+//    invariante, i e k sicuramente assegnate all'ingresso) diventa un
+//    temporaneo ($svN) calcolato prima del ciclo e aumentato di c * k subito
+//    dopo l'incremento di i.
+//  - Divisioni per costante: x // d (d diverso da 0, 1 e -1) riceve il
+//    moltiplicatore e lo shift usati dall'interprete e dal JIT al posto di /.
+class ScalarEvolution {
+
+public:
+	struct Stats {
+		std::size_t closed = 0;      // cicli sostituiti dalla forma chiusa
+		std::size_t reduced = 0;     // moltiplicazioni sostituite da un temporaneo
+		std::size_t divisions = 0;   // divisioni per costante
+	};
+
+	static Stats analyze(Program& program) {
+		ScalarEvolution pass{ program };
+		program.statements = pass.block(program.statements, true);
+		program.symbols = program.arena.copy(pass.names_);
+		for (Statement* st : program.statements) pass.annotate(st);
+		return pass.stats_;
+	}
+
+private:
+	explicit ScalarEvolution(Program& program)
+		: program_{ program }, names_(program.symbols.begin(), program.symbols.end()),
+		defined_(program.symbols.size(), 0) {
+	}
+
+	struct Induction {
+		std::size_t position;       // indice dell'incremento nel corpo
+		std::int64_t step;
+	};
+
+	Program& program_;
+	std::vector<std::string_view> names_;
+	std::vector<char> defined_;
+	Stats stats_;
+
+	NodeList<Statement*> block(NodeList<Statement*> const& statements, bool topLevel) {
+		std::vector<Statement*> out;
+		for (Statement* st : statements) {
+			std::vector<char> entry = defined_;
+			statement(st, out);
+			// al top-level break/continue interrompono lo statement a metà
+			if (topLevel && escapes(st)) restore(std::move(entry));
+		}
+		return program_.arena.copy(out);
+	}
+
+	void statement(Statement* st, std::vector<Statement*>& out) {
+		if (auto d = dynamic_cast<Definition*>(st)) {
+			defined_[d->variable_->slot_] = 1;
+		}
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			branch(i);
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			loop(w, out);
+			return;
+		}
+		out.push_back(st);
+	}
+
+	void branch(ifStatement* i) {
+		std::vector<char> entry = defined_;
+		i->block = block(i->block, false);
+		std::vector<char> afterThen = std::move(defined_);
+		restore(std::move(entry));
+		if (i->elifBlock != nullptr) branch(i->elifBlock);
+		else i->elseBlock = block(i->elseBlock, false);
+		afterThen.resize(defined_.size(), 0);
+		for (std::size_t k = 0; k < defined_.size(); ++k) defined_[k] = defined_[k] && afterThen[k];
+	}
+
+	// I temporanei creati dopo la copia non sono assegnati
+	void restore(std::vector<char> saved) {
+		saved.resize(names_.size(), 0);
+		defined_ = std::move(saved);
+	}
+
+	// I cicli interni vengono trattati per primi
+	void loop(whileStatement* w, std::vector<Statement*>& out) {
+		std::vector<char> entry = defined_;
+		w->block = block(w->block, false);
+		restore(std::move(entry));
+		if (closedForm(w, out)) {
+			++stats_.closed;
+			return;
+		}
+		reduce(w, out);
+		out.push_back(w);
+	}
+
+	// Forma chiusa
+
+	bool closedForm(whileStatement* w, std::vector<Statement*>& out) {
+		auto rel = dynamic_cast<relExpression*>(w->condition);
+		if (rel == nullptr) return false;
+		Variable* var = dynamic_cast<Variable*>(rel->left_);
+		Constant* bound = dynamic_cast<Constant*>(rel->right_);
+		int op = rel->opCode_;
+		if (var == nullptr || bound == nullptr) {
+			var = dynamic_cast<Variable*>(rel->right_);
+			bound = dynamic_cast<Constant*>(rel->left_);
+			op = mirror(op);
+		}
+		if (var == nullptr || bound == nullptr) return false;
+		int i = var->slot_;
+
+		// solo definizioni, ognuna di una variabile diversa
+		std::vector<char> assigned(names_.size(), 0);
+		std::size_t increment = w->block.size();
+		std::int64_t step = 0;
+		for (std::size_t k = 0; k < w->block.size(); ++k) {
+			auto d = dynamic_cast<Definition*>(w->block[k]);
+			if (d == nullptr || assigned[d->variable_->slot_]) return false;
+			assigned[d->variable_->slot_] = 1;
+			if (d->variable_->slot_ == i) {
+				if (!induction(d, step)) return false;
+				increment = k;
+			}
+		}
+		if (increment == w->block.size()) return false;
+		std::vector<Expression**> terms;
+		for (std::size_t k = 0; k < w->block.size(); ++k) {
+			if (k == increment) continue;
+			Expression** term = accumulator(static_cast<Definition*>(w->block[k]), i, assigned);
+			if (term == nullptr) return false;
+			terms.push_back(term);
+		}
+
+		int start;
+		std::int64_t trips;
+		if (!initial(i, out, start) || !tripCount(start, op, bound->num_, step, trips)) return false;
+		// il ciclo non viene eseguito: la condizione legge solo i, che è assegnata
+		if (trips == 0) return true;
+
+		std::uint32_t count = static_cast<std::uint32_t>(trips);
+		std::uint32_t before = sum(start, step, trips);
+		std::uint32_t after = sum(static_cast<std::int64_t>(start) + step, step, trips);
+		auto term = terms.begin();
+		for (std::size_t k = 0; k < w->block.size(); ++k) {
+			auto d = static_cast<Definition*>(w->block[k]);
+			if (k == increment) {
+				out.push_back(program_.arena.make<Definition>(read(var), constant(start + trips * step)));
+				continue;
+			}
+			**term = total(**term, i, k < increment ? before : after, count);
+			++term;
+			out.push_back(d);
+		}
+		return true;
+	}
+
+	// i = i + c, i = c + i, i = i - c (c costante non nulla)
+	static bool induction(Definition const* d, std::int64_t& step) {
+		auto m = dynamic_cast<mathExpression const*>(d->expression_);
+		if (m == nullptr) return false;
+		int slot = d->variable_->slot_;
+		auto c = dynamic_cast<Constant const*>(m->right_);
+		bool self = isVariable(m->left_, slot);
+		if (m->opCode_ == Token::ADD && !self) {
+			c = dynamic_cast<Constant const*>(m->left_);
+			self = isVariable(m->right_, slot);
+		}
+		if (!self || c == nullptr || c->num_ == 0) return false;
+		if (m->opCode_ == Token::ADD) step = c->num_;
+		else if (m->opCode_ == Token::SUB && c->num_ != INT_MIN) step = -static_cast<std::int64_t>(c->num_);
+		else return false;
+		return true;
+	}
+
+	// s = s + e, s = e + s, s = s - e: restituisce la posizione di e se è
+	// un termine di cui si sa calcolare la somma
+	static Expression** accumulator(Definition* d, int i, std::vector<char> const& assigned) {
+		auto m = dynamic_cast<mathExpression*>(d->expression_);
+		if (m == nullptr) return nullptr;
+		int slot = d->variable_->slot_;
+		Expression** term = nullptr;
+		if ((m->opCode_ == Token::ADD || m->opCode_ == Token::SUB) && isVariable(m->left_, slot)) term = &m->right_;
+		else if (m->opCode_ == Token::ADD && isVariable(m->right_, slot)) term = &m->left_;
+		if (term == nullptr) return nullptr;
+		auto invariant = [&](Expression const* e) {
+			auto v = dynamic_cast<Variable const*>(e);
+			return dynamic_cast<Constant const*>(e) != nullptr || (v != nullptr && !assigned[v->slot_]);
+		};
+		if (invariant(*term) || isVariable(*term, i)) return term;
+		auto product = dynamic_cast<mathExpression const*>(*term);
+		if (product == nullptr || product->opCode_ != Token::MUL) return nullptr;
+		if (isVariable(product->left_, i) && invariant(product->right_)) return term;
+		if (isVariable(product->right_, i) && invariant(product->left_)) return term;
+		return nullptr;
+	}
+
+	// Somma del termine su tutte le iterazioni; indices è la somma dei
+	// valori di i visti dal termine. Una variabile invariante resta una
+	// lettura, così un eventuale errore arriva nello stesso statement
+	Expression* total(Expression* e, int i, std::uint32_t indices, std::uint32_t count) {
+		if (auto c = dynamic_cast<Constant*>(e)) return constant(static_cast<std::uint32_t>(c->num_) * count);
+		if (isVariable(e, i)) return constant(indices);
+		if (auto v = dynamic_cast<Variable*>(e)) {
+			return program_.arena.make<mathExpression>(Token::MUL, read(v), constant(count));
+		}
+		auto product = static_cast<mathExpression*>(e);
+		Expression* factor = isVariable(product->left_, i) ? product->right_ : product->left_;
+		if (auto c = dynamic_cast<Constant*>(factor)) return constant(static_cast<std::uint32_t>(c->num_) * indices);
+		return program_.arena.make<mathExpression>(Token::MUL, read(static_cast<Variable*>(factor)), constant(indices));
+	}
+
+	// Valore costante di i all'ingresso: l'ultima assegnazione nello stesso
+	// blocco, senza altre scritture di i in mezzo
+	static bool initial(int i, std::vector<Statement*> const& out, int& start) {
+		for (auto itr = out.rbegin(); itr != out.rend(); ++itr) {
+			if (auto d = dynamic_cast<Definition const*>(*itr); d != nullptr && d->variable_->slot_ == i) {
+				auto c = dynamic_cast<Constant const*>(d->expression_);
+				if (c == nullptr) return false;
+				start = c->num_;
+				return true;
+			}
+			if (writes(*itr, i)) return false;
+		}
+		return false;
+	}
+
+	// Numero di iterazioni, se i resta nel range degli int fino all'uscita
+	static bool tripCount(std::int64_t start, int op, std::int64_t bound, std::int64_t step, std::int64_t& trips) {
+		if (!holds(op, start, bound)) {
+			trips = 0;
+			return true;
+		}
+		switch (op) {
+		case Token::LT:
+		case Token::LTE: {
+			if (step < 0) return false;
+			std::int64_t limit = op == Token::LT ? bound : bound + 1;
+			trips = (limit - start + step - 1) / step;
+			break;
+		}
+		case Token::GT:
+		case Token::GTE: {
+			if (step > 0) return false;
+			std::int64_t limit = op == Token::GT ? bound : bound - 1;
+			trips = (start - limit - step - 1) / -step;
+			break;
+		}
+		case Token::NEQ:
+			if ((bound - start) % step != 0 || (bound - start) / step <= 0) return false;
+			trips = (bound - start) / step;
+			break;
+		case Token::EQEQ:
+			trips = 1;
+			break;
+		default:
+			return false;
+		}
+		std::int64_t last = start + trips * step;
+		return last >= INT_MIN && last <= INT_MAX;
+	}
+
+	static bool holds(int op, std::int64_t l, std::int64_t r) {
+		switch (op) {
+		case Token::LT:  return l < r;
+		case Token::LTE: return l <= r;
+		case Token::GT:  return l > r;
+		case Token::GTE: return l >= r;
+		case Token::EQEQ: return l == r;
+		default: return l != r;
+		}
+	}
+
+	// first + (first + step) + ... per trips valori, modulo 2^32
+	static std::uint32_t sum(std::int64_t first, std::int64_t step, std::int64_t trips) {
+		std::uint64_t n = static_cast<std::uint64_t>(trips);
+		std::uint64_t pairs = n % 2 == 0 ? n / 2 * (n - 1) : (n - 1) / 2 * n;
+		return static_cast<std::uint32_t>(n * static_cast<std::uint64_t>(first) + pairs * static_cast<std::uint64_t>(step));
+	}
+
+	static int mirror(int op) {
+		switch (op) {
+		case Token::LT:  return Token::GT;
+		case Token::LTE: return Token::GTE;
+		case Token::GT:  return Token::LT;
+		case Token::GTE: return Token::LTE;
+		default: return op;
+		}
+	}
+
+	// Riduzione di forza
+
+	void reduce(whileStatement* w, std::vector<Statement*>& out) {
+		std::vector<int> assignments(names_.size(), 0);
+		for (Statement const* st : w->block) count(st, assignments);
+		std::map<int, Induction> inductions;
+		for (std::size_t k = 0; k < w->block.size(); ++k) {
+			auto d = dynamic_cast<Definition const*>(w->block[k]);
+			std::int64_t step;
+			if (d == nullptr) continue;
+			int slot = d->variable_->slot_;
+			if (assignments[slot] == 1 && defined_[slot] && induction(d, step)) inductions.emplace(slot, Induction{ k, step });
+		}
+		if (inductions.empty()) return;
+
+		std::map<std::pair<int, std::string>, Variable*> reduced;
+		std::vector<std::vector<Statement*>> updates(w->block.size());
+		auto visit = [&](Expression*& e) { scan(e, inductions, assignments, reduced, updates, out); };
+		visit(w->condition);
+		for (Statement* st : w->block) statements(st, visit);
+		if (reduced.empty()) return;
+
+		std::vector<Statement*> body;
+		for (std::size_t k = 0; k < w->block.size(); ++k) {
+			body.push_back(w->block[k]);
+			body.insert(body.end(), updates[k].begin(), updates[k].end());
+		}
+		w->block = program_.arena.copy(body);
+	}
+
+	// Applica visit a tutte le espressioni di uno statement, anche annidate
+	template <typename Visit>
+	static void statements(Statement* st, Visit& visit) {
+		if (auto d = dynamic_cast<Definition*>(st)) visit(d->expression_);
+		else if (auto p = dynamic_cast<Print*>(st)) visit(p->expr_);
+		else if (auto a = dynamic_cast<listAppend*>(st)) visit(a->expr_);
+		else if (auto i = dynamic_cast<ifStatement*>(st)) {
+			visit(i->condition);
+			for (Statement* s : i->block) statements(s, visit);
+			if (i->elifBlock != nullptr) statements(i->elifBlock, visit);
+			for (Statement* s : i->elseBlock) statements(s, visit);
+		}
+		else if (auto w = dynamic_cast<whileStatement*>(st)) {
+			visit(w->condition);
+			for (Statement* s : w->block) statements(s, visit);
+		}
+	}
+
+	void scan(Expression*& e, std::map<int, Induction> const& inductions, std::vector<int> const& writes,
+		std::map<std::pair<int, std::string>, Variable*>& reduced, std::vector<std::vector<Statement*>>& updates,
+		std::vector<Statement*>& out) {
+		if (auto m = dynamic_cast<mathExpression*>(e)) {
+			if (m->opCode_ == Token::MUL) {
+				Variable* var = dynamic_cast<Variable*>(m->left_);
+				Expression* factor = m->right_;
+				if (var == nullptr || inductions.count(var->slot_) == 0) {
+					var = dynamic_cast<Variable*>(m->right_);
+					factor = m->left_;
+				}
+				if (var != nullptr && inductions.count(var->slot_) != 0 && invariant(factor, writes)) {
+					e = read(temporary(var, factor, inductions.at(var->slot_), reduced, updates, out));
+					++stats_.reduced;
+					return;
+				}
+			}
+			scan(m->left_, inductions, writes, reduced, updates, out);
+			scan(m->right_, inductions, writes, reduced, updates, out);
+		}
+		else if (auto r = dynamic_cast<relExpression*>(e)) {
+			scan(r->left_, inductions, writes, reduced, updates, out);
+			scan(r->right_, inductions, writes, reduced, updates, out);
+		}
+		else if (auto a = dynamic_cast<andExpr*>(e)) {
+			scan(a->left_, inductions, writes, reduced, updates, out);
+			scan(a->right_, inductions, writes, reduced, updates, out);
+		}
+		else if (auto o = dynamic_cast<orExpr*>(e)) {
+			scan(o->left_, inductions, writes, reduced, updates, out);
+			scan(o->right_, inductions, writes, reduced, updates, out);
+		}
+		else if (auto u = dynamic_cast<unaryExpression*>(e)) {
+			scan(u->operand_, inductions, writes, reduced, updates, out);
+		}
+		else if (auto l = dynamic_cast<listAccess*>(e)) {
+			scan(l->index_, inductions, writes, reduced, updates, out);
+		}
+	}
+
+	// Costante, o variabile mai assegnata nel ciclo e assegnata all'ingresso
+	bool invariant(Expression const* e, std::vector<int> const& writes) const {
+		if (dynamic_cast<Constant const*>(e) != nullptr) return true;
+		auto v = dynamic_cast<Variable const*>(e);
+		return v != nullptr && writes[v->slot_] == 0 && defined_[v->slot_];
+	}
+
+	// Temporaneo per var * factor: calcolato prima del ciclo e aggiornato
+	// subito dopo l'incremento di var (anche in modulo 2^32)
+	Variable* temporary(Variable const* var, Expression const* factor, Induction const& induction,
+		std::map<std::pair<int, std::string>, Variable*>& reduced, std::vector<std::vector<Statement*>>& updates,
+		std::vector<Statement*>& out) {
+		auto c = dynamic_cast<Constant const*>(factor);
+		std::string key = c != nullptr ? "c" + std::to_string(c->num_) : "v" + std::to_string(static_cast<Variable const*>(factor)->slot_);
+		auto itr = reduced.find({ var->slot_, key });
+		if (itr != reduced.end()) return itr->second;
+
+		Arena& arena = program_.arena;
+		Variable* temp = newTemporary();
+		out.push_back(arena.make<Definition>(temp, arena.make<mathExpression>(Token::MUL, read(var), copy(factor))));
+		Expression* step;
+		if (c != nullptr) {
+			step = constant(static_cast<std::uint32_t>(c->num_) * static_cast<std::uint32_t>(induction.step));
+		}
+		else {
+			Variable* increment = newTemporary();
+			out.push_back(arena.make<Definition>(increment, arena.make<mathExpression>(Token::MUL, copy(factor), constant(static_cast<std::uint32_t>(induction.step)))));
+			step = read(increment);
+		}
+		updates[induction.position].push_back(arena.make<Definition>(read(temp), arena.make<mathExpression>(Token::ADD, read(temp), step)));
+		reduced.emplace(std::make_pair(var->slot_, key), temp);
+		return temp;
+	}
+
+	Variable* newTemporary() {
+		std::string name = "$sv" + std::to_string(names_.size());
+		Variable* temp = program_.arena.make<Variable>(program_.arena.copy(std::string_view{ name }));
+		temp->slot_ = static_cast<int>(names_.size());
+		names_.push_back(temp->id_);
+		defined_.push_back(1);
+		return temp;
+	}
+
+	// Divisioni per costante
+
+	void annotate(Statement* st) {
+		auto visit = [this](Expression*& e) { divisions(e); };
+		statements(st, visit);
+	}
+
+	void divisions(Expression* e) {
+		if (auto m = dynamic_cast<mathExpression*>(e)) {
+			divisions(m->left_);
+			divisions(m->right_);
+			auto c = dynamic_cast<Constant const*>(m->right_);
+			if (m->opCode_ == Token::INTDIV && c != nullptr && MagicDivisor::applicable(c->num_)) {
+				MagicDivisor magic = MagicDivisor::of(c->num_);
+				m->magic_ = magic.multiplier;
+				m->shift_ = magic.shift;
+				++stats_.divisions;
+			}
+		}
+		else if (auto r = dynamic_cast<relExpression*>(e)) { divisions(r->left_); divisions(r->right_); }
+		else if (auto a = dynamic_cast<andExpr*>(e)) { divisions(a->left_); divisions(a->right_); }
+		else if (auto o = dynamic_cast<orExpr*>(e)) { divisions(o->left_); divisions(o->right_); }
+		else if (auto u = dynamic_cast<unaryExpression*>(e)) divisions(u->operand_);
+		else if (auto l = dynamic_cast<listAccess*>(e)) divisions(l->index_);
+	}
+
+	// Utilità
+
+	static bool isVariable(Expression const* e, int slot) {
+		auto v = dynamic_cast<Variable const*>(e);
+		return v != nullptr && v->slot_ == slot;
+	}
+
+	// Scritture di una variabile (anche come lista) in uno statement
+	static bool writes(Statement const* st, int slot) {
+		std::vector<int> counts(static_cast<std::size_t>(slot) + 1, 0);
+		count(st, counts);
+		return counts[slot] != 0;
+	}
+
+	static void count(Statement const* st, std::vector<int>& writes) {
+		auto add = [&](int slot) { if (slot < static_cast<int>(writes.size())) ++writes[slot]; };
+		if (auto d = dynamic_cast<Definition const*>(st)) add(d->variable_->slot_);
+		else if (auto l = dynamic_cast<listInit const*>(st)) add(l->slot_);
+		else if (auto a = dynamic_cast<listAppend const*>(st)) add(a->slot_);
+		else if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			for (Statement const* s : i->block) count(s, writes);
+			if (i->elifBlock != nullptr) count(i->elifBlock, writes);
+			for (Statement const* s : i->elseBlock) count(s, writes);
+		}
+		else if (auto w = dynamic_cast<whileStatement const*>(st)) {
+			for (Statement const* s : w->block) count(s, writes);
+		}
+	}
+
+	// break/continue che escono dallo statement (non racchiusi in un while)
+	static bool escapes(Statement const* st) {
+		if (dynamic_cast<Break const*>(st) || dynamic_cast<Continue const*>(st)) return true;
+		if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			for (Statement const* s : i->block) if (escapes(s)) return true;
+			for (Statement const* s : i->elseBlock) if (escapes(s)) return true;
+			return i->elifBlock != nullptr && escapes(i->elifBlock);
+		}
+		return false;
+	}
+
+	Variable* read(Variable const* v) {
+		Variable* copy = program_.arena.make<Variable>(v->id_);
+		copy->slot_ = v->slot_;
+		return copy;
+	}
+
+	Expression* copy(Expression const* e) {
+		if (auto v = dynamic_cast<Variable const*>(e)) return read(v);
+		return constant(static_cast<std::uint32_t>(static_cast<Constant const*>(e)->num_));
+	}
+
+	Constant* constant(std::uint32_t value) {
+		return program_.arena.make<Constant>(static_cast<int>(value));
+	}
+
+	Constant* constant(std::int64_t value) {
+		return program_.arena.make<Constant>(static_cast<int>(value));
+	}
+};
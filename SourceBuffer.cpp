@@ -0,0 +1,63 @@
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include "SourceBuffer.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SOURCE_BUFFER_MMAP 1
+#endif
+
+SourceBuffer::SourceBuffer(std::string const& path) {
+#ifdef SOURCE_BUFFER_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("cannot open file " + path);
+    }
+    struct stat st;
+    // Mappo solo file regolari non vuoti (pipe e file vuoti passano dal fallback)
+    if (::fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        if (static_cast<std::uint64_t>(st.st_size) > UINT32_MAX) {
+            ::close(fd);
+            throw std::runtime_error("source larger than 4 GB");
+        }
+        void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::madvise(p, st.st_size, MADV_SEQUENTIAL);
+            data_ = static_cast<const char*>(p);
+            size_ = static_cast<std::size_t>(st.st_size);
+            mapped_ = true;
+            ::close(fd);
+            return;
+        }
+    }
+    ::close(fd);
+#endif
+
+    // Fallback: leggo tutto il file in memoria
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("cannot open file " + path);
+    }
+    std::ostringstream temp;
+    temp << in.rdbuf();
+    fallback_ = temp.str();
+    if (fallback_.size() > UINT32_MAX) {
+        throw std::runtime_error("source larger than 4 GB");
+    }
+    data_ = fallback_.data();
+    size_ = fallback_.size();
+}
+
+SourceBuffer::~SourceBuffer() {
+#ifdef SOURCE_BUFFER_MMAP
+    if (mapped_) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+#endif
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Buffer di sola lettura con il contenuto del file sorgente.
+// Su sistemi POSIX il file viene mappato in memoria (mmap), cosi' i token
+// possono puntare direttamente al testo senza copiarlo; altrimenti il file
+// viene letto tutto in una stringa. Il file non puo' superare i 4 GB (gli
+// offset dei token sono a 32 bit, vedi Token.h).
+class SourceBuffer {
+public:
+	explicit SourceBuffer(std::string const& path);
+	~SourceBuffer();
+	SourceBuffer(SourceBuffer const&) = delete;
+	SourceBuffer& operator=(SourceBuffer const&) = delete;
+
+	std::string_view view() const { return { data_, size_ }; }
+
+private:
+	const char* data_ = "";
+	std::size_t size_ = 0;
+	bool mapped_ = false;
+	std::string fallback_;  // usato solo se mmap non e' disponibile
+};
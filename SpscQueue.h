@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+// Coda circolare senza lock per un solo produttore e un solo consumatore:
+// un thread chiama solo push, l'altro solo pop. Gli indici crescono sempre
+// (la cella è indice % Capacity) e ognuno viene scritto da un solo thread;
+// lo store release dell'indice pubblica la cella all'altro thread.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+	static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+public:
+	// false se la coda è piena
+	bool push(T&& value) {
+		std::size_t tail = tail_.load(std::memory_order_relaxed);
+		if (tail - head_.load(std::memory_order_acquire) == Capacity) return false;
+		slots_[tail & (Capacity - 1)] = std::move(value);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// false se la coda è vuota
+	bool pop(T& value) {
+		std::size_t head = head_.load(std::memory_order_relaxed);
+		if (head == tail_.load(std::memory_order_acquire)) return false;
+		value = std::move(slots_[head & (Capacity - 1)]);
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	bool empty() const {
+		return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+	}
+
+private:
+	// Su linee di cache diverse: ogni indice viene scritto da un thread solo
+	alignas(64) std::atomic<std::size_t> head_{ 0 };
+	alignas(64) std::atomic<std::size_t> tail_{ 0 };
+	std::array<T, Capacity> slots_{};
+};
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "Syntax.h"
+#include "Token.h"
+
+// Ricerca del caso di un valore: tabella densa indicizzata da valore - low
+// se i valori sono abbastanza vicini, altrimenti tabella hash a
+// indirizzamento aperto. Vive nell'arena del Program, come i nodi.
+struct SwitchTable {
+	int low = 0;
+	NodeList<int> dense;        // caso per valore - low, -1 se assente
+	NodeList<int> keys;         // tabella hash: valori
+	NodeList<int> cases;        // tabella hash: caso, -1 per le celle vuote
+	int bits = 0;
+
+	// Al più metà delle celle della tabella densa resta vuota
+	static bool isDense(std::int64_t low, std::int64_t high, std::size_t count) {
+		return high - low + 1 <= static_cast<std::int64_t>(2 * count);
+	}
+
+	// Indice del caso di value, -1 se non c'è
+	int find(int value) const {
+		if (!dense.empty()) {
+			std::uint32_t k = static_cast<std::uint32_t>(value) - static_cast<std::uint32_t>(low);
+			return k < dense.size() ? dense[k] : -1;
+		}
+		std::uint32_t mask = (1u << bits) - 1;
+		for (std::uint32_t k = hash(value, bits);; k = (k + 1) & mask) {
+			if (cases[k] < 0 || keys[k] == value) return cases[k];
+		}
+	}
+
+	// values[k] è il valore del caso k; a parità di valore vince il primo
+	static SwitchTable build(Arena& arena, std::vector<int> const& values) {
+		SwitchTable table;
+		int low = values[0], high = values[0];
+		for (int v : values) {
+			if (v < low) low = v;
+			if (v > high) high = v;
+		}
+		if (isDense(low, high, values.size())) {
+			std::vector<int> dense(static_cast<std::size_t>(static_cast<std::int64_t>(high) - low + 1), -1);
+			for (std::size_t k = values.size(); k-- > 0;) dense[static_cast<std::size_t>(static_cast<std::int64_t>(values[k]) - low)] = static_cast<int>(k);
+			table.low = low;
+			table.dense = arena.copy(dense);
+			return table;
+		}
+		while ((std::size_t{ 1 } << table.bits) < 2 * values.size()) ++table.bits;
+		std::vector<int> keys(std::size_t{ 1 } << table.bits, 0);
+		std::vector<int> cases(keys.size(), -1);
+		std::uint32_t mask = (1u << table.bits) - 1;
+		for (std::size_t c = 0; c < values.size(); ++c) {
+			std::uint32_t k = hash(values[c], table.bits);
+			while (cases[k] >= 0 && keys[k] != values[c]) k = (k + 1) & mask;
+			if (cases[k] >= 0) continue;
+			keys[k] = values[c];
+			cases[k] = static_cast<int>(c);
+		}
+		table.keys = arena.copy(keys);
+		table.cases = arena.copy(cases);
+		return table;
+	}
+
+private:
+	// Hash moltiplicativo di Fibonacci
+	static std::uint32_t hash(int value, int bits) {
+		return bits == 0 ? 0 : (static_cast<std::uint32_t>(value) * 0x9E3779B1u) >> (32 - bits);
+	}
+};
+
+// Catena if/elif i cui primi rami confrontano tutti la stessa variabile con
+// una costante (`x == C` o `C == x`). Le condizioni non hanno effetti, quindi
+// leggere la variabile una volta e saltare al ramo giusto equivale a
+// valutarle in ordine (anche l'errore di identificatore non dichiarato arriva
+// alla prima lettura).
+struct Dispatch {
+	Variable const* subject = nullptr;
+	NodeList<ifStatement const*> arms;      // rami nell'ordine della catena
+	NodeList<int> values;                   // costante di ogni ramo
+	SwitchTable table;
+	ifStatement const* rest = nullptr;      // resto della catena, se c'è
+	NodeList<Statement*> otherwise;         // altrimenti l'else dell'ultimo ramo
+};
+
+// Riconosce le catene di almeno MIN_ARMS rami e le annota con la loro
+// Dispatch (ifStatement::dispatch_), usata dal tree walker e dai compilatori
+// per le VM al posto dei confronti in sequenza. Va eseguita dopo il Resolver
+// e dopo le passate che riscrivono l'AST.
+class SwitchLowering {
+
+public:
+	static constexpr std::size_t MIN_ARMS = 4;
+
+	// Restituisce il numero di catene annotate
+	static std::size_t lower(Program& program) {
+		SwitchLowering pass{ program.arena };
+		for (Statement const* st : program.statements) pass.statement(st);
+		return pass.lowered_;
+	}
+
+private:
+	explicit SwitchLowering(Arena& arena) : arena_{ arena } { }
+
+	Arena& arena_;
+	std::size_t lowered_ = 0;
+
+	void statement(Statement const* st) {
+		if (auto i = dynamic_cast<ifStatement const*>(st)) {
+			chain(i);
+		}
+		else if (auto w = dynamic_cast<whileStatement const*>(st)) {
+			for (Statement const* s : w->block) statement(s);
+		}
+	}
+
+	void chain(ifStatement const* head) {
+		Variable const* subject = nullptr;
+		std::vector<ifStatement const*> arms;
+		std::vector<int> values;
+		ifStatement const* rest = head;
+		for (; rest != nullptr; rest = rest->elifBlock) {
+			int value;
+			Variable const* v = compared(rest->condition, value);
+			if (v == nullptr || (subject != nullptr && v->slot_ != subject->slot_)) break;
+			subject = v;
+			arms.push_back(rest);
+			values.push_back(value);
+		}
+		if (arms.size() < MIN_ARMS) {
+			for (Statement const* s : head->block) statement(s);
+			if (head->elifBlock != nullptr) chain(head->elifBlock);
+			else for (Statement const* s : head->elseBlock) statement(s);
+			return;
+		}
+
+		Dispatch* d = arena_.make<Dispatch>();
+		d->subject = subject;
+		d->arms = arena_.copy(arms);
+		d->values = arena_.copy(values);
+		d->table = SwitchTable::build(arena_, values);
+		d->rest = rest;
+		if (rest == nullptr) d->otherwise = arms.back()->elseBlock;
+		head->dispatch_ = d;
+		++lowered_;
+		for (ifStatement const* arm : arms) {
+			for (Statement const* s : arm->block) statement(s);
+		}
+		if (rest != nullptr) chain(rest);
+		else for (Statement const* s : d->otherwise) statement(s);
+	}
+
+	// x == C o C == x
+	static Variable const* compared(Expression const* condition, int& value) {
+		auto rel = dynamic_cast<relExpression const*>(condition);
+		if (rel == nullptr || rel->opCode_ != Token::EQEQ) return nullptr;
+		auto v = dynamic_cast<Variable const*>(rel->left_);
+		auto c = dynamic_cast<Constant const*>(rel->right_);
+		if (v == nullptr || c == nullptr) {
+			v = dynamic_cast<Variable const*>(rel->right_);
+			c = dynamic_cast<Constant const*>(rel->left_);
+		}
+		if (v == nullptr || c == nullptr) return nullptr;
+		value = c->num_;
+		return v;
+	}
+};
@@ -1,73 +1,103 @@
-#pragma once
-
-#include <string>
-#include <sstream>
-#include <unordered_map>
-#include <vector>
-
-#include "Exception.h"
-
-class SymbolTable {
-
-public:
-	SymbolTable() = default;
-	~SymbolTable() = default;
-
-	SymbolTable(const SymbolTable& other) = delete;
-	SymbolTable& operator=(const SymbolTable& other) = delete;
-
-	// Variabili scalari
-	void setValue(std::string const& key, int value) {
-		map[key] = value;
-	}
-
-	// Get di una variabile scalare
-	int getValue(std::string const& key) const {
-		auto itr = map.find(key);
-		if (itr == map.end()) {
-			std::stringstream temp;
-			temp << "ERROR: Undeclared identifier: " << key;
-			throw EvaluationError{ temp.str() };
-		}
-		return (*map.find(key)).second;
-	}
-
-	// Liste
-	void setList(std::string const& key) {
-		listMap[key] = std::vector<int>{};
-	}
-
-	// Aggiunge un elemento alla lista
-	void appendToList(std::string const& key, int value) {
-		auto itr = listMap.find(key);
-		if (itr == listMap.end()) {
-			std::stringstream temp;
-			temp << "ERROR: Undeclared identifier: " << key;
-			throw EvaluationError{ temp.str() };
-		}
-		(*listMap.find(key)).second.push_back(value);
-	}
-
-	// Get di un elemento dalla lista
-	int getListValue(std::string const& key, int index) const {
-		auto itr = listMap.find(key);
-		if (itr == listMap.end()) {
-			std::stringstream temp;
-			temp << "ERROR: Undeclared identifier: " << key;
-			throw EvaluationError{ temp.str() };
-		}
-
-		if (index < 0 || index >= (int)(*listMap.find(key)).second.size()) {
-			std::stringstream temp;
-			temp << "ERROR: Index out of bounds: " << key << "List size: " << (*listMap.find(key)).second.size();
-			throw EvaluationError{ temp.str() };
-		}
-		return (*listMap.find(key)).second[index];
-	}
-
-private:
-	// Mappa per variabili scalari
-	std::unordered_map<std::string, int> map;
-	// Mappa per liste
-	std::unordered_map<std::string, std::vector<int>> listMap;
-};
\ No newline at end of file
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#include "Exception.h"
+
+// Variabili e liste sono indicizzate per slot (assegnati dal Resolver) e
+// salvate in vettori piatti. I nomi servono solo per i messaggi di errore.
+class SymbolTable {
+
+public:
+	explicit SymbolTable(std::vector<std::string> names)
+		: names_{ std::move(names) },
+		values_(names_.size()), defined_(names_.size()),
+		lists_(names_.size()), listDefined_(names_.size()) {
+	}
+	~SymbolTable() = default;
+
+	SymbolTable(const SymbolTable& other) = delete;
+	SymbolTable& operator=(const SymbolTable& other) = delete;
+
+	// Nuovo slot in fondo (in streaming i nomi arrivano man mano)
+	void add(std::string_view name) {
+		names_.emplace_back(name);
+		values_.push_back(0);
+		defined_.push_back(0);
+		lists_.emplace_back();
+		listDefined_.push_back(0);
+	}
+
+	// Variabili scalari
+	void setValue(int slot, int value) {
+		values_[slot] = value;
+		defined_[slot] = 1;
+	}
+
+	bool isDefined(int slot) const { return defined_[slot] != 0; }
+
+	// Get di una variabile scalare
+	int getValue(int slot) const {
+		if (!defined_[slot]) undeclared(slot);
+		return values_[slot];
+	}
+
+	// Liste
+	void setList(int slot) {
+		lists_[slot].clear();
+		listDefined_[slot] = 1;
+	}
+
+	// Aggiunge un elemento alla lista
+	void appendToList(int slot, int value) {
+		if (!listDefined_[slot]) undeclared(slot);
+		lists_[slot].push_back(value);
+	}
+
+	// Get di un elemento dalla lista
+	int getListValue(int slot, int index) const {
+		if (!listDefined_[slot]) undeclared(slot);
+
+		std::vector<int> const& list = lists_[slot];
+		if (index < 0 || index >= (int)list.size()) {
+			std::stringstream temp;
+			temp << "ERROR: Index out of bounds: " << names_[slot] << "List size: " << list.size();
+			throw EvaluationError{ temp.str() };
+		}
+		return list[index];
+	}
+
+	// Get senza controlli, per gli accessi dimostrati nei limiti da RangeAnalysis
+	int getListValueUnchecked(int slot, int index) const {
+		return lists_[slot][index];
+	}
+
+	bool isList(int slot) const { return listDefined_[slot] != 0; }
+	std::vector<int> const& list(int slot) const { return lists_[slot]; }
+
+	// Nome di uno slot (per la diagnostica)
+	std::string const& name(int slot) const { return names_[slot]; }
+	int size() const { return static_cast<int>(names_.size()); }
+
+	// Errore per uno slot letto prima di essere assegnato
+	[[noreturn]] void undeclared(int slot) const {
+		std::stringstream temp;
+		temp << "ERROR: Undeclared identifier: " << names_[slot];
+		throw EvaluationError{ temp.str() };
+	}
+
+private:
+
+	std::vector<std::string> names_;
+	// Variabili scalari: valore e flag di definizione per slot
+	std::vector<int> values_;
+	std::vector<std::uint8_t> defined_;
+	// Liste per slot
+	std::vector<std::vector<int>> lists_;
+	std::vector<std::uint8_t> listDefined_;
+};
@@ -1,8 +1,8 @@
-#include <iostream>
-
-#include "Token.h"
-
-std::ostream& operator<<(std::ostream& os, const Token& t) {
-	os << "(" << Token::tag2string[t.tag] << ",\"" << t.word << "\")";
-	return os;
-};
+#include <iostream>
+
+#include "Token.h"
+
+std::ostream& printToken(std::ostream& os, const Token& t, std::string_view word) {
+	os << "(" << Token::tag2string[t.tag] << ",\"" << word << "\")";
+	return os;
+};
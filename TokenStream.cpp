@@ -0,0 +1,37 @@
+#include <algorithm>
+#include <cstring>
+
+#include "TokenStream.h"
+
+std::string TokenStream::word(Token const& t) const {
+    switch (t.tag) {
+    case Token::ID:
+        return std::string{ symbols_.name(t.value) };
+    case Token::CONST:
+        if (t.offset + t.length <= source_.size())
+            return std::string{ source_.substr(t.offset, t.length) };
+        return std::to_string(t.value);
+    case Token::NEWLINE:
+        return "\\n";
+    default:
+        return Token::id2word[t.tag];
+    }
+}
+
+std::pair<int, int> TokenStream::location(Token const& t) const {
+    if (lineStarts_.empty()) {
+        // Indice delle linee costruito solo alla prima richiesta (tipicamente un errore)
+        lineStarts_.push_back(0);
+        const char* base = source_.data();
+        const char* p = base;
+        const char* end = base + source_.size();
+        while ((p = static_cast<const char*>(std::memchr(p, '\n', end - p))) != nullptr) {
+            ++p;
+            lineStarts_.push_back(static_cast<std::uint32_t>(p - base));
+        }
+    }
+    auto itr = std::upper_bound(lineStarts_.begin(), lineStarts_.end(), t.offset);
+    int line = static_cast<int>(itr - lineStarts_.begin());
+    int column = static_cast<int>(t.offset - *(itr - 1)) + 1;
+    return { line, column };
+}
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Token.h"
+
+// Tabella dei simboli internati: ogni identificatore distinto riceve un id denso.
+// I nomi sono copiati una sola volta, quindi restano validi anche senza il sorgente.
+class SymbolInterner {
+public:
+	std::int32_t intern(std::string_view name) {
+		auto itr = ids_.find(name);
+		if (itr != ids_.end()) return itr->second;
+		std::int32_t id = static_cast<std::int32_t>(names_.size());
+		names_.emplace_back(name);
+		ids_.emplace(names_.back(), id);
+		return id;
+	}
+
+	std::string_view name(std::int32_t id) const { return names_[id]; }
+	std::size_t size() const { return names_.size(); }
+
+private:
+	std::deque<std::string> names_;  // deque: le string_view nella mappa restano stabili
+	std::unordered_map<std::string_view, std::int32_t> ids_;
+};
+
+// Stream di token in formato struct-of-arrays (13 byte per token).
+// I token vengono ricostruiti in un Token da 16 byte solo quando letti.
+class TokenStream {
+public:
+	explicit TokenStream(std::string_view source = {}) : source_{ source } {}
+
+	void reserve(std::size_t n) {
+		tags_.reserve(n);
+		offsets_.reserve(n);
+		lengths_.reserve(n);
+		values_.reserve(n);
+	}
+
+	void push(int tag, std::uint32_t offset, std::uint32_t length, std::int32_t value = 0) {
+		tags_.push_back(static_cast<std::uint8_t>(tag));
+		offsets_.push_back(offset);
+		lengths_.push_back(length);
+		values_.push_back(value);
+	}
+
+	std::size_t size() const { return tags_.size(); }
+	int tag(std::size_t i) const { return tags_[i]; }
+
+	Token operator[](std::size_t i) const {
+		return Token{ tags_[i], offsets_[i], lengths_[i], values_[i] };
+	}
+
+	SymbolInterner& symbols() { return symbols_; }
+	SymbolInterner const& symbols() const { return symbols_; }
+
+	// Testo del token per messaggi di errore e debug
+	std::string word(Token const& t) const;
+
+	// Linea e colonna (da 1) del token, dall'indice delle linee costruito al primo uso
+	std::pair<int, int> location(Token const& t) const;
+
+	// Memoria occupata dai token (escluso il sorgente)
+	std::size_t bytes() const {
+		return tags_.capacity() * sizeof(std::uint8_t)
+			+ (offsets_.capacity() + lengths_.capacity()) * sizeof(std::uint32_t)
+			+ values_.capacity() * sizeof(std::int32_t);
+	}
+
+private:
+	std::string_view source_;
+	std::vector<std::uint8_t> tags_;
+	std::vector<std::uint32_t> offsets_;
+	std::vector<std::uint32_t> lengths_;
+	std::vector<std::int32_t> values_;
+	SymbolInterner symbols_;
+	mutable std::vector<std::uint32_t> lineStarts_;  // offset di inizio di ogni linea
+};
+
+// Sorgente di token letta dal Parser un token alla volta
+class TokenSource {
+public:
+	virtual ~TokenSource() = default;
+
+	// Prossimo token; false a fine input
+	virtual bool next(Token& t) = 0;
+
+	virtual std::string word(Token const& t) const = 0;
+	virtual std::pair<int, int> location(Token const& t) const = 0;
+	virtual SymbolInterner const& symbols() const = 0;
+};
+
+// Lettura sequenziale di un TokenStream già completo
+class TokenStreamSource : public TokenSource {
+public:
+	explicit TokenStreamSource(TokenStream const& stream) : stream_{ stream } {}
+
+	bool next(Token& t) override {
+		if (index_ >= stream_.size()) return false;
+		t = stream_[index_++];
+		return true;
+	}
+
+	std::string word(Token const& t) const override { return stream_.word(t); }
+	std::pair<int, int> location(Token const& t) const override { return stream_.location(t); }
+	SymbolInterner const& symbols() const override { return stream_.symbols(); }
+
+private:
+	TokenStream const& stream_;
+	std::size_t index_ = 0;
+};
+
+// Buffer circolare a capacità fissa tra StreamLexer e Parser.
+// Oltre al token conserva linea e colonna, che in streaming non si possono ricalcolare.
+class TokenRing {
+public:
+	struct Entry {
+		Token token;
+		int line;
+		int column;
+	};
+
+	// capacity viene arrotondata alla potenza di 2 successiva
+	explicit TokenRing(std::size_t capacity) {
+		std::size_t n = 1;
+		while (n < capacity) n <<= 1;
+		entries_.resize(n);
+		mask_ = n - 1;
+	}
+
+	bool empty() const { return count_ == 0; }
+	bool full() const { return count_ == entries_.size(); }
+	std::size_t size() const { return count_; }
+
+	void push(Entry const& e) {
+		entries_[(head_ + count_) & mask_] = e;
+		++count_;
+	}
+
+	Entry pop() {
+		Entry e = entries_[head_];
+		head_ = (head_ + 1) & mask_;
+		--count_;
+		return e;
+	}
+
+	Entry const& operator[](std::size_t i) const { return entries_[(head_ + i) & mask_]; }
+
+private:
+	std::vector<Entry> entries_;
+	std::size_t mask_ = 0;
+	std::size_t head_ = 0;
+	std::size_t count_ = 0;
+};
+
+// Cursore usato dal Parser per scorrere i token uno alla volta
+class TokenCursor {
+public:
+	explicit TokenCursor(TokenSource& source) : source_{ &source } { load(); }
+
+	Token const& operator*() const { return current_; }
+	Token const* operator->() const { return &current_; }
+
+	TokenCursor& operator++() {
+		load();
+		return *this;
+	}
+
+	bool atEnd() const { return atEnd_; }
+
+private:
+	// Oltre la fine resta visibile l'ultimo token (ENDMARKER)
+	void load() {
+		if (!source_->next(current_)) atEnd_ = true;
+	}
+
+	TokenSource* source_;
+	Token current_{ Token::ENDMARKER, 0, 0 };
+	bool atEnd_ = false;
+};
@@ -0,0 +1,307 @@
+#pragma once
+
+#include <climits>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Visitor.h"
+#include "Syntax.h"
+#include "Token.h"
+
+// Traduce un Program (già risolto dal Resolver) in un sorgente C autonomo.
+// Le variabili diventano locali di main (con un flag per l'errore di
+// identificatore non dichiarato), le liste array di int che crescono e print
+// passa da un buffer. Ogni sotto-espressione viene calcolata in un temporaneo,
+// così l'ordine di valutazione (e quindi il primo errore) è quello
+// dell'interprete; gli errori hanno lo stesso testo e lo stesso exit code.
+class TranspileVisitor : public Visitor {
+
+public:
+	TranspileVisitor(std::ostream& out) : out_{ out } { }
+	~TranspileVisitor() = default;
+
+	void visit(Program const& p) override {
+		out_ << PRELUDE;
+		out_ << "int main(void)\n{\n";
+		for (std::string_view name : p.symbols) {
+			out_ << "    int v_" << name << " = 0;\n";
+			out_ << "    char d_" << name << " = 0;\n";
+			out_ << "    list l_" << name << " = { 0, 0, 0, 0 };\n";
+		}
+		depth_ = 1;
+		for (Statement* statement : p.statements) {
+			// break/continue fuori da un while saltano alla fine dello statement
+			int label = labels_++;
+			topLabel_ = label;
+			statement->accept(*this);
+			line() << "end" << label << ": ;\n";
+		}
+		out_ << "    out_flush();\n    return 0;\n}\n";
+	}
+
+	void visit(Definition const& d) override {
+		std::string value = expression(*d.expression_);
+		line() << "v_" << d.variable_->id_ << " = " << value << ";\n";
+		line() << "d_" << d.variable_->id_ << " = 1;\n";
+	}
+
+	void visit(Expression const& o) override {
+		throw std::runtime_error("ERROR: Expression visit should not be called.");
+	}
+
+	void visit(ifStatement const& i) override {
+		std::string condition = expression(*i.condition);
+		line() << "if (" << condition << ") {\n";
+		block(i.block);
+		if (i.elifBlock != nullptr) {
+			line() << "} else {\n";
+			++depth_;
+			i.elifBlock->accept(*this);
+			--depth_;
+		}
+		else if (!i.elseBlock.empty()) {
+			line() << "} else {\n";
+			block(i.elseBlock);
+		}
+		line() << "}\n";
+	}
+
+	// La condizione sta dentro il ciclo: continue la ricalcola
+	void visit(whileStatement const& w) override {
+		line() << "for (;;) {\n";
+		++depth_;
+		++loops_;
+		std::string condition = expression(*w.condition);
+		line() << "if (!" << condition << ") break;\n";
+		--depth_;
+		block(w.block);
+		--loops_;
+		line() << "}\n";
+	}
+
+	void visit(Break const& b) override {
+		if (loops_ > 0) line() << "break;\n";
+		else line() << "goto end" << topLabel_ << ";\n";
+	}
+
+	void visit(Continue const& c) override {
+		if (loops_ > 0) line() << "continue;\n";
+		else line() << "goto end" << topLabel_ << ";\n";
+	}
+
+	void visit(Print const& p) override {
+		std::string value = expression(*p.expr_);
+		line() << "out_int(" << value << ");\n";
+	}
+
+	void visit(listInit const& l) override {
+		line() << "list_init(&l_" << l.id_ << ");\n";
+	}
+
+	void visit(listAppend const& l) override {
+		std::string value = expression(*l.expr_);
+		line() << "list_append(&l_" << l.id_ << ", \"" << l.id_ << "\", " << value << ");\n";
+	}
+
+	// or/and: il ramo destro viene calcolato solo se serve
+	void visit(orExpr const& e) override {
+		std::string l = expression(*e.left_);
+		std::string t = temp();
+		line() << "int " << t << ";\n";
+		line() << "if (" << l << ") " << t << " = 1;\n";
+		line() << "else {\n";
+		++depth_;
+		std::string r = expression(*e.right_);
+		line() << t << " = " << r << " != 0;\n";
+		--depth_;
+		line() << "}\n";
+		result_ = t;
+	}
+
+	void visit(andExpr const& e) override {
+		std::string l = expression(*e.left_);
+		std::string t = temp();
+		line() << "int " << t << ";\n";
+		line() << "if (!" << l << ") " << t << " = 0;\n";
+		line() << "else {\n";
+		++depth_;
+		std::string r = expression(*e.right_);
+		line() << t << " = " << r << " != 0;\n";
+		--depth_;
+		line() << "}\n";
+		result_ = t;
+	}
+
+	void visit(relExpression const& e) override {
+		std::string l = expression(*e.left_);
+		std::string r = expression(*e.right_);
+		const char* op = nullptr;
+		switch (e.opCode_) {
+		case Token::LT:  op = " < "; break;
+		case Token::LTE: op = " <= "; break;
+		case Token::GT:  op = " > "; break;
+		case Token::GTE: op = " >= "; break;
+		case Token::EQEQ: op = " == "; break;
+		case Token::NEQ:  op = " != "; break;
+		default: throw std::runtime_error("ERROR: Unknown relational operator.");
+		}
+		define("(" + l + op + r + ")");
+	}
+
+	// + - * in unsigned: l'overflow fa il giro come nell'interprete, senza UB in C
+	void visit(mathExpression const& e) override {
+		std::string l = expression(*e.left_);
+		std::string r = expression(*e.right_);
+		switch (e.opCode_) {
+		case Token::ADD: define("(int)((unsigned)" + l + " + (unsigned)" + r + ")"); break;
+		case Token::SUB: define("(int)((unsigned)" + l + " - (unsigned)" + r + ")"); break;
+		case Token::MUL: define("(int)((unsigned)" + l + " * (unsigned)" + r + ")"); break;
+		case Token::INTDIV: define("div_int(" + l + ", " + r + ")"); break;
+		default: throw std::runtime_error("ERROR: Unknown math operator.");
+		}
+	}
+
+	void visit(unaryExpression const& e) override {
+		std::string v = expression(*e.operand_);
+		if (e.opCode_ == Token::SUB) define("(int)(0u - (unsigned)" + v + ")");
+		else if (e.opCode_ == Token::NOT) define("(" + v + " == 0)");
+		else throw std::runtime_error("ERROR: Unknown unary operator.");
+	}
+
+	void visit(Variable const& v) override {
+		line() << "if (!d_" << v.id_ << ") undeclared(\"" << v.id_ << "\");\n";
+		result_ = "v_" + std::string{ v.id_ };
+	}
+
+	void visit(Constant const& c) override {
+		// dopo il ConstantFolder le costanti possono essere negative
+		if (c.num_ == INT_MIN) result_ = "(-2147483647 - 1)";
+		else if (c.num_ < 0) result_ = "(" + std::to_string(c.num_) + ")";
+		else result_ = std::to_string(c.num_);
+	}
+
+	void visit(listAccess const& e) override {
+		std::string index = expression(*e.index_);
+		if (e.inBounds_) {
+			define("l_" + std::string{ e.id_ } + ".data[" + index + "]");
+			return;
+		}
+		define("list_get(&l_" + std::string{ e.id_ } + ", \"" + std::string{ e.id_ } + "\", " + index + ")");
+	}
+
+private:
+	std::ostream& out_;
+	std::string result_;
+	int depth_ = 0;
+	int loops_ = 0;
+	int temps_ = 0;
+	int labels_ = 0;
+	int topLabel_ = 0;
+
+	std::ostream& line() {
+		for (int k = 0; k < depth_; ++k) out_ << "    ";
+		return out_;
+	}
+
+	void block(NodeList<Statement*> const& statements) {
+		++depth_;
+		for (auto* st : statements) st->accept(*this);
+		--depth_;
+	}
+
+	// Emette il codice dell'espressione e restituisce il nome del valore
+	std::string expression(Expression const& e) {
+		e.accept(*this);
+		return result_;
+	}
+
+	std::string temp() {
+		return "t" + std::to_string(temps_++);
+	}
+
+	void define(std::string const& value) {
+		result_ = temp();
+		line() << "int " << result_ << " = " << value << ";\n";
+	}
+
+	// Supporto a runtime del programma generato
+	static constexpr const char* PRELUDE =
+		"#include <stdio.h>\n"
+		"#include <stdlib.h>\n"
+		"#include <string.h>\n"
+		"\n"
+		"static char out_buf[1 << 16];\n"
+		"static size_t out_len;\n"
+		"\n"
+		"static void out_flush(void)\n"
+		"{\n"
+		"    fwrite(out_buf, 1, out_len, stdout);\n"
+		"    fflush(stdout);\n"
+		"    out_len = 0;\n"
+		"}\n"
+		"\n"
+		"static void out_int(int v)\n"
+		"{\n"
+		"    char tmp[12];\n"
+		"    int n = 0;\n"
+		"    unsigned u = v < 0 ? 0u - (unsigned)v : (unsigned)v;\n"
+		"    if (out_len > sizeof out_buf - 16) out_flush();\n"
+		"    do { tmp[n++] = (char)('0' + u % 10); u /= 10; } while (u != 0);\n"
+		"    if (v < 0) out_buf[out_len++] = '-';\n"
+		"    while (n > 0) out_buf[out_len++] = tmp[--n];\n"
+		"    out_buf[out_len++] = '\\n';\n"
+		"}\n"
+		"\n"
+		"static void fail(const char* message, const char* name, const char* suffix)\n"
+		"{\n"
+		"    out_flush();\n"
+		"    fputs(message, stderr);\n"
+		"    fputs(name, stderr);\n"
+		"    fputs(suffix, stderr);\n"
+		"    exit(EXIT_FAILURE);\n"
+		"}\n"
+		"\n"
+		"static void undeclared(const char* name)\n"
+		"{\n"
+		"    fail(\"ERROR: Undeclared identifier: \", name, \"\\n\");\n"
+		"}\n"
+		"\n"
+		"static int div_int(int l, int r)\n"
+		"{\n"
+		"    if (r == 0) fail(\"Something odd happened during parsing, got: \\n\", \"ERROR: Division by zero.\", \"\\n\");\n"
+		"    return l / r;\n"
+		"}\n"
+		"\n"
+		"typedef struct { int* data; int size; int capacity; char defined; } list;\n"
+		"\n"
+		"static void list_init(list* l)\n"
+		"{\n"
+		"    l->size = 0;\n"
+		"    l->defined = 1;\n"
+		"}\n"
+		"\n"
+		"static void list_append(list* l, const char* name, int v)\n"
+		"{\n"
+		"    if (!l->defined) undeclared(name);\n"
+		"    if (l->size == l->capacity) {\n"
+		"        l->capacity = l->capacity ? l->capacity * 2 : 8;\n"
+		"        l->data = (int*)realloc(l->data, sizeof(int) * (size_t)l->capacity);\n"
+		"        if (l->data == NULL) { out_flush(); fputs(\"std::bad_alloc\\n\", stderr); exit(EXIT_FAILURE); }\n"
+		"    }\n"
+		"    l->data[l->size++] = v;\n"
+		"}\n"
+		"\n"
+		"static int list_get(list* l, const char* name, int i)\n"
+		"{\n"
+		"    if (!l->defined) undeclared(name);\n"
+		"    if (i < 0 || i >= l->size) {\n"
+		"        out_flush();\n"
+		"        fprintf(stderr, \"ERROR: Index out of bounds: %sList size: %d\\n\", name, l->size);\n"
+		"        exit(EXIT_FAILURE);\n"
+		"    }\n"
+		"    return l->data[i];\n"
+		"}\n"
+		"\n";
+};
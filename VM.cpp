@@ -0,0 +1,114 @@
+#include <stdexcept>
+#include <vector>
+
+#include "VM.h"
+#include "MagicDivision.h"
+
+#if defined(__GNUC__) || defined(__clang__)
+#define STACK_VM_COMPUTED_GOTO 1
+#endif
+
+void VM::run(Chunk const& chunk) {
+	std::vector<int> stack(chunk.maxStack + 1);
+	int* sp = stack.data();
+	// Le variabili scalari stanno in array locali (come nella VM a registri):
+	// la SymbolTable serve solo per le liste e per i messaggi di errore.
+	// BytecodeCompiler mette un CHECK prima delle letture non garantite, le
+	// altre istruzioni leggono direttamente v
+	std::vector<int> values(symbolTable_.size());
+	std::vector<char> defined(symbolTable_.size());
+	int* v = values.data();
+	char* d = defined.data();
+	const Instruction* code = chunk.code.data();
+	const Instruction* ip = code;
+
+#if defined(STACK_VM_COMPUTED_GOTO)
+	static void* const labels[] = {
+#define STACK_OP_LABEL(name) &&op_##name,
+		STACK_OPS(STACK_OP_LABEL)
+#undef STACK_OP_LABEL
+	};
+#define OP(name) op_##name:
+#define NEXT() goto *labels[static_cast<int>(ip->op)]
+	NEXT();
+#else
+#define OP(name) case Op::name:
+#define NEXT() goto dispatch
+dispatch:
+	switch (ip->op) {
+#endif
+
+	OP(CONST) *sp++ = ip->arg; ++ip; NEXT();
+	OP(CHECK) if (!d[ip->arg]) symbolTable_.undeclared(ip->arg); ++ip; NEXT();
+	OP(LOAD) *sp++ = v[ip->arg]; ++ip; NEXT();
+	OP(LOAD_LOAD) sp[0] = v[ip->arg]; sp[1] = v[ip->operand]; sp += 2; ++ip; NEXT();
+	OP(STORE) v[ip->arg] = *--sp; d[ip->arg] = 1; ++ip; NEXT();
+	OP(INC) v[ip->arg] += ip->operand; ++ip; NEXT();
+	OP(ADD) --sp; sp[-1] = sp[-1] + sp[0]; ++ip; NEXT();
+	OP(SUB) --sp; sp[-1] = sp[-1] - sp[0]; ++ip; NEXT();
+	OP(MUL) --sp; sp[-1] = sp[-1] * sp[0]; ++ip; NEXT();
+	OP(DIV)
+		--sp;
+		if (sp[0] == 0) throw std::runtime_error("ERROR: Division by zero.");
+		sp[-1] = sp[-1] / sp[0]; ++ip; NEXT();
+	OP(ADD_CONST) sp[-1] = sp[-1] + ip->arg; ++ip; NEXT();
+	OP(SUB_CONST) sp[-1] = sp[-1] - ip->arg; ++ip; NEXT();
+	OP(MUL_CONST) sp[-1] = sp[-1] * ip->arg; ++ip; NEXT();
+	OP(DIV_CONST)
+		sp[-1] = ip->slot >= 0 ? MagicDivisor::divide(sp[-1], ip->arg, ip->operand, ip->slot) : sp[-1] / ip->arg;
+		++ip; NEXT();
+	OP(ADD_LOAD) sp[-1] = sp[-1] + v[ip->arg]; ++ip; NEXT();
+	OP(SUB_LOAD) sp[-1] = sp[-1] - v[ip->arg]; ++ip; NEXT();
+	OP(MUL_LOAD) sp[-1] = sp[-1] * v[ip->arg]; ++ip; NEXT();
+	OP(DIV_LOAD) {
+		int r = v[ip->arg];
+		if (r == 0) throw std::runtime_error("ERROR: Division by zero.");
+		sp[-1] = sp[-1] / r; ++ip; NEXT();
+	}
+	OP(ADD_STORE) sp -= 2; v[ip->arg] = sp[0] + sp[1]; d[ip->arg] = 1; ++ip; NEXT();
+	OP(SUB_STORE) sp -= 2; v[ip->arg] = sp[0] - sp[1]; d[ip->arg] = 1; ++ip; NEXT();
+	OP(MUL_STORE) sp -= 2; v[ip->arg] = sp[0] * sp[1]; d[ip->arg] = 1; ++ip; NEXT();
+	OP(LT)  --sp; sp[-1] = sp[-1] < sp[0]; ++ip; NEXT();
+	OP(LTE) --sp; sp[-1] = sp[-1] <= sp[0]; ++ip; NEXT();
+	OP(GT)  --sp; sp[-1] = sp[-1] > sp[0]; ++ip; NEXT();
+	OP(GTE) --sp; sp[-1] = sp[-1] >= sp[0]; ++ip; NEXT();
+	OP(EQ)  --sp; sp[-1] = sp[-1] == sp[0]; ++ip; NEXT();
+	OP(NEQ) --sp; sp[-1] = sp[-1] != sp[0]; ++ip; NEXT();
+	OP(NEG) sp[-1] = -sp[-1]; ++ip; NEXT();
+	OP(NOT) sp[-1] = sp[-1] == 0; ++ip; NEXT();
+	OP(BOOL) sp[-1] = sp[-1] != 0; ++ip; NEXT();
+	OP(JUMP) ip = code + ip->arg; NEXT();
+	OP(JUMP_IF_FALSE) ip = *--sp == 0 ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_TRUE) ip = *--sp != 0 ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_LT)  sp -= 2; ip = sp[0] < sp[1] ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_LTE) sp -= 2; ip = sp[0] <= sp[1] ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_GT)  sp -= 2; ip = sp[0] > sp[1] ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_GTE) sp -= 2; ip = sp[0] >= sp[1] ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_EQ)  sp -= 2; ip = sp[0] == sp[1] ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_NEQ) sp -= 2; ip = sp[0] != sp[1] ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_LT_CONST)  --sp; ip = sp[0] < ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_LTE_CONST) --sp; ip = sp[0] <= ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_GT_CONST)  --sp; ip = sp[0] > ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_GTE_CONST) --sp; ip = sp[0] >= ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_EQ_CONST)  --sp; ip = sp[0] == ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_NEQ_CONST) --sp; ip = sp[0] != ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_SLOT_LT)  ip = v[ip->slot] < ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_SLOT_LTE) ip = v[ip->slot] <= ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_SLOT_GT)  ip = v[ip->slot] > ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_SLOT_GTE) ip = v[ip->slot] >= ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_SLOT_EQ)  ip = v[ip->slot] == ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(JUMP_IF_SLOT_NEQ) ip = v[ip->slot] != ip->operand ? code + ip->arg : ip + 1; NEXT();
+	OP(LIST_NEW) symbolTable_.setList(ip->arg); ++ip; NEXT();
+	OP(LIST_APPEND) symbolTable_.appendToList(ip->arg, *--sp); ++ip; NEXT();
+	OP(LIST_GET) sp[-1] = symbolTable_.getListValue(ip->arg, sp[-1]); ++ip; NEXT();
+	OP(LIST_GET_UNCHECKED) sp[-1] = symbolTable_.getListValueUnchecked(ip->arg, sp[-1]); ++ip; NEXT();
+	OP(PRINT) console_.print(*--sp); ++ip; NEXT();
+	OP(SWITCH) ip = code + chunk.tables[ip->arg].target(*--sp); NEXT();
+	OP(HALT) return;
+
+#if !defined(STACK_VM_COMPUTED_GOTO)
+	}
+#endif
+#undef OP
+#undef NEXT
+}
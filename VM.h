@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Bytecode.h"
+#include "OutputSink.h"
+#include "SymbolTable.h"
+
+// VM a stack che esegue il bytecode prodotto da BytecodeCompiler.
+// Stato (variabili e liste) e messaggi di errore sono quelli della SymbolTable,
+// quindi il comportamento è identico a quello di EvaluationVisitor.
+class VM {
+
+public:
+	VM(SymbolTable& st, OutputSink& con)
+		: symbolTable_{ st }, console_{ con } {
+	}
+
+	void run(Chunk const& chunk);
+
+private:
+	SymbolTable& symbolTable_;
+	OutputSink& console_;
+};
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Esegue work(k) per k in [0, count) su un gruppo di thread. Ogni thread ha
+// la sua coda di lavori (distribuiti a turno, così i primi finiscono per
+// primi) e la consuma dalla testa; quando è vuota ruba dal fondo di quella
+// degli altri, così un lavoro lungo non lascia fermi i thread che hanno
+// finito. I lavori non ne creano altri: un thread termina quando tutte le code
+// sono vuote. Il distruttore aspetta la fine di tutti i lavori.
+class WorkStealingPool {
+
+public:
+	WorkStealingPool(std::size_t count, unsigned int threads, std::function<void(std::size_t)> work)
+		: work_{ std::move(work) }, queues_(threads == 0 ? 1 : threads) {
+		for (std::size_t k = 0; k < count; ++k) queues_[k % queues_.size()].jobs.push_back(k);
+		for (std::size_t t = 0; t < queues_.size(); ++t) threads_.emplace_back([this, t] { run(t); });
+	}
+
+	~WorkStealingPool() {
+		for (std::thread& thread : threads_) thread.join();
+	}
+
+	WorkStealingPool(WorkStealingPool const&) = delete;
+	WorkStealingPool& operator=(WorkStealingPool const&) = delete;
+
+private:
+	struct Queue {
+		std::mutex mutex;
+		std::deque<std::size_t> jobs;
+	};
+
+	std::function<void(std::size_t)> work_;
+	std::vector<Queue> queues_;
+	std::vector<std::thread> threads_;
+
+	void run(std::size_t self) {
+		std::size_t job;
+		while (take(self, job)) work_(job);
+	}
+
+	bool take(std::size_t self, std::size_t& job) {
+		{
+			Queue& own = queues_[self];
+			std::lock_guard<std::mutex> lock{ own.mutex };
+			if (!own.jobs.empty()) {
+				job = own.jobs.front();
+				own.jobs.pop_front();
+				return true;
+			}
+		}
+		for (std::size_t k = 1; k < queues_.size(); ++k) {
+			Queue& victim = queues_[(self + k) % queues_.size()];
+			std::lock_guard<std::mutex> lock{ victim.mutex };
+			if (!victim.jobs.empty()) {
+				job = victim.jobs.back();
+				victim.jobs.pop_back();
+				return true;
+			}
+		}
+		return false;
+	}
+};
@@ -0,0 +1,48 @@
+#!/bin/sh
+# Genera N script piccoli e confronta un processo per script con --batch a
+# 1, 2, 4, ... thread e col numero di core: tempo totale e speedup
+# rispetto a --batch --jobs 1.
+# Uso: benchmarks/batch.sh <interprete> [N]
+interp=$1
+count=${2:-2000}
+dir=${TMPDIR:-/tmp}/batch.$$
+mkdir -p "$dir"
+k=0
+while [ $k -lt "$count" ]; do
+	cat > "$dir/s$k.py" <<SCRIPT
+n = $k
+total = 0
+i = 0
+while i < 3000:
+    total = total + (i * n) // 7
+    i = i + 1
+l = list()
+l.append(total)
+print(l[0])
+SCRIPT
+	echo "$dir/s$k.py" >> "$dir/manifest"
+	k=$((k + 1))
+done
+
+now() { date +%s%N; }
+start=$(now)
+while read -r script; do "$interp" "$script"; done < "$dir/manifest" > "$dir/expected"
+printf '%-20s %8d ms\n' "process per script" $(( ($(now) - start) / 1000000 ))
+
+cores=$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1)
+list=""
+threads=1
+while [ $threads -lt "$cores" ]; do
+	list="$list $threads"
+	threads=$((threads * 2))
+done
+base=0
+for threads in $list $cores; do
+	start=$(now)
+	"$interp" --batch --jobs $threads "$dir/manifest" > "$dir/got"
+	ms=$(( ($(now) - start) / 1000000 ))
+	[ $base -eq 0 ] && base=$ms
+	cmp -s "$dir/expected" "$dir/got" || echo "output differs with $threads threads"
+	printf '%-20s %8d ms %6s x\n' "--batch --jobs $threads" $ms "$(awk -v b=$base -v t=$ms 'BEGIN { printf "%.2f", b / (t > 0 ? t : 1) }')"
+done
+rm -rf "$dir"
@@ -0,0 +1,17 @@
+n = 0
+total = 0
+squares = 0
+while n < 3000000:
+    total = total + n * 5
+    squares = squares - 7
+    n = n + 1
+print(total)
+print(squares)
+i = 0
+h = 0
+while i < 400000:
+    h = h + i * 13 // 7 - i // 3
+    if h > 1000000:
+        h = h - 1000000
+    i = i + 1
+print(h)
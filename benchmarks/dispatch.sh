@@ -0,0 +1,32 @@
+#!/bin/sh
+# Costo del dispatch: esegue counting_loops.py (o gli script indicati), dove
+# il tempo è quasi tutto interpretazione di cicli su variabili scalari, con il
+# tree walker, la VM a stack (--vm) e la VM a registri (--reg), con e senza
+# -O. Stampa il tempo di esecuzione (riga "Execution" di --stats, migliore di
+# RUNS) e lo speedup rispetto al tree walker.
+# Uso: benchmarks/dispatch.sh <interprete> [benchmark.py ...]
+interp=$1
+shift
+runs=${RUNS:-5}
+[ $# -eq 0 ] && set -- "$(dirname "$0")/counting_loops.py"
+
+best() {
+	b=""
+	for run in $(seq "$runs"); do
+		ms=$("$interp" "$@" --stats 2>&1 >/dev/null | sed -n 's/^Execution: \(.*\) ms$/\1/p')
+		b=$(awk -v a="$b" -v b="$ms" 'BEGIN { print (a == "" || b + 0 < a + 0) ? b : a }')
+	done
+	echo "$b"
+}
+
+printf '%-20s %-3s %10s %10s %10s %7s %7s\n' benchmark "" "tree ms" "vm ms" "reg ms" "vm x" "reg x"
+for script in "$@"; do
+	for level in "" "-O"; do
+		tree=$(best $level "$script")
+		vm=$(best --vm $level "$script")
+		reg=$(best --reg $level "$script")
+		printf '%-20s %-3s %10.1f %10.1f %10.1f %7.1f %7.1f\n' "$(basename "$script")" "$level" \
+			"$tree" "$vm" "$reg" "$(awk -v a="$tree" -v b="$vm" 'BEGIN { print a / b }')" \
+			"$(awk -v a="$tree" -v b="$reg" 'BEGIN { print a / b }')"
+	done
+done
@@ -0,0 +1,816 @@
+i = 0
+s = 0
+while i < 200000:
+    x = i - i // 211 * 211
+    if x == 0:
+        s = s + 1
+    elif x == 1:
+        s = s + 8
+    elif x == 2:
+        s = s + 2
+    elif x == 3:
+        s = s + 9
+    elif x == 4:
+        s = s + 3
+    elif x == 5:
+        s = s + 10
+    elif x == 6:
+        s = s + 4
+    elif x == 7:
+        s = s + 11
+    elif x == 8:
+        s = s + 5
+    elif x == 9:
+        s = s + 12
+    elif x == 10:
+        s = s + 6
+    elif x == 11:
+        s = s + 13
+    elif x == 12:
+        s = s + 7
+    elif x == 13:
+        s = s + 1
+    elif x == 14:
+        s = s + 8
+    elif x == 15:
+        s = s + 2
+    elif x == 16:
+        s = s + 9
+    elif x == 17:
+        s = s + 3
+    elif x == 18:
+        s = s + 10
+    elif x == 19:
+        s = s + 4
+    elif x == 20:
+        s = s + 11
+    elif x == 21:
+        s = s + 5
+    elif x == 22:
+        s = s + 12
+    elif x == 23:
+        s = s + 6
+    elif x == 24:
+        s = s + 13
+    elif x == 25:
+        s = s + 7
+    elif x == 26:
+        s = s + 1
+    elif x == 27:
+        s = s + 8
+    elif x == 28:
+        s = s + 2
+    elif x == 29:
+        s = s + 9
+    elif x == 30:
+        s = s + 3
+    elif x == 31:
+        s = s + 10
+    elif x == 32:
+        s = s + 4
+    elif x == 33:
+        s = s + 11
+    elif x == 34:
+        s = s + 5
+    elif x == 35:
+        s = s + 12
+    elif x == 36:
+        s = s + 6
+    elif x == 37:
+        s = s + 13
+    elif x == 38:
+        s = s + 7
+    elif x == 39:
+        s = s + 1
+    elif x == 40:
+        s = s + 8
+    elif x == 41:
+        s = s + 2
+    elif x == 42:
+        s = s + 9
+    elif x == 43:
+        s = s + 3
+    elif x == 44:
+        s = s + 10
+    elif x == 45:
+        s = s + 4
+    elif x == 46:
+        s = s + 11
+    elif x == 47:
+        s = s + 5
+    elif x == 48:
+        s = s + 12
+    elif x == 49:
+        s = s + 6
+    elif x == 50:
+        s = s + 13
+    elif x == 51:
+        s = s + 7
+    elif x == 52:
+        s = s + 1
+    elif x == 53:
+        s = s + 8
+    elif x == 54:
+        s = s + 2
+    elif x == 55:
+        s = s + 9
+    elif x == 56:
+        s = s + 3
+    elif x == 57:
+        s = s + 10
+    elif x == 58:
+        s = s + 4
+    elif x == 59:
+        s = s + 11
+    elif x == 60:
+        s = s + 5
+    elif x == 61:
+        s = s + 12
+    elif x == 62:
+        s = s + 6
+    elif x == 63:
+        s = s + 13
+    elif x == 64:
+        s = s + 7
+    elif x == 65:
+        s = s + 1
+    elif x == 66:
+        s = s + 8
+    elif x == 67:
+        s = s + 2
+    elif x == 68:
+        s = s + 9
+    elif x == 69:
+        s = s + 3
+    elif x == 70:
+        s = s + 10
+    elif x == 71:
+        s = s + 4
+    elif x == 72:
+        s = s + 11
+    elif x == 73:
+        s = s + 5
+    elif x == 74:
+        s = s + 12
+    elif x == 75:
+        s = s + 6
+    elif x == 76:
+        s = s + 13
+    elif x == 77:
+        s = s + 7
+    elif x == 78:
+        s = s + 1
+    elif x == 79:
+        s = s + 8
+    elif x == 80:
+        s = s + 2
+    elif x == 81:
+        s = s + 9
+    elif x == 82:
+        s = s + 3
+    elif x == 83:
+        s = s + 10
+    elif x == 84:
+        s = s + 4
+    elif x == 85:
+        s = s + 11
+    elif x == 86:
+        s = s + 5
+    elif x == 87:
+        s = s + 12
+    elif x == 88:
+        s = s + 6
+    elif x == 89:
+        s = s + 13
+    elif x == 90:
+        s = s + 7
+    elif x == 91:
+        s = s + 1
+    elif x == 92:
+        s = s + 8
+    elif x == 93:
+        s = s + 2
+    elif x == 94:
+        s = s + 9
+    elif x == 95:
+        s = s + 3
+    elif x == 96:
+        s = s + 10
+    elif x == 97:
+        s = s + 4
+    elif x == 98:
+        s = s + 11
+    elif x == 99:
+        s = s + 5
+    elif x == 100:
+        s = s + 12
+    elif x == 101:
+        s = s + 6
+    elif x == 102:
+        s = s + 13
+    elif x == 103:
+        s = s + 7
+    elif x == 104:
+        s = s + 1
+    elif x == 105:
+        s = s + 8
+    elif x == 106:
+        s = s + 2
+    elif x == 107:
+        s = s + 9
+    elif x == 108:
+        s = s + 3
+    elif x == 109:
+        s = s + 10
+    elif x == 110:
+        s = s + 4
+    elif x == 111:
+        s = s + 11
+    elif x == 112:
+        s = s + 5
+    elif x == 113:
+        s = s + 12
+    elif x == 114:
+        s = s + 6
+    elif x == 115:
+        s = s + 13
+    elif x == 116:
+        s = s + 7
+    elif x == 117:
+        s = s + 1
+    elif x == 118:
+        s = s + 8
+    elif x == 119:
+        s = s + 2
+    elif x == 120:
+        s = s + 9
+    elif x == 121:
+        s = s + 3
+    elif x == 122:
+        s = s + 10
+    elif x == 123:
+        s = s + 4
+    elif x == 124:
+        s = s + 11
+    elif x == 125:
+        s = s + 5
+    elif x == 126:
+        s = s + 12
+    elif x == 127:
+        s = s + 6
+    elif x == 128:
+        s = s + 13
+    elif x == 129:
+        s = s + 7
+    elif x == 130:
+        s = s + 1
+    elif x == 131:
+        s = s + 8
+    elif x == 132:
+        s = s + 2
+    elif x == 133:
+        s = s + 9
+    elif x == 134:
+        s = s + 3
+    elif x == 135:
+        s = s + 10
+    elif x == 136:
+        s = s + 4
+    elif x == 137:
+        s = s + 11
+    elif x == 138:
+        s = s + 5
+    elif x == 139:
+        s = s + 12
+    elif x == 140:
+        s = s + 6
+    elif x == 141:
+        s = s + 13
+    elif x == 142:
+        s = s + 7
+    elif x == 143:
+        s = s + 1
+    elif x == 144:
+        s = s + 8
+    elif x == 145:
+        s = s + 2
+    elif x == 146:
+        s = s + 9
+    elif x == 147:
+        s = s + 3
+    elif x == 148:
+        s = s + 10
+    elif x == 149:
+        s = s + 4
+    elif x == 150:
+        s = s + 11
+    elif x == 151:
+        s = s + 5
+    elif x == 152:
+        s = s + 12
+    elif x == 153:
+        s = s + 6
+    elif x == 154:
+        s = s + 13
+    elif x == 155:
+        s = s + 7
+    elif x == 156:
+        s = s + 1
+    elif x == 157:
+        s = s + 8
+    elif x == 158:
+        s = s + 2
+    elif x == 159:
+        s = s + 9
+    elif x == 160:
+        s = s + 3
+    elif x == 161:
+        s = s + 10
+    elif x == 162:
+        s = s + 4
+    elif x == 163:
+        s = s + 11
+    elif x == 164:
+        s = s + 5
+    elif x == 165:
+        s = s + 12
+    elif x == 166:
+        s = s + 6
+    elif x == 167:
+        s = s + 13
+    elif x == 168:
+        s = s + 7
+    elif x == 169:
+        s = s + 1
+    elif x == 170:
+        s = s + 8
+    elif x == 171:
+        s = s + 2
+    elif x == 172:
+        s = s + 9
+    elif x == 173:
+        s = s + 3
+    elif x == 174:
+        s = s + 10
+    elif x == 175:
+        s = s + 4
+    elif x == 176:
+        s = s + 11
+    elif x == 177:
+        s = s + 5
+    elif x == 178:
+        s = s + 12
+    elif x == 179:
+        s = s + 6
+    elif x == 180:
+        s = s + 13
+    elif x == 181:
+        s = s + 7
+    elif x == 182:
+        s = s + 1
+    elif x == 183:
+        s = s + 8
+    elif x == 184:
+        s = s + 2
+    elif x == 185:
+        s = s + 9
+    elif x == 186:
+        s = s + 3
+    elif x == 187:
+        s = s + 10
+    elif x == 188:
+        s = s + 4
+    elif x == 189:
+        s = s + 11
+    elif x == 190:
+        s = s + 5
+    elif x == 191:
+        s = s + 12
+    elif x == 192:
+        s = s + 6
+    elif x == 193:
+        s = s + 13
+    elif x == 194:
+        s = s + 7
+    elif x == 195:
+        s = s + 1
+    elif x == 196:
+        s = s + 8
+    elif x == 197:
+        s = s + 2
+    elif x == 198:
+        s = s + 9
+    elif x == 199:
+        s = s + 3
+    else:
+        s = s - 1
+    i = i + 1
+print(s)
+i = 0
+t = 0
+while i < 200000:
+    y = (i - i // 211 * 211) * 7919
+    if y == 0:
+        t = t + 1
+    elif y == 7919:
+        t = t + 2
+    elif y == 31676:
+        t = t + 3
+    elif y == 71271:
+        t = t + 4
+    elif y == 126704:
+        t = t + 5
+    elif y == 197975:
+        t = t + 1
+    elif y == 285084:
+        t = t + 2
+    elif y == 388031:
+        t = t + 3
+    elif y == 506816:
+        t = t + 4
+    elif y == 641439:
+        t = t + 5
+    elif y == 791900:
+        t = t + 1
+    elif y == 958199:
+        t = t + 2
+    elif y == 1140336:
+        t = t + 3
+    elif y == 1338311:
+        t = t + 4
+    elif y == 1552124:
+        t = t + 5
+    elif y == 1781775:
+        t = t + 1
+    elif y == 2027264:
+        t = t + 2
+    elif y == 2288591:
+        t = t + 3
+    elif y == 2565756:
+        t = t + 4
+    elif y == 2858759:
+        t = t + 5
+    elif y == 3167600:
+        t = t + 1
+    elif y == 3492279:
+        t = t + 2
+    elif y == 3832796:
+        t = t + 3
+    elif y == 4189151:
+        t = t + 4
+    elif y == 4561344:
+        t = t + 5
+    elif y == 4949375:
+        t = t + 1
+    elif y == 5353244:
+        t = t + 2
+    elif y == 5772951:
+        t = t + 3
+    elif y == 6208496:
+        t = t + 4
+    elif y == 6659879:
+        t = t + 5
+    elif y == 7127100:
+        t = t + 1
+    elif y == 7610159:
+        t = t + 2
+    elif y == 8109056:
+        t = t + 3
+    elif y == 8623791:
+        t = t + 4
+    elif y == 9154364:
+        t = t + 5
+    elif y == 9700775:
+        t = t + 1
+    elif y == 10263024:
+        t = t + 2
+    elif y == 10841111:
+        t = t + 3
+    elif y == 11435036:
+        t = t + 4
+    elif y == 12044799:
+        t = t + 5
+    elif y == 12670400:
+        t = t + 1
+    elif y == 13311839:
+        t = t + 2
+    elif y == 13969116:
+        t = t + 3
+    elif y == 14642231:
+        t = t + 4
+    elif y == 15331184:
+        t = t + 5
+    elif y == 16035975:
+        t = t + 1
+    elif y == 16756604:
+        t = t + 2
+    elif y == 17493071:
+        t = t + 3
+    elif y == 18245376:
+        t = t + 4
+    elif y == 19013519:
+        t = t + 5
+    elif y == 19797500:
+        t = t + 1
+    elif y == 20597319:
+        t = t + 2
+    elif y == 21412976:
+        t = t + 3
+    elif y == 22244471:
+        t = t + 4
+    elif y == 23091804:
+        t = t + 5
+    elif y == 23954975:
+        t = t + 1
+    elif y == 24833984:
+        t = t + 2
+    elif y == 25728831:
+        t = t + 3
+    elif y == 26639516:
+        t = t + 4
+    elif y == 27566039:
+        t = t + 5
+    elif y == 28508400:
+        t = t + 1
+    elif y == 29466599:
+        t = t + 2
+    elif y == 30440636:
+        t = t + 3
+    elif y == 31430511:
+        t = t + 4
+    elif y == 32436224:
+        t = t + 5
+    elif y == 33457775:
+        t = t + 1
+    elif y == 34495164:
+        t = t + 2
+    elif y == 35548391:
+        t = t + 3
+    elif y == 36617456:
+        t = t + 4
+    elif y == 37702359:
+        t = t + 5
+    elif y == 38803100:
+        t = t + 1
+    elif y == 39919679:
+        t = t + 2
+    elif y == 41052096:
+        t = t + 3
+    elif y == 42200351:
+        t = t + 4
+    elif y == 43364444:
+        t = t + 5
+    elif y == 44544375:
+        t = t + 1
+    elif y == 45740144:
+        t = t + 2
+    elif y == 46951751:
+        t = t + 3
+    elif y == 48179196:
+        t = t + 4
+    elif y == 49422479:
+        t = t + 5
+    elif y == 50681600:
+        t = t + 1
+    elif y == 51956559:
+        t = t + 2
+    elif y == 53247356:
+        t = t + 3
+    elif y == 54553991:
+        t = t + 4
+    elif y == 55876464:
+        t = t + 5
+    elif y == 57214775:
+        t = t + 1
+    elif y == 58568924:
+        t = t + 2
+    elif y == 59938911:
+        t = t + 3
+    elif y == 61324736:
+        t = t + 4
+    elif y == 62726399:
+        t = t + 5
+    elif y == 64143900:
+        t = t + 1
+    elif y == 65577239:
+        t = t + 2
+    elif y == 67026416:
+        t = t + 3
+    elif y == 68491431:
+        t = t + 4
+    elif y == 69972284:
+        t = t + 5
+    elif y == 71468975:
+        t = t + 1
+    elif y == 72981504:
+        t = t + 2
+    elif y == 74509871:
+        t = t + 3
+    elif y == 76054076:
+        t = t + 4
+    elif y == 77614119:
+        t = t + 5
+    elif y == 79190000:
+        t = t + 1
+    elif y == 80781719:
+        t = t + 2
+    elif y == 82389276:
+        t = t + 3
+    elif y == 84012671:
+        t = t + 4
+    elif y == 85651904:
+        t = t + 5
+    elif y == 87306975:
+        t = t + 1
+    elif y == 88977884:
+        t = t + 2
+    elif y == 90664631:
+        t = t + 3
+    elif y == 92367216:
+        t = t + 4
+    elif y == 94085639:
+        t = t + 5
+    elif y == 95819900:
+        t = t + 1
+    elif y == 97569999:
+        t = t + 2
+    elif y == 99335936:
+        t = t + 3
+    elif y == 101117711:
+        t = t + 4
+    elif y == 102915324:
+        t = t + 5
+    elif y == 104728775:
+        t = t + 1
+    elif y == 106558064:
+        t = t + 2
+    elif y == 108403191:
+        t = t + 3
+    elif y == 110264156:
+        t = t + 4
+    elif y == 112140959:
+        t = t + 5
+    elif y == 114033600:
+        t = t + 1
+    elif y == 115942079:
+        t = t + 2
+    elif y == 117866396:
+        t = t + 3
+    elif y == 119806551:
+        t = t + 4
+    elif y == 121762544:
+        t = t + 5
+    elif y == 123734375:
+        t = t + 1
+    elif y == 125722044:
+        t = t + 2
+    elif y == 127725551:
+        t = t + 3
+    elif y == 129744896:
+        t = t + 4
+    elif y == 131780079:
+        t = t + 5
+    elif y == 133831100:
+        t = t + 1
+    elif y == 135897959:
+        t = t + 2
+    elif y == 137980656:
+        t = t + 3
+    elif y == 140079191:
+        t = t + 4
+    elif y == 142193564:
+        t = t + 5
+    elif y == 144323775:
+        t = t + 1
+    elif y == 146469824:
+        t = t + 2
+    elif y == 148631711:
+        t = t + 3
+    elif y == 150809436:
+        t = t + 4
+    elif y == 153002999:
+        t = t + 5
+    elif y == 155212400:
+        t = t + 1
+    elif y == 157437639:
+        t = t + 2
+    elif y == 159678716:
+        t = t + 3
+    elif y == 161935631:
+        t = t + 4
+    elif y == 164208384:
+        t = t + 5
+    elif y == 166496975:
+        t = t + 1
+    elif y == 168801404:
+        t = t + 2
+    elif y == 171121671:
+        t = t + 3
+    elif y == 173457776:
+        t = t + 4
+    elif y == 175809719:
+        t = t + 5
+    elif y == 178177500:
+        t = t + 1
+    elif y == 180561119:
+        t = t + 2
+    elif y == 182960576:
+        t = t + 3
+    elif y == 185375871:
+        t = t + 4
+    elif y == 187807004:
+        t = t + 5
+    elif y == 190253975:
+        t = t + 1
+    elif y == 192716784:
+        t = t + 2
+    elif y == 195195431:
+        t = t + 3
+    elif y == 197689916:
+        t = t + 4
+    elif y == 200200239:
+        t = t + 5
+    elif y == 202726400:
+        t = t + 1
+    elif y == 205268399:
+        t = t + 2
+    elif y == 207826236:
+        t = t + 3
+    elif y == 210399911:
+        t = t + 4
+    elif y == 212989424:
+        t = t + 5
+    elif y == 215594775:
+        t = t + 1
+    elif y == 218215964:
+        t = t + 2
+    elif y == 220852991:
+        t = t + 3
+    elif y == 223505856:
+        t = t + 4
+    elif y == 226174559:
+        t = t + 5
+    elif y == 228859100:
+        t = t + 1
+    elif y == 231559479:
+        t = t + 2
+    elif y == 234275696:
+        t = t + 3
+    elif y == 237007751:
+        t = t + 4
+    elif y == 239755644:
+        t = t + 5
+    elif y == 242519375:
+        t = t + 1
+    elif y == 245298944:
+        t = t + 2
+    elif y == 248094351:
+        t = t + 3
+    elif y == 250905596:
+        t = t + 4
+    elif y == 253732679:
+        t = t + 5
+    elif y == 256575600:
+        t = t + 1
+    elif y == 259434359:
+        t = t + 2
+    elif y == 262308956:
+        t = t + 3
+    elif y == 265199391:
+        t = t + 4
+    elif y == 268105664:
+        t = t + 5
+    elif y == 271027775:
+        t = t + 1
+    elif y == 273965724:
+        t = t + 2
+    elif y == 276919511:
+        t = t + 3
+    elif y == 279889136:
+        t = t + 4
+    elif y == 282874599:
+        t = t + 5
+    elif y == 285875900:
+        t = t + 1
+    elif y == 288893039:
+        t = t + 2
+    elif y == 291926016:
+        t = t + 3
+    elif y == 294974831:
+        t = t + 4
+    elif y == 298039484:
+        t = t + 5
+    elif y == 301119975:
+        t = t + 1
+    elif y == 304216304:
+        t = t + 2
+    elif y == 307328471:
+        t = t + 3
+    elif y == 310456476:
+        t = t + 4
+    elif y == 313600319:
+        t = t + 5
+    else:
+        t = t - 1
+    i = i + 1
+print(t)
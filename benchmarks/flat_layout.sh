@@ -0,0 +1,52 @@
+#!/bin/sh
+# Confronta l'AST di puntatori (tree walker) con l'AST piatto (--flat):
+# tempo di esecuzione (riga "Execution" di --stats, migliore di 5) di ogni
+# benchmark con e senza -O, poi memoria di picco (riga "Peak memory") e tempo
+# totale su uno script lungo di circa MB megabyte senza cicli, dove conta la
+# dimensione dell'AST più del tempo per nodo.
+# Uso: benchmarks/flat_layout.sh <interprete> [MB]
+interp=$1
+size=${2:-16}
+dir=${TMPDIR:-/tmp}/flat.$$
+mkdir -p "$dir"
+
+best() {
+	b=""
+	for run in 1 2 3 4 5; do
+		ms=$("$interp" "$@" --stats 2>&1 >/dev/null | sed -n 's/^Execution: \(.*\) ms$/\1/p')
+		b=$(awk -v a="$b" -v b="$ms" 'BEGIN { print (a == "" || b + 0 < a + 0) ? b : a }')
+	done
+	echo "$b"
+}
+
+printf '%-22s %-3s %10s %10s\n' benchmark "" "tree ms" "flat ms"
+for script in "$(dirname "$0")"/*.py; do
+	for level in "" "-O"; do
+		printf '%-22s %-3s %10.1f %10.1f\n' "$(basename "$script")" "$level" \
+			"$(best $level "$script")" "$(best --flat $level "$script")"
+	done
+done
+
+awk -v bytes=$((size * 1048576)) 'BEGIN {
+	print "s = 0"
+	print "l = list()"
+	for (i = 0; written < bytes; i++) {
+		if (i % 3 == 0) line = "s = s + " i "\n"
+		else if (i % 3 == 1) line = "l.append(s * 2 - " i ")\n"
+		else line = "if s > " i ":\n    s = s - l[0]\n"
+		printf "%s", line
+		written += length(line)
+	}
+	print "print(s)"
+}' > "$dir/long.py"
+megabytes=$(awk -v b=$(wc -c < "$dir/long.py") 'BEGIN { printf "%.1f", b / 1048576 }')
+echo
+echo "long.py: $megabytes MB"
+now() { date +%s%N; }
+for layout in "" "--flat" "-O" "--flat -O"; do
+	start=$(now)
+	peak=$("$interp" $layout --stats "$dir/long.py" 2>&1 >/dev/null | sed -n 's/^Peak memory: //p')
+	ms=$(( ($(now) - start) / 1000000 ))
+	printf '%-10s %12s %8d ms\n' "${layout:-tree}" "$peak" $ms
+done
+rm -rf "$dir"
@@ -0,0 +1,36 @@
+#!/bin/sh
+# Genera uno script di circa MB megabyte fatto quasi solo di identificatori
+# (nomi lunghi, nomi che iniziano come le parole chiave, indentazione) e
+# confronta il tempo di lexing (riga "Lexing" di --stats, migliore di 5) di un
+# interprete compilato con -DCHARSCAN_SCALAR e di uno con le scansioni SIMD.
+# Uso: benchmarks/lexer_identifiers.sh <interprete scalare> <interprete SIMD> [MB]
+scalar=$1
+simd=$2
+size=${3:-8}
+dir=${TMPDIR:-/tmp}/lexer.$$
+mkdir -p "$dir"
+awk -v bytes=$((size * 1048576)) 'BEGIN {
+	split("accumulatedtotalvalue previousiterationvalue scalingfactorconstant whilecounter ifresult " \
+		"printedlines listofelements notfound andalso ordinal breakpointindex continuation " \
+		"truevalue falsepositive elsewhere appendcount x y total", names, " ")
+	n = length(names)
+	for (k = 1; k <= n; k++) { line = names[k] " = " k "\n"; printf "%s", line; written += length(line) }
+	for (i = 0; written < bytes; i++) {
+		a = names[i % n + 1]; b = names[(i * 7) % n + 1]; c = names[(i * 13) % n + 1]
+		if (i % 4 == 0) line = "if " a " > " b ":\n    " c " = " a " - " b "\nelse:\n    " c " = " b "\n"
+		else line = a " = " b " + " c " * 3 - " a " // 7\n"
+		printf "%s", line
+		written += length(line)
+	}
+}' > "$dir/identifiers.py"
+megabytes=$(awk -v b=$(wc -c < "$dir/identifiers.py") 'BEGIN { printf "%.1f", b / 1048576 }')
+echo "identifiers.py: $megabytes MB"
+for interp in "$scalar" "$simd"; do
+	best=""
+	for run in 1 2 3 4 5; do
+		ms=$("$interp" --stats "$dir/identifiers.py" 2>&1 >/dev/null | sed -n 's/^Lexing: .*(\(.*\) ms\/MB)$/\1/p')
+		best=$(awk -v a="$best" -v b="$ms" 'BEGIN { print (a == "" || b + 0 < a + 0) ? b : a }')
+	done
+	printf '%-40s %8.2f ms/MB\n' "$interp" "$best"
+done
+rm -rf "$dir"
@@ -0,0 +1,16 @@
+n = 300
+m = 500
+L = list()
+k = 0
+while k < 16:
+    L.append(k * 7 + 3)
+    k = k + 1
+s = 0
+i = 0
+while i < n * 2 - 1:
+    j = 0
+    while j < m + n // 3:
+        s = s + L[i // 100] * (n * n - m) + i * 3 + L[5] // L[2]
+        j = j + 1
+    i = i + 1
+print(s)
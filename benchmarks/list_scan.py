@@ -0,0 +1,19 @@
+data = list()
+n = 0
+while n < 20000:
+    data.append(n * 7 // 3)
+    n = n + 1
+round = 0
+total = 0
+while round < 60:
+    i = 0
+    while i < n - 1:
+        total = total + data[i + 1] - data[i]
+        i = i + 1
+    j = n - 1
+    while j >= 0:
+        if data[j] > total:
+            total = total + 1
+        j = j - 1
+    round = round + 1
+print(total)
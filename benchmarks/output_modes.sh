@@ -0,0 +1,22 @@
+#!/bin/sh
+# Confronta l'uscita testuale con quella binaria: tempo di esecuzione
+# (--stats), byte scritti e valori al secondo.
+# Uso: benchmarks/output_modes.sh <interprete> [opzioni...] [-- benchmark.py]
+interp=$1
+shift
+options=""
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+	options="$options $1"
+	shift
+done
+[ "$1" = "--" ] && shift
+script=${1:-$(dirname "$0")/print_lines.py}
+out=${TMPDIR:-/tmp}/output_modes.$$
+values=$("$interp" $options "$script" | wc -l)
+for mode in "" "--binary 32" "--binary 64" "--binary 32 --frame 4096"; do
+	time=$("$interp" $options $mode --output "$out" --stats "$script" 2>&1 >/dev/null | sed -n 's/^Execution: \([0-9.]*\) ms/\1/p')
+	bytes=$(wc -c < "$out")
+	printf '%-26s %10s ms %10s bytes %8s Mvalues/s\n' "${mode:-text}" "$time" "$bytes" \
+		"$(awk -v v="$values" -v t="$time" 'BEGIN { printf "%.1f", v / t / 1000 }')"
+done
+rm -f "$out"
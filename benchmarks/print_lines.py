@@ -0,0 +1,7 @@
+i = 0
+x = 7
+while i < 1000000:
+    x = x * 1103515245 + 12345
+    print(x)
+    print(i)
+    i = i + 1
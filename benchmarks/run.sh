@@ -0,0 +1,19 @@
+#!/bin/sh
+# Esegue ogni benchmark con e senza -O e stampa il tempo di esecuzione (--stats).
+# Uso: benchmarks/run.sh <interprete> [opzioni...] [-- benchmark.py ...]
+interp=$1
+shift
+options=""
+while [ $# -gt 0 ] && [ "$1" != "--" ]; do
+	options="$options $1"
+	shift
+done
+[ "$1" = "--" ] && shift
+dir=$(dirname "$0")
+[ $# -eq 0 ] && set -- "$dir"/*.py
+for script in "$@"; do
+	for level in "" "-O"; do
+		time=$("$interp" $options $level --stats "$script" 2>&1 >/dev/null | sed -n 's/^Execution: //p')
+		printf '%-28s %-4s %s\n' "$(basename "$script")" "$level" "$time"
+	done
+done
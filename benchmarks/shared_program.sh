@@ -0,0 +1,66 @@
+#!/bin/sh
+# Esegue N volte lo stesso script con --batch: compilato una volta e condiviso
+# fra i thread, contro N copie con nomi diversi (ognuna riletta e ricompilata).
+# Per 1, 2, 4, ... thread e per il numero di core stampa tempo ed esecuzioni
+# al secondo, e controlla che ogni esecuzione stampi lo stesso risultato.
+# Con un interprete compilato con -fsanitize=thread fa da test di stress.
+# Uso: benchmarks/shared_program.sh <interprete> [N] [opzioni, es. -O --reg]
+interp=$1
+count=${2:-1000}
+shift
+[ $# -gt 0 ] && shift
+dir=${TMPDIR:-/tmp}/shared.$$
+mkdir -p "$dir"
+cat > "$dir/script.py" <<'SCRIPT'
+l = list()
+i = 0
+while i < 2000:
+    l.append(i * 7 - i * 7 // 13 * 13)
+    i = i + 1
+total = 0
+j = 0
+while j < 2000:
+    v = l[j]
+    if v == 0:
+        total = total + 5
+    elif v == 1:
+        total = total - 3
+    elif v == 2:
+        total = total + 11
+    elif v == 3:
+        total = total * 2 // 3
+    else:
+        total = total + v
+    j = j + 1
+print(total)
+print(l[1999])
+SCRIPT
+"$interp" "$@" "$dir/script.py" > "$dir/one" || exit 1
+k=0
+while [ $k -lt "$count" ]; do
+	echo "$dir/script.py" >> "$dir/shared"
+	cp "$dir/script.py" "$dir/copy$k.py"
+	echo "$dir/copy$k.py" >> "$dir/copies"
+	cat "$dir/one" >> "$dir/expected"
+	k=$((k + 1))
+done
+
+now() { date +%s%N; }
+cores=$(getconf _NPROCESSORS_ONLN 2>/dev/null || echo 1)
+list=""
+threads=1
+while [ $threads -lt "$cores" ]; do
+	list="$list $threads"
+	threads=$((threads * 2))
+done
+for threads in $list $cores; do
+	for manifest in copies shared; do
+		start=$(now)
+		"$interp" "$@" --batch --jobs $threads "$dir/$manifest" > "$dir/got"
+		ms=$(( ($(now) - start) / 1000000 ))
+		cmp -s "$dir/expected" "$dir/got" || echo "output differs: $manifest, $threads threads"
+		printf '%-7s %3d threads %8d ms %10s runs/s\n' $manifest $threads $ms \
+			"$(awk -v n=$count -v t=$ms 'BEGIN { printf "%.0f", n * 1000 / (t > 0 ? t : 1) }')"
+	done
+done
+rm -rf "$dir"
@@ -0,0 +1,113 @@
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../OutputSink.h"
+
+// Uscita binaria a blocchi (--binary 32|64 --frame N) con ogni politica di
+// flush, con e senza thread di scrittura e con un buffer piccolo che si
+// riempie a metà blocco: ogni blocco tranne l'ultimo deve contenere N valori,
+// i valori devono essere quelli stampati e decode() deve riconvertirli.
+// Uso: FrameTest
+
+namespace {
+
+struct Case {
+	const char* name;
+	OutputSink::Policy policy;
+	bool async;
+	std::size_t capacity;
+};
+
+// Legge i blocchi di out; false (con il motivo in error) se un blocco
+// diverso dall'ultimo non ha frame valori o se i valori non sono 0, 1, 2, ...
+bool check(std::string const& out, OutputSink::Encoding encoding, int count, std::string& error) {
+	std::size_t width = encoding.format == OutputSink::Format::INT32 ? 4 : 8;
+	auto read = [&](std::size_t at, std::size_t bytes) {
+		std::uint64_t value = 0;
+		for (std::size_t k = 0; k < bytes; ++k) value |= static_cast<std::uint64_t>(static_cast<unsigned char>(out[at + k])) << (8 * k);
+		return value;
+	};
+	std::size_t at = 0;
+	int expected = 0;
+	std::vector<std::uint32_t> frames;
+	while (at < out.size()) {
+		if (out.size() - at < 4) {
+			error = "truncated frame header";
+			return false;
+		}
+		std::uint32_t size = static_cast<std::uint32_t>(read(at, 4));
+		at += 4;
+		frames.push_back(size);
+		for (std::uint32_t k = 0; k < size; ++k, at += width) {
+			if (out.size() - at < width || static_cast<std::int64_t>(read(at, width)) != expected++) {
+				error = "wrong value in frame " + std::to_string(frames.size());
+				return false;
+			}
+		}
+	}
+	if (expected != count) {
+		error = std::to_string(expected) + " values instead of " + std::to_string(count);
+		return false;
+	}
+	for (std::size_t k = 0; k < frames.size(); ++k) {
+		bool last = k + 1 == frames.size();
+		if (last ? frames[k] == 0 || frames[k] > encoding.frame : frames[k] != encoding.frame) {
+			error = "frame " + std::to_string(k + 1) + " of " + std::to_string(frames.size()) + " has "
+				+ std::to_string(frames[k]) + " values";
+			return false;
+		}
+	}
+	return true;
+}
+
+}
+
+int main() {
+	using Flush = OutputSink::Flush;
+	std::vector<Case> cases = {
+		{ "exit", { Flush::EXIT, 1 }, false, OutputSink::CAPACITY },
+		{ "full", { Flush::FULL, 1 }, false, OutputSink::CAPACITY },
+		{ "line", { Flush::LINE, 1 }, false, OutputSink::CAPACITY },
+		{ "3", { Flush::LINES, 3 }, false, OutputSink::CAPACITY },
+		{ "full, small buffer", { Flush::FULL, 1 }, false, 16 },
+		{ "3, small buffer", { Flush::LINES, 3 }, false, 16 },
+		{ "line --async", { Flush::LINE, 1 }, true, OutputSink::CAPACITY },
+		{ "full --async, small buffer", { Flush::FULL, 1 }, true, 16 },
+	};
+	const int count = 1000;
+	int failures = 0;
+	for (Case const& c : cases) {
+		for (OutputSink::Format format : { OutputSink::Format::INT32, OutputSink::Format::INT64 }) {
+			for (std::size_t frame : { std::size_t{ 1 }, std::size_t{ 4 }, std::size_t{ 7 }, std::size_t{ 5000 } }) {
+				OutputSink::Encoding encoding{ format, frame };
+				std::ostringstream out;
+				{
+					OutputSink sink{ out, c.policy, encoding, c.async, c.capacity };
+					for (int value = 0; value < count; ++value) sink.print(value);
+				}
+				std::string error;
+				bool ok = check(out.str(), encoding, count, error);
+				if (ok) {
+					std::istringstream in{ out.str() };
+					std::ostringstream text;
+					std::ostringstream expected;
+					for (int value = 0; value < count; ++value) expected << value << '\n';
+					if (!OutputSink::decode(in, text, encoding) || text.str() != expected.str()) {
+						ok = false;
+						error = "decode differs";
+					}
+				}
+				std::cout << (ok ? "ok   " : "FAIL ") << "--flush " << c.name << " --binary "
+					<< (format == OutputSink::Format::INT32 ? 32 : 64) << " --frame " << frame;
+				if (!ok) std::cout << ": " << error;
+				std::cout << std::endl;
+				failures += !ok;
+			}
+		}
+	}
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,165 @@
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../Lexer.h"
+#include "../Parser.h"
+#include "../Jit.h"
+#include "../CompiledProgram.h"
+#include "../OutputSink.h"
+
+// Compila lo script una volta per ogni motore e lo esegue da N thread insieme,
+// ognuno con la propria SymbolTable e il proprio OutputSink: ogni esecuzione
+// deve stampare esattamente quello che stampa l'esecuzione su un solo thread.
+// Compilato con -fsanitize=thread (vedi tests/run.sh) controlla anche che lo
+// stato condiviso sia solo letto e, nei casi --async, il passaggio dei buffer
+// al thread di scrittura.
+// Uso: SharedProgramTest [thread] [esecuzioni per thread]
+
+namespace {
+
+// Liste, divisioni per costante (ScalarEvolution con -O), catena if/elif
+// (SwitchLowering), while annidati abbastanza caldi per il JIT, un errore
+const char* const SCRIPT =
+	"l = list()\n"
+	"i = 0\n"
+	"while i < 3000:\n"
+	"    l.append(i * 7 - i * 7 // 13 * 13)\n"
+	"    i = i + 1\n"
+	"total = 0\n"
+	"j = 0\n"
+	"while j < 3000:\n"
+	"    v = l[j]\n"
+	"    if v == 0:\n"
+	"        total = total + 5\n"
+	"    elif v == 1:\n"
+	"        total = total - 3\n"
+	"    elif v == 2:\n"
+	"        total = total + 11\n"
+	"    elif v == 3:\n"
+	"        total = total * 2 // 3\n"
+	"    else:\n"
+	"        total = total + v\n"
+	"    j = j + 1\n"
+	"print(total)\n"
+	"n = 0\n"
+	"s = 0\n"
+	"while n < 200:\n"
+	"    k = 0\n"
+	"    while k < 50:\n"
+	"        s = s + n * k // 7\n"
+	"        k = k + 1\n"
+	"    if n // 10 * 10 == n:\n"
+	"        print(s)\n"
+	"    n = n + 1\n"
+	"print(l[2999])\n"
+	"print(l[3000])\n";
+
+struct Result {
+	int status = EXIT_FAILURE;
+	std::string output;
+	std::string log;
+};
+
+// Con async un buffer piccolo, così ogni esecuzione passa molti buffer al
+// thread di scrittura
+Result run(CompiledProgram const& program, bool async) {
+	Result result;
+	std::ostringstream out;
+	std::ostringstream log;
+	{
+		OutputSink sink{ out, OutputSink::Policy{ OutputSink::Flush::FULL, 1 }, OutputSink::Encoding{},
+			async, async ? 16 : OutputSink::CAPACITY };
+		result.status = program.run(sink, log);
+	}
+	result.output = out.str();
+	result.log = log.str();
+	return result;
+}
+
+bool operator==(Result const& a, Result const& b) {
+	return a.status == b.status && a.output == b.output && a.log == b.log;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+	unsigned threads = argc > 1 ? static_cast<unsigned>(std::stoul(argv[1])) : 8;
+	unsigned runs = argc > 2 ? static_cast<unsigned>(std::stoul(argv[2])) : 4;
+
+	using Engine = CompiledProgram::Engine;
+	struct Case {
+		const char* name;
+		Engine engine;
+		bool optimize;
+		bool jit;
+		bool async;
+	};
+	std::vector<Case> cases;
+	for (bool optimize : { false, true }) {
+		cases.push_back({ "tree", Engine::TREE, optimize, false, false });
+		cases.push_back({ "flat", Engine::FLAT, optimize, false, false });
+		cases.push_back({ "vm", Engine::STACK_VM, optimize, false, false });
+		cases.push_back({ "reg", Engine::REGISTER_VM, optimize, false, false });
+		cases.push_back({ "ir", Engine::IR, optimize, false, false });
+		if (Jit::available()) cases.push_back({ "jit", Engine::TREE, optimize, true, false });
+		cases.push_back({ "tree --async", Engine::TREE, optimize, false, true });
+		cases.push_back({ "vm --async", Engine::STACK_VM, optimize, false, true });
+	}
+
+	int failures = 0;
+	for (Case const& c : cases) {
+		std::string name = std::string{ c.name } + (c.optimize ? " -O" : "");
+		std::shared_ptr<const CompiledProgram> program;
+		try {
+			Lexer tokenize;
+			TokenStream tokens = tokenize(SCRIPT);
+			Parser parser;
+			std::unique_ptr<Program> parsed{ parser.doParsing(tokens) };
+			CompiledProgram::Options options;
+			options.engine = c.engine;
+			options.optimize = c.optimize;
+			options.jit = c.jit;
+			program = CompiledProgram::compile(std::move(parsed), options, std::cerr);
+		}
+		catch (std::exception& e) {
+			std::cerr << name << ": compilation failed: " << e.what() << std::endl;
+			++failures;
+			continue;
+		}
+
+		Result expected = run(*program, false);
+		if (expected.output.empty() || expected.log.find("out of bounds") == std::string::npos) {
+			std::cerr << name << ": unexpected single-threaded result:\n" << expected.output << expected.log;
+			++failures;
+			continue;
+		}
+
+		std::vector<std::vector<Result>> results(threads);
+		std::vector<std::thread> workers;
+		for (unsigned t = 0; t < threads; ++t) {
+			workers.emplace_back([&, t] {
+				for (unsigned r = 0; r < runs; ++r) results[t].push_back(run(*program, c.async));
+			});
+		}
+		for (std::thread& worker : workers) worker.join();
+
+		int mismatches = 0;
+		for (unsigned t = 0; t < threads; ++t) {
+			for (Result const& result : results[t]) {
+				if (!(result == expected)) ++mismatches;
+			}
+		}
+		std::cout << (mismatches == 0 ? "ok   " : "FAIL ") << name << ": " << threads << " threads x "
+			<< runs << " runs";
+		if (mismatches != 0) std::cout << ", " << mismatches << " differ from the single-threaded run";
+		std::cout << std::endl;
+		failures += mismatches != 0;
+	}
+	return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,35 @@
+#!/bin/sh
+# Compila ed esegue i test (tests/*Test.cpp) due volte: normale (-O2) e con
+# ThreadSanitizer (-fsanitize=thread), che fallisce al primo data race.
+# Gli argomenti vanno a SharedProgramTest.
+# Uso: tests/run.sh [thread] [esecuzioni per thread]   (CXX sceglie il compilatore)
+cxx=${CXX:-g++}
+root=$(cd "$(dirname "$0")/.." && pwd)
+shared="$*"
+dir=${TMPDIR:-/tmp}/tests.$$
+mkdir -p "$dir"
+status=0
+for build in release tsan; do
+	if [ $build = tsan ]; then
+		flags="-O1 -g -fsanitize=thread"
+	else
+		flags="-O2"
+	fi
+	echo "== $build"
+	mkdir -p "$dir/$build"
+	objects=""
+	for source in "$root"/*.cpp; do
+		[ "$(basename "$source")" = Interpreter.cpp ] && continue
+		object="$dir/$build/$(basename "$source" .cpp).o"
+		$cxx -std=c++17 $flags -pthread -c -o "$object" "$source" || status=1
+		objects="$objects $object"
+	done
+	for test in "$root"/tests/*Test.cpp; do
+		name=$(basename "$test" .cpp)
+		$cxx -std=c++17 $flags -pthread -o "$dir/$build/$name" "$test" $objects || { status=1; continue; }
+		[ $name = SharedProgramTest ] && args=$shared || args=""
+		TSAN_OPTIONS="halt_on_error=1 exitcode=66 $TSAN_OPTIONS" "$dir/$build/$name" $args || status=1
+	done
+done
+rm -rf "$dir"
+exit $status